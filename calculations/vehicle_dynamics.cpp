@@ -1,9 +1,10 @@
 #define NOMINMAX
 #include "vehicle_dynamics.h"
-#include <ffb_setup.h>
+#include <ffb_settings_text.h>
 #include <telemetry_reader.h>
 #include <cmath>
 #include <algorithm>
+#include <cwctype>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -135,14 +136,14 @@ bool CalculateVehicleDynamics(const RawTelemetry& current, RawTelemetry& previou
 
     
     // Force Assignments
-    out.force_lf = static_cast<int32_t>(current.gp2_magLat_lf);  
-    out.force_rf = static_cast<int32_t>(current.gp2_magLat_rf);
-    //out.force_lr = static_cast<int16_t>(current.tiremaglat_lr);
-    //out.force_rr = static_cast<int16_t>(current.tiremaglat_rr);
-    out.forceLong_lf = static_cast<int32_t>(current.gp2_magLong_lf);
-    out.forceLong_rf = static_cast<int32_t>(current.gp2_magLong_rf);
-    //out.forceLong_lr = static_cast<int16_t>(current.tiremaglong_lr);
-    //out.forceLong_rr = static_cast<int16_t>(current.tiremaglong_rr);
+    out.force_lf = current.gp2_magLat[CORNER_LF];
+    out.force_rf = current.gp2_magLat[CORNER_RF];
+    out.force_lr = current.gp2_magLat[CORNER_LR];
+    out.force_rr = current.gp2_magLat[CORNER_RR];
+    out.forceLong_lf = current.gp2_magLong[CORNER_LF];
+    out.forceLong_rf = current.gp2_magLong[CORNER_RF];
+    out.forceLong_lr = current.gp2_magLong[CORNER_LR];
+    out.forceLong_rr = current.gp2_magLong[CORNER_RR];
 
     // Convert tire forces to "actual" Newtons
     // In the future if we find real forces we can replace this
@@ -5,6 +5,9 @@
 // Include logging
 void LogMessage(const std::wstring& msg);
 
+// Telemetry this reads (see TELEM_ in telemetry_reader.h)
+#define VEHICLE_DYNAMICS_FIELDS (TELEM_SPEED | TELEM_STEERING | TELEM_TYRE_FORCES)
+
 struct CalculatedVehicleDynamics {
     double lateralG = 0.0;
     int directionVal = 0;
@@ -0,0 +1,159 @@
+#include "console_screen.h"
+#include "logger.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <wchar.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+#ifdef _WIN32
+// Only one screen, and it's big enough to keep off the display thread's stack
+static CHAR_INFO cells[CONSOLE_SCREEN_LINES * CONSOLE_SCREEN_WIDTH];
+static WORD attributes = FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE;   // the console's own, read on the first refresh
+#endif
+
+ConsoleScreen::ConsoleScreen() {
+    // Nothing is on the console yet as far as the first Present can tell, so it draws every cell
+    for (int row = 0; row < CONSOLE_SCREEN_LINES; row++) {
+        wmemset(next[row], L' ', CONSOLE_SCREEN_WIDTH);
+        next[row][CONSOLE_SCREEN_WIDTH] = L'\0';
+        wmemset(shown[row], L'\0', CONSOLE_SCREEN_WIDTH);
+    }
+    out.reserve(CONSOLE_SCREEN_LINES * (CONSOLE_SCREEN_WIDTH * 4 + 16) + 16);
+}
+
+void ConsoleScreen::Begin() {
+    line = 0;
+}
+
+void ConsoleScreen::Print(const wchar_t* format, ...) {
+    if (line >= CONSOLE_SCREEN_LINES) return;
+    wchar_t* row = next[line++];
+
+    va_list args;
+    va_start(args, format);
+    int length = vswprintf(row, CONSOLE_SCREEN_WIDTH + 1, format, args);
+    va_end(args);
+
+    if (length < 0) {
+        // Longer than the screen, keep what fit
+        row[CONSOLE_SCREEN_WIDTH] = L'\0';
+        length = static_cast<int>(wcslen(row));
+    }
+    wmemset(row + length, L' ', CONSOLE_SCREEN_WIDTH - length);
+}
+
+#ifdef _WIN32
+
+void ConsoleScreen::Present() {
+    for (; line < CONSOLE_SCREEN_LINES; line++) wmemset(next[line], L' ', CONSOLE_SCREEN_WIDTH);
+
+    // Smallest rectangle holding every changed cell
+    int top = CONSOLE_SCREEN_LINES, bottom = -1, left = CONSOLE_SCREEN_WIDTH, right = -1;
+    for (int row = 0; row < CONSOLE_SCREEN_LINES; row++) {
+        for (int col = 0; col < CONSOLE_SCREEN_WIDTH; col++) {
+            if (next[row][col] == shown[row][col]) continue;
+            if (row < top) top = row;
+            bottom = row;
+            if (col < left) left = col;
+            if (col > right) right = col;
+        }
+    }
+
+    stats.frames++;
+    stats.lastFrameCells = 0;
+    if (bottom < 0) return;
+
+    HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
+    CONSOLE_SCREEN_BUFFER_INFO csbi;
+    if (firstFrame && GetConsoleScreenBufferInfo(hOut, &csbi)) attributes = csbi.wAttributes;
+
+    SHORT width = static_cast<SHORT>(right - left + 1);
+    SHORT height = static_cast<SHORT>(bottom - top + 1);
+    for (int row = top; row <= bottom; row++) {
+        for (int col = left; col <= right; col++) {
+            CHAR_INFO& cell = cells[(row - top) * width + (col - left)];
+            cell.Char.UnicodeChar = next[row][col];
+            cell.Attributes = attributes;
+            shown[row][col] = next[row][col];
+        }
+    }
+
+    COORD size = { width, height };
+    COORD origin = { 0, 0 };
+    SMALL_RECT region = { static_cast<SHORT>(left), static_cast<SHORT>(top), static_cast<SHORT>(right), static_cast<SHORT>(bottom) };
+    if (!WriteConsoleOutputW(hOut, cells, size, origin, &region) && firstFrame) {
+        LogMessage(L"[WARNING] Could not draw to the console (error " + std::to_wstring(GetLastError()) + L")");
+    }
+    firstFrame = false;
+
+    stats.writes++;
+    stats.lastFrameCells = static_cast<unsigned long long>(width) * height;
+    stats.cellsWritten += stats.lastFrameCells;
+}
+
+#else
+
+void ConsoleScreen::Present() {
+    for (; line < CONSOLE_SCREEN_LINES; line++) wmemset(next[line], L' ', CONSOLE_SCREEN_WIDTH);
+
+    out.clear();
+    if (firstFrame) out += "\x1b[?25l\x1b[2J";    // hide the cursor, start from a clear screen
+
+    unsigned long long changed = 0;
+    for (int row = 0; row < CONSOLE_SCREEN_LINES; row++) {
+        int col = 0;
+        while (col < CONSOLE_SCREEN_WIDTH) {
+            if (next[row][col] == shown[row][col]) {
+                col++;
+                continue;
+            }
+
+            // Run on through short stretches of unchanged cells, a cursor move costs about as much
+            int start = col, end = col + 1;
+            for (int c = col + 1; c < CONSOLE_SCREEN_WIDTH && c - end < CONSOLE_SCREEN_RUN_GAP; c++) {
+                if (next[row][c] != shown[row][c]) end = c + 1;
+            }
+
+            char move[24];
+            int moveLength = snprintf(move, sizeof(move), "\x1b[%d;%dH", row + 1, start + 1);
+            out.append(move, moveLength);
+            AppendUtf8(out, next[row] + start, end - start);
+            wmemcpy(shown[row] + start, next[row] + start, end - start);
+            changed += end - start;
+            col = end;
+        }
+    }
+
+    stats.frames++;
+    stats.lastFrameCells = changed;
+    if (out.empty()) return;
+
+    if (write(STDOUT_FILENO, out.data(), out.size()) < 0 && firstFrame) {
+        LogMessage(L"[WARNING] Could not draw to the terminal");
+    }
+    firstFrame = false;
+
+    stats.writes++;
+    stats.cellsWritten += changed;
+}
+
+#endif
@@ -0,0 +1,66 @@
+#pragma once
+#include <string>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// Console screen
+// The display used to stream ~45 padded lines through std::wcout every refresh, each its own console write
+// with the cursor dragged down the window and back to the top, which is where the flicker came from.
+// Now each refresh printf's its lines into a fixed grid of cells, Present compares that with what is already
+// on the console, and only what changed goes out, in one call:
+//
+//   Windows - WriteConsoleOutputW of the smallest rectangle holding every changed cell, straight into the
+//             console's cells at fixed positions. No cursor, no scrolling, works however small the window is
+//   Linux   - one write of cursor moves and the changed runs of text
+//
+// A refresh where nothing moved writes nothing. Nothing is allocated per refresh. Owned by the display thread.
+
+#define CONSOLE_SCREEN_WIDTH 80         // columns the display uses, longer lines are cut
+#define CONSOLE_SCREEN_LINES 48         // lines the display owns from the top of the console
+#define CONSOLE_SCREEN_RUN_GAP 8        // Linux: unchanged cells between two changes cheaper to resend than to skip
+
+struct ConsoleScreenStats {
+    unsigned long long frames = 0;
+    unsigned long long cellsWritten = 0;
+    unsigned long long lastFrameCells = 0;
+    unsigned long long writes = 0;      // console calls, at most one per refresh
+};
+
+// Include logging
+void LogMessage(const std::wstring& msg);
+
+class ConsoleScreen {
+public:
+    ConsoleScreen();
+
+    // Start a new refresh at the top line
+    void Begin();
+
+    // Next line, like swprintf (%d %f %llu %ls...), padded or cut to CONSOLE_SCREEN_WIDTH
+    void Print(const wchar_t* format, ...);
+
+    // Blanks whatever this refresh didn't print, sends the changes
+    void Present();
+
+    ConsoleScreenStats Stats() const { return stats; }
+
+private:
+    wchar_t next[CONSOLE_SCREEN_LINES][CONSOLE_SCREEN_WIDTH + 1];   // +1 for swprintf's terminator
+    wchar_t shown[CONSOLE_SCREEN_LINES][CONSOLE_SCREEN_WIDTH];      // what the console has
+    int line = 0;
+    bool firstFrame = true;
+    std::string out;                    // Linux: the escape sequences and text, reserved once
+    ConsoleScreenStats stats;
+};
@@ -0,0 +1,309 @@
+#include "control_channel.h"
+#include "ffb_config.h"
+#include "ffb_clock.h"
+#include "thread_policy.h"
+#include <atomic>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+static ControlMetricsCollector metricsCollector = nullptr;
+static std::vector<ControlMetric> metricsCache;
+static double metricsCachedMs = -1.0;
+
+static std::atomic<unsigned long long> requests{ 0 };
+static std::atomic<unsigned long long> clients{ 0 };
+
+static std::wstring Widen(const std::string& text) {
+    return std::wstring(text.begin(), text.end());
+}
+
+static std::string FormatValue(double value) {
+    char buffer[64];
+    if (value == static_cast<double>(static_cast<long long>(value)) && value < 1e15 && value > -1e15) {
+        snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(value));
+    }
+    else {
+        snprintf(buffer, sizeof(buffer), "%.4f", value);
+    }
+    return buffer;
+}
+
+static bool ParseValue(const std::string& text, double& value) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    value = strtod(text.c_str(), &end);
+    return end && *end == '\0';
+}
+
+static bool ParseOnOff(const std::string& text, bool& on) {
+    if (text == "on" || text == "true") { on = true; return true; }
+    if (text == "off" || text == "false") { on = false; return true; }
+    return false;
+}
+
+// Only called on the channel thread, so the cache needs no lock
+static const std::vector<ControlMetric>& Metrics() {
+    double now = GetFFBClock().NowMs();
+    if (metricsCachedMs < 0.0 || now - metricsCachedMs >= CONTROL_METRICS_MIN_MS) {
+        metricsCache.clear();
+        if (metricsCollector) metricsCollector(metricsCache);
+        metricsCache.push_back({ "control_requests", static_cast<double>(requests.load()) });
+        metricsCache.push_back({ "control_clients", static_cast<double>(clients.load()) });
+        metricsCachedMs = now;
+    }
+    return metricsCache;
+}
+
+static std::string DescribeConfig(const FFBConfig& config) {
+    std::string reply;
+    reply += "version " + FormatValue(static_cast<double>(config.version)) + "\n";
+    reply += "force " + FormatValue(config.masterScale * 100.0) + "\n";
+    reply += "deadzone " + FormatValue(config.deadzoneScale * 100.0) + "\n";
+    reply += "constant " + FormatValue(config.constantScale * 100.0) + "\n";
+    reply += "braking " + FormatValue(config.brakingScale) + "\n";
+    reply += "vibration " + FormatValue(config.vibrationScale * 100.0) + "\n";
+    reply += "weight " + FormatValue(config.weightScale * 100.0) + "\n";
+    reply += "damper " + FormatValue(config.damperScale * 100.0) + "\n";
+    reply += std::string("invert ") + (config.invert ? "true" : "false") + "\n";
+    reply += std::string("effect constant ") + (config.constantOn ? "on" : "off") + "\n";
+    reply += std::string("effect vibration ") + (config.vibrationOn ? "on" : "off") + "\n";
+    reply += std::string("effect damper ") + (config.damperOn ? "on" : "off") + "\n";
+    reply += std::string("effect spring ") + (config.springOn ? "on" : "off") + "\n";
+    return reply;
+}
+
+// "set <name> <value>" into next, false with why if it can't be
+static bool ApplySet(FFBConfig& next, const std::string& name, const std::string& value, std::string& error) {
+    if (name == "invert") {
+        if (!ParseOnOff(value, next.invert)) { error = "invert takes true or false"; return false; }
+        return true;
+    }
+
+    double number = 0.0;
+    if (!ParseValue(value, number)) { error = "'" + value + "' is not a number"; return false; }
+
+    if (name == "braking") {
+        if (number < 0.0 || number > 1000.0) { error = "braking is 0 - 1000"; return false; }
+        next.brakingScale = number;
+        return true;
+    }
+
+    double* scale = nullptr;
+    if (name == "force") scale = &next.masterScale;
+    else if (name == "deadzone") scale = &next.deadzoneScale;
+    else if (name == "constant") scale = &next.constantScale;
+    else if (name == "vibration") scale = &next.vibrationScale;
+    else if (name == "weight") scale = &next.weightScale;
+    else if (name == "damper") scale = &next.damperScale;
+    if (!scale) { error = "no live setting called '" + name + "'"; return false; }
+    if (number < 0.0 || number > 100.0) { error = name + " is 0 - 100"; return false; }
+    *scale = number / 100.0;
+    return true;
+}
+
+static bool ApplyEffect(FFBConfig& next, const std::string& name, const std::string& value, std::string& error) {
+    bool* on = nullptr;
+    if (name == "constant") on = &next.constantOn;
+    else if (name == "vibration") on = &next.vibrationOn;
+    else if (name == "damper") on = &next.damperOn;
+    else if (name == "spring") on = &next.springOn;
+    if (!on) { error = "no effect called '" + name + "'"; return false; }
+    if (!ParseOnOff(value, *on)) { error = "effect takes on or off"; return false; }
+    return true;
+}
+
+static bool SameLiveSettings(const FFBConfig& a, const FFBConfig& b) {
+    return a.masterScale == b.masterScale && a.deadzoneScale == b.deadzoneScale && a.constantScale == b.constantScale &&
+        a.brakingScale == b.brakingScale && a.vibrationScale == b.vibrationScale && a.weightScale == b.weightScale &&
+        a.damperScale == b.damperScale && a.invert == b.invert && a.constantOn == b.constantOn &&
+        a.vibrationOn == b.vibrationOn && a.damperOn == b.damperOn && a.springOn == b.springOn;
+}
+
+std::string HandleControlCommand(const std::string& line) {
+    requests.fetch_add(1, std::memory_order_relaxed);
+
+    std::istringstream words(line);
+    std::string command, name, value, extra;
+    words >> command >> name >> value >> extra;
+    if (!extra.empty()) return "error too many words\n";
+
+    if (command == "help") {
+        return "set <force|deadzone|constant|braking|vibration|weight|damper> <value>\n"
+            "set invert <true|false>\n"
+            "effect <constant|vibration|damper|spring> <on|off>\n"
+            "config\nstats\nget <metric>\nok\n";
+    }
+
+    // Copied before anything slow, this thread can be kept waiting at its low priority
+    std::shared_ptr<const FFBConfig> snapshot = GetFFBConfig();
+    if (!snapshot) return "error settings not loaded yet\n";
+    const FFBConfig running = *snapshot;
+
+    if (command == "config") return DescribeConfig(running) + "ok\n";
+
+    if (command == "stats") {
+        std::string reply;
+        for (const ControlMetric& metric : Metrics()) reply += std::string(metric.name) + " " + FormatValue(metric.value) + "\n";
+        return reply + "ok\n";
+    }
+
+    if (command == "get") {
+        for (const ControlMetric& metric : Metrics()) {
+            if (name == metric.name) return FormatValue(metric.value) + "\nok\n";
+        }
+        return "error no metric called '" + name + "'\n";
+    }
+
+    if (command == "set" || command == "effect") {
+        // Applied to whatever is running once the lock is held, so this and a reload of ffb.ini can't undo each other
+        std::string error;
+        bool applied = true;
+        bool published = EditFFBConfig([&](FFBConfig& next, const FFBConfig& current) {
+            applied = command == "set" ? ApplySet(next, name, value, error) : ApplyEffect(next, name, value, error);
+
+            // Sending what is already set doesn't make a new snapshot
+            return applied && !SameLiveSettings(next, current);
+        });
+        if (!applied) return "error " + error + "\n";
+
+        if (published) LogMessage(L"[INFO] Control: " + Widen(command + " " + name + " " + value));
+        return "ok\n";
+    }
+
+    return "error unknown command '" + command + "', try help\n";
+}
+
+// Lines in, replies out, until the client hangs up. read/write return false once the connection is gone
+template <typename Read, typename Write>
+static void ServeClient(Read read, Write write) {
+    clients.fetch_add(1, std::memory_order_relaxed);
+
+    std::string pending;
+    char buffer[512];
+    int length = 0;
+    while ((length = read(buffer, static_cast<int>(sizeof(buffer)))) > 0) {
+        pending.append(buffer, length);
+
+        size_t newline;
+        while ((newline = pending.find('\n')) != std::string::npos) {
+            std::string line = pending.substr(0, newline);
+            pending.erase(0, newline + 1);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+            if (!write(HandleControlCommand(line))) return;
+        }
+
+        if (pending.size() > CONTROL_MAX_LINE) {
+            write("error request too long\n");
+            return;
+        }
+    }
+}
+
+#ifdef _WIN32
+
+static void ControlLoop() {
+    ApplyBackgroundPriority(L"Control channel");
+
+    while (true) {
+        HANDLE pipe = CreateNamedPipeW(CONTROL_PIPE_NAME, PIPE_ACCESS_DUPLEX,
+            PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, 1, 4096, 4096, 0, NULL);
+        if (pipe == INVALID_HANDLE_VALUE) {
+            LogMessage(L"[WARNING] Control channel could not be opened (error " + std::to_wstring(GetLastError()) + L")");
+            return;
+        }
+
+        if (ConnectNamedPipe(pipe, NULL) || GetLastError() == ERROR_PIPE_CONNECTED) {
+            ServeClient(
+                [pipe](char* data, int size) {
+                    DWORD got = 0;
+                    return ReadFile(pipe, data, static_cast<DWORD>(size), &got, NULL) ? static_cast<int>(got) : -1;
+                },
+                [pipe](const std::string& reply) {
+                    DWORD written = 0;
+                    return WriteFile(pipe, reply.data(), static_cast<DWORD>(reply.size()), &written, NULL) && written == reply.size();
+                });
+            FlushFileBuffers(pipe);
+            DisconnectNamedPipe(pipe);
+        }
+        CloseHandle(pipe);
+    }
+}
+
+#else
+
+static void ControlLoop() {
+    ApplyBackgroundPriority(L"Control channel");
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    snprintf(address.sun_path, sizeof(address.sun_path), "%s", CONTROL_SOCKET_PATH);
+
+    // A socket left over from a run that didn't exit cleanly would block the bind
+    unlink(CONTROL_SOCKET_PATH);
+
+    // This user only, from the moment it exists: anyone who can connect can set the force. Created under
+    // umask 0077, and the mode checked before listen lets the first client in
+    bool bound = false;
+    if (listener >= 0) {
+        mode_t previousMask = umask(0077);
+        bound = bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        umask(previousMask);
+    }
+    if (!bound || chmod(CONTROL_SOCKET_PATH, 0600) != 0 || listen(listener, 4) != 0) {
+        LogMessage(L"[WARNING] Control channel could not be opened on " + Widen(CONTROL_SOCKET_PATH));
+        if (bound) unlink(CONTROL_SOCKET_PATH);
+        if (listener >= 0) close(listener);
+        return;
+    }
+
+    while (true) {
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0) continue;
+        ServeClient(
+            [client](char* data, int size) { return static_cast<int>(recv(client, data, size, 0)); },
+            [client](const std::string& reply) {
+                return send(client, reply.data(), reply.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(reply.size());
+            });
+        close(client);
+    }
+}
+
+#endif
+
+void StartControlChannel(ControlMetricsCollector collector) {
+    metricsCollector = collector;
+    std::thread controlThread(ControlLoop);
+    controlThread.detach();
+#ifdef _WIN32
+    LogMessage(L"[INFO] Control channel on " + std::wstring(CONTROL_PIPE_NAME) + L", try 'ffb_ctl help'");
+#else
+    LogMessage(L"[INFO] Control channel on " + Widen(CONTROL_SOCKET_PATH) + L", try 'ffb_ctl help'");
+#endif
+}
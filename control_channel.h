@@ -0,0 +1,56 @@
+#pragma once
+#include <string>
+#include <vector>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// Control channel
+// A local endpoint (named pipe on Windows, Unix domain socket on Linux) to change the live settings and
+// read the stats without touching ffb.ini or restarting. Text lines in, text lines out, one client at a time.
+// Every reply ends with a line "ok" or "error <why>":
+//
+//   set force 40            Force, Deadzone and the Scale settings by name (force, deadzone, constant,
+//   set invert true         braking, vibration, weight, damper) plus invert
+//   effect damper off       constant, vibration, damper or spring - off keeps the effect running at zero
+//   config                  the live settings
+//   stats                   every metric, "name value" per line
+//   get tick_jitter_p99_ms  one metric
+//   help
+//
+// Changes go through the settings snapshot (ffb_config.h): a new one is published with an atomic swap and
+// the compute stage picks it up on its next frame, ramped like a saved ffb.ini. No FFB thread ever waits
+// on this one, and it runs below normal priority (ApplyBackgroundPriority) whatever Thread Priority says.
+// tools/ffb_ctl.cpp is the client, and its --bench mode checks the tick jitter while the channel is flooded.
+
+#define CONTROL_PIPE_NAME L"\\\\.\\pipe\\x86GP2FFBControl"
+#define CONTROL_SOCKET_PATH "/tmp/x86GP2FFBControl.sock"
+#define CONTROL_MAX_LINE 256                // longer requests are refused
+#define CONTROL_METRICS_MIN_MS 10.0         // metrics are collected at most this often, polling faster gets the same copy
+
+struct ControlMetric {
+    const char* name;
+    double value;
+};
+
+// Fills in the app's metrics, called on the channel thread
+typedef void (*ControlMetricsCollector)(std::vector<ControlMetric>& metrics);
+
+// Include logging
+void LogMessage(const std::wstring& msg);
+
+// One request line -> the whole reply, ending in "ok\n" or "error ...\n"
+std::string HandleControlCommand(const std::string& line);
+
+void StartControlChannel(ControlMetricsCollector collector);
@@ -0,0 +1,217 @@
+#include "device_io.h"
+#include "logger.h"
+#include "thread_policy.h"
+#include "watchdog.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+#define DEVICE_IO_FAILURE_LOG_EVERY 100 // log the first failure per effect, then every Nth
+
+struct EffectMailbox {
+    std::mutex mutex;
+    EffectCommand pending;
+    std::mutex callMutex;               // held across each call into the effect, see DeviceEmergencyStop
+};
+
+static const wchar_t* slotNames[DEVICE_EFFECT_COUNT] = { L"Constant force", L"Damper", L"Spring", L"Vibration" };
+
+static IDirectInputDevice8* ioDevice = nullptr;
+static IDirectInputEffect* ioEffects[DEVICE_EFFECT_COUNT] = {};
+static EffectMailbox mailboxes[DEVICE_EFFECT_COUNT];
+static std::atomic<bool> pollRequested{ false };
+static std::atomic<bool> effectRunning[DEVICE_EFFECT_COUNT] = {};   // as last Started/Stopped on the wheel
+static StageSignal ioSignal;
+
+static std::mutex statsMutex;
+static DeviceIOStats stats;
+
+static DIJOYSTATE2 deviceState;
+
+static double IONowMs() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void PollDevice() {
+    if (!ioDevice) return;
+    if (FAILED(ioDevice->Poll())) {
+        ioDevice->Acquire();
+        ioDevice->Poll();
+    }
+    ioDevice->GetDeviceState(sizeof(DIJOYSTATE2), &deviceState);
+}
+
+static void DeviceIOLoop() {
+    ApplyThreadPolicy(L"Device I/O");
+
+    while (true) {
+        WatchdogBeat(WATCHDOG_DEVICE_IO);
+        ioSignal.Wait(WatchdogIdleWaitMs());  // nothing posted - wake up anyway to beat
+
+        if (pollRequested.exchange(false)) {
+            PollDevice();
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.polls++;
+        }
+
+        double batchMaxMs = 0.0;
+        bool anySent = false;
+        for (int slot = 0; slot < DEVICE_EFFECT_COUNT; slot++) {
+            EffectCommand command;
+            {
+                std::lock_guard<std::mutex> lock(mailboxes[slot].mutex);
+                if (mailboxes[slot].pending.Empty()) continue;
+                command = mailboxes[slot].pending;
+                mailboxes[slot].pending.Clear();
+            }
+            if (!ioEffects[slot]) continue;
+
+            double start = IONowMs();
+            HRESULT hr;
+            {
+                std::lock_guard<std::mutex> call(mailboxes[slot].callMutex);
+                hr = command.Apply(ioEffects[slot]);
+            }
+            double callMs = IONowMs() - start;
+            batchMaxMs = std::max(batchMaxMs, callMs);
+            anySent = true;
+            if (SUCCEEDED(hr) && command.run != EffectRunChange::None) {
+                effectRunning[slot] = command.run == EffectRunChange::Start;
+            }
+
+            unsigned long long failures = 0;
+            {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                stats.effects[slot].sent++;
+                stats.total.sent++;
+                if (FAILED(hr)) {
+                    failures = ++stats.effects[slot].failed;
+                    stats.total.failed++;
+                }
+            }
+            if (failures % DEVICE_IO_FAILURE_LOG_EVERY == 1) {
+                LOG_ERROR(L"[ERROR] %ls update failed: 0x%08lX (%llu so far)", slotNames[slot],
+                    static_cast<unsigned long>(hr), failures);
+            }
+        }
+
+        if (anySent) {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.lastCallMs = batchMaxMs;
+            stats.maxCallMs = std::max(stats.maxCallMs, batchMaxMs);
+        }
+    }
+}
+
+void StartDeviceIO(IDirectInputDevice8* device, IDirectInputEffect* const effects[DEVICE_EFFECT_COUNT]) {
+    ioDevice = device;
+    for (int slot = 0; slot < DEVICE_EFFECT_COUNT; slot++) {
+        ioEffects[slot] = effects[slot];
+    }
+
+    std::thread ioThread(DeviceIOLoop);
+    ioThread.detach();
+    LogMessage(L"[INFO] Device I/O thread started");
+}
+
+void PostEffectCommand(DeviceEffectSlot slot, const EffectCommand& command) {
+    if (slot < 0 || slot >= DEVICE_EFFECT_COUNT || command.Empty()) return;
+
+    bool coalesced = false;
+    bool dropped = false;
+    {
+        std::lock_guard<std::mutex> lock(mailboxes[slot].mutex);
+        EffectCommand& pending = mailboxes[slot].pending;
+        if (pending.Empty()) {
+            pending = command;
+        }
+        else {
+            coalesced = true;
+            dropped = pending.flags != 0 && command.flags != 0;
+            pending.Merge(command);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.effects[slot].posted++;
+        stats.total.posted++;
+        if (coalesced) {
+            stats.effects[slot].coalesced++;
+            stats.total.coalesced++;
+        }
+        if (dropped) {
+            stats.effects[slot].dropped++;
+            stats.total.dropped++;
+        }
+    }
+
+    ioSignal.Notify();
+}
+
+void PostDevicePoll() {
+    pollRequested = true;
+    ioSignal.Notify();
+}
+
+void DeviceEmergencyStop(bool bypassIOThread) {
+    DICONSTANTFORCE cf = { 0 };
+    DIEFFECT eff = {};
+    eff.dwSize = sizeof(DIEFFECT);
+    eff.dwFlags = DIEFF_CARTESIAN | DIEFF_OBJECTOFFSETS;
+    eff.cbTypeSpecificParams = sizeof(DICONSTANTFORCE);
+    eff.lpvTypeSpecificParams = &cf;
+
+    for (int slot = 0; slot < DEVICE_EFFECT_COUNT; slot++) {
+        if (!ioEffects[slot]) continue;
+
+        // The constant force keeps running at zero, like a pause. The rest stop
+        EffectCommand command;
+        if (slot == DEVICE_EFFECT_CONSTANT) {
+            command.Capture(&eff, DIEP_TYPESPECIFICPARAMS);
+        }
+        else if (effectRunning[slot]) {
+            command.run = EffectRunChange::Stop;
+        }
+        else {
+            continue;
+        }
+
+        // The stuck I/O thread is inside one effect's call. Calling into that effect as well could break it,
+        // so its stop waits in the mailbox for the call to return - the others can be stopped from here
+        std::unique_lock<std::mutex> call;
+        if (bypassIOThread) call = std::unique_lock<std::mutex>(mailboxes[slot].callMutex, std::try_to_lock);
+        if (!call.owns_lock()) {
+            PostEffectCommand(static_cast<DeviceEffectSlot>(slot), command);
+            continue;
+        }
+        HRESULT hr = command.Apply(ioEffects[slot]);
+        if (FAILED(hr)) {
+            LOG_ERROR(L"[ERROR] %ls emergency stop failed: 0x%08lX", slotNames[slot], static_cast<unsigned long>(hr));
+        }
+        else if (command.run == EffectRunChange::Stop) {
+            effectRunning[slot] = false;
+        }
+    }
+}
+
+DeviceIOStats GetDeviceIOStats() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <string>
+#include <dinput.h>
+#include "ffb_pipeline.h"
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// Device I/O thread
+// On some belt wheels SetParameters blocks for several milliseconds. Every call to the wheel after
+// start-up goes through here instead: callers post an EffectCommand into that effect's mailbox and
+// carry on, one thread sends them. A mailbox holds a single command - post again before it has gone
+// out and the two are merged, newest wins, so a busy wheel only ever gets the latest force.
+//
+// The mailbox lock is only held to copy a command in or out, never across a device call. Each effect also
+// has a call lock held across its device calls, only ever contended by the watchdog's bypass below.
+
+enum DeviceEffectSlot {
+    DEVICE_EFFECT_CONSTANT,
+    DEVICE_EFFECT_DAMPER,
+    DEVICE_EFFECT_SPRING,
+    DEVICE_EFFECT_VIBRATION,
+    DEVICE_EFFECT_COUNT
+};
+
+struct DeviceEffectStats {
+    unsigned long long posted = 0;
+    unsigned long long sent = 0;        // device calls made (SetParameters/Start/Stop count as one send)
+    unsigned long long coalesced = 0;   // posts merged into one still waiting to go out
+    unsigned long long dropped = 0;     // parameter updates replaced by a newer one before they were sent
+    unsigned long long failed = 0;      // the device said no
+};
+
+struct DeviceIOStats {
+    DeviceEffectStats effects[DEVICE_EFFECT_COUNT];
+    DeviceEffectStats total;
+    unsigned long long polls = 0;
+    double lastCallMs = 0.0;            // longest device call in the last batch sent
+    double maxCallMs = 0.0;
+};
+
+// Include logging
+void LogMessage(const std::wstring& msg);
+
+// Takes the effects created at start-up (null for ones that aren't enabled) and starts the thread
+void StartDeviceIO(IDirectInputDevice8* device, IDirectInputEffect* const effects[DEVICE_EFFECT_COUNT]);
+
+// Never blocks on the wheel
+void PostEffectCommand(DeviceEffectSlot slot, const EffectCommand& command);
+
+// Poll + GetDeviceState on the I/O thread, before the next effect updates
+void PostDevicePoll();
+
+// Watchdog (watchdog.h): zero the constant force and stop whatever else is running.
+// Normally through the mailboxes, but if it is the I/O thread that is stuck in a device call,
+// bypassIOThread makes the calls from the caller's thread instead - the only way left to reach the wheel.
+// Never into the effect the I/O thread is stuck in: that one's stop is posted and goes out when the call returns
+void DeviceEmergencyStop(bool bypassIOThread);
+
+DeviceIOStats GetDeviceIOStats();
@@ -0,0 +1,103 @@
+#include "effect_update.h"
+#include <algorithm>
+#include <climits>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+const wchar_t* EffectUpdateModeName(EffectUpdateMode mode) {
+    switch (mode) {
+    case EffectUpdateMode::FixedRate: return L"fixed rate";
+    case EffectUpdateMode::OnChange: return L"on change";
+    case EffectUpdateMode::Event: return L"event";
+    default: return L"every frame";
+    }
+}
+
+static LONG Gap(LONG a, LONG b) {
+    long long d = static_cast<long long>(a) - b;
+    return static_cast<LONG>(std::min<long long>(d < 0 ? -d : d, LONG_MAX));
+}
+
+LONG EffectParameterDistance(const EffectCommand& a, const EffectCommand& b) {
+    DWORD size = a.eff.cbTypeSpecificParams;
+    if (size != b.eff.cbTypeSpecificParams || a.eff.dwGain != b.eff.dwGain || a.eff.dwDuration != b.eff.dwDuration ||
+        a.eff.cAxes != b.eff.cAxes || memcmp(a.direction, b.direction, sizeof(a.direction)) != 0) {
+        return LONG_MAX;
+    }
+
+    if (size == sizeof(DICONSTANTFORCE)) {
+        DICONSTANTFORCE ca, cb;
+        memcpy(&ca, a.params, sizeof(ca));
+        memcpy(&cb, b.params, sizeof(cb));
+        return Gap(ca.lMagnitude, cb.lMagnitude);
+    }
+    if (size == sizeof(DIPERIODIC)) {
+        DIPERIODIC pa, pb;
+        memcpy(&pa, a.params, sizeof(pa));
+        memcpy(&pb, b.params, sizeof(pb));
+        if (pa.dwPeriod != pb.dwPeriod || pa.dwPhase != pb.dwPhase) return LONG_MAX;
+        return std::max(Gap(static_cast<LONG>(pa.dwMagnitude), static_cast<LONG>(pb.dwMagnitude)), Gap(pa.lOffset, pb.lOffset));
+    }
+    if (size == sizeof(DICONDITION)) {
+        DICONDITION da, db;
+        memcpy(&da, a.params, sizeof(da));
+        memcpy(&db, b.params, sizeof(db));
+        LONG gap = std::max({ Gap(da.lOffset, db.lOffset), Gap(da.lPositiveCoefficient, db.lPositiveCoefficient),
+            Gap(da.lNegativeCoefficient, db.lNegativeCoefficient), Gap(da.lDeadBand, db.lDeadBand) });
+        gap = std::max({ gap, Gap(static_cast<LONG>(da.dwPositiveSaturation), static_cast<LONG>(db.dwPositiveSaturation)),
+            Gap(static_cast<LONG>(da.dwNegativeSaturation), static_cast<LONG>(db.dwNegativeSaturation)) });
+        return gap;
+    }
+    return memcmp(a.params, b.params, std::min<size_t>(size, EFFECT_COMMAND_PARAMS_MAX)) == 0 ? 0 : LONG_MAX;
+}
+
+bool EffectUpdateGate::Ready(const EffectCommand& pending, double nowMs) {
+    if (pending.Empty()) return false;
+
+    bool ready = false;
+    if (pending.run != EffectRunChange::None || !haveSent) {
+        ready = true;
+    }
+    else {
+        switch (policy.mode) {
+        case EffectUpdateMode::EveryFrame:
+            ready = true;
+            break;
+        case EffectUpdateMode::FixedRate:
+            ready = nowMs - lastSentMs >= policy.intervalMs;
+            break;
+        case EffectUpdateMode::OnChange:
+            ready = EffectParameterDistance(pending, lastSent) > policy.threshold ||
+                (policy.refreshMs > 0.0 && nowMs - lastSentMs >= policy.refreshMs);
+            break;
+        case EffectUpdateMode::Event:
+            ready = false;
+            break;
+        }
+    }
+
+    if (!ready) {
+        held.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (pending.flags != 0) lastSent = pending;
+    haveSent = true;
+    lastSentMs = nowMs;
+    sent.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <dinput.h>
+#include "ffb_pipeline.h"
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// Per-effect update rates
+// The force code rebuilds every effect on every frame, but only the constant force really changes that
+// often - the damper follows speed, the spring is fixed and the vibration only moves on and off kerbs.
+// Each effect declares a policy next to its code (*_UPDATE_POLICY), and the output stage holds its
+// newest command back until the policy says it is worth a USB transfer:
+//
+//   every frame - send whatever comes in (constant force)
+//   fixed rate  - at most once per interval, the newest parameters win
+//   on change   - when a parameter has moved by the threshold since the last send, plus a refresh now and then
+//   event       - only with a Start/Stop, the parameters in between are left where they were
+//
+// A Start or Stop always goes straight out, with whatever parameters are waiting.
+
+enum class EffectUpdateMode {
+    EveryFrame,
+    FixedRate,
+    OnChange,
+    Event
+};
+
+struct EffectUpdatePolicy {
+    EffectUpdateMode mode = EffectUpdateMode::EveryFrame;
+    double intervalMs = 0.0;    // fixed rate spacing
+    LONG threshold = 0;         // on change, in the effect's own units (magnitude/coefficient)
+    double refreshMs = 0.0;     // on change, resend at least this often (0 = only on change)
+
+    static constexpr EffectUpdatePolicy EveryFrame() { return { EffectUpdateMode::EveryFrame, 0.0, 0, 0.0 }; }
+    static constexpr EffectUpdatePolicy FixedRate(double hz) { return { EffectUpdateMode::FixedRate, 1000.0 / hz, 0, 0.0 }; }
+    static constexpr EffectUpdatePolicy OnChange(LONG threshold, double refreshMs) { return { EffectUpdateMode::OnChange, 0.0, threshold, refreshMs }; }
+    static constexpr EffectUpdatePolicy Event() { return { EffectUpdateMode::Event, 0.0, 0, 0.0 }; }
+};
+
+const wchar_t* EffectUpdateModeName(EffectUpdateMode mode);
+
+// Largest change between two commands' parameters, LONG_MAX if they can't be compared
+// (different effect type, gain, duration...)
+LONG EffectParameterDistance(const EffectCommand& a, const EffectCommand& b);
+
+// One per effect on the output thread. Held/Sent can be read from the display
+class EffectUpdateGate {
+public:
+    explicit EffectUpdateGate(const EffectUpdatePolicy& policy) : policy(policy) {}
+
+    // True if pending should be posted now (it's recorded as sent). False leaves it pending,
+    // newer commands merge on top and it gets another look next tick
+    bool Ready(const EffectCommand& pending, double nowMs);
+
+    const EffectUpdatePolicy& Policy() const { return policy; }
+    unsigned long long Sent() const { return sent.load(std::memory_order_relaxed); }
+    unsigned long long Held() const { return held.load(std::memory_order_relaxed); }
+
+private:
+    EffectUpdatePolicy policy;
+    EffectCommand lastSent;
+    bool haveSent = false;
+    double lastSentMs = 0.0;
+
+    std::atomic<unsigned long long> sent{ 0 };
+    std::atomic<unsigned long long> held{ 0 };  // ticks a parameter update waited
+};
@@ -0,0 +1,38 @@
+#include "ffb_clock.h"
+#include <chrono>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+static double SteadyMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+RealtimeFFBClock::RealtimeFFBClock() : originMs(SteadyMs()) {}
+
+double RealtimeFFBClock::NowMs() const {
+    return SteadyMs() - originMs;
+}
+
+static RealtimeFFBClock realtimeClock;
+static FFBClock* activeClock = nullptr;
+
+FFBClock& GetFFBClock() {
+    return activeClock ? *activeClock : realtimeClock;
+}
+
+void SetFFBClock(FFBClock* clock) {
+    activeClock = clock;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// The clock the FFB loop runs on, in milliseconds
+// Live that's the real clock. Replays swap in a simulated one so a recording can be pushed
+// through the force code as fast as the CPU goes, with the loop still seeing recorded timing.
+
+class FFBClock {
+public:
+    virtual ~FFBClock() {}
+    virtual double NowMs() const = 0;
+};
+
+// Milliseconds since the clock was created
+class RealtimeFFBClock : public FFBClock {
+public:
+    RealtimeFFBClock();
+    double NowMs() const override;
+
+private:
+    double originMs;
+};
+
+// Only moves when told to
+class SimulatedFFBClock : public FFBClock {
+public:
+    double NowMs() const override { return nowMs; }
+    void SetMs(double ms) { nowMs = ms; }
+    void AdvanceMs(double ms) { nowMs += ms; }
+
+private:
+    double nowMs = 0.0;
+};
+
+// Realtime unless something has been set. Not owned, pass nullptr to go back to realtime
+FFBClock& GetFFBClock();
+void SetFFBClock(FFBClock* clock);
@@ -0,0 +1,363 @@
+#include "ffb_config.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// Only ever read and replaced with std::atomic_load/std::atomic_store
+static std::shared_ptr<const FFBConfig> currentConfig;
+static std::mutex publishMutex;
+static unsigned long long publishedVersion = 0;    // publishMutex held
+
+static std::wstring FormatNumber(double value) {
+    std::wostringstream ss;
+    ss << value;
+    return ss.str();
+}
+
+static void WarnSetting(const wchar_t* name, const std::wstring& value, const wchar_t* problem, const std::wstring& used) {
+    if (value.empty()) {
+        LogMessage(L"[WARNING] " + std::wstring(name) + L" is missing from ffb.ini, using " + used);
+    }
+    else {
+        LogMessage(L"[WARNING] " + std::wstring(name) + L" '" + value + L"' " + problem + L", using " + used);
+    }
+}
+
+static double ParseNumber(const wchar_t* name, const std::wstring& value, double fallback, double minValue, double maxValue) {
+    try {
+        double number = std::stod(value);
+        if (number < minValue || number > maxValue) {
+            number = std::clamp(number, minValue, maxValue);
+            WarnSetting(name, value, L"is out of range", FormatNumber(number));
+        }
+        return number;
+    }
+    catch (const std::exception&) {
+        WarnSetting(name, value, L"is not a number", FormatNumber(fallback));
+        return fallback;
+    }
+}
+
+// Percent setting -> 0 - 1 scale
+static double ParseScale(const wchar_t* name, const std::wstring& value, double fallback) {
+    return ParseNumber(name, value, fallback * 100.0, 0.0, 100.0) / 100.0;
+}
+
+static bool ParseFlag(const wchar_t* name, const std::wstring& value, bool fallback) {
+    if (value == L"true" || value == L"True") return true;
+    if (value == L"false" || value == L"False") return false;
+    WarnSetting(name, value, L"should be 'true' or 'false'", fallback ? L"true" : L"false");
+    return fallback;
+}
+
+static LogFormat ParseLogFormat(const std::wstring& value, LogFormat fallback) {
+    if (value == L"text" || value == L"Text") return LogFormat::Text;
+    if (value == L"binary" || value == L"Binary") return LogFormat::Binary;
+    WarnSetting(L"Log Format", value, L"should be 'text' or 'binary'", fallback == LogFormat::Binary ? L"binary" : L"text");
+    return fallback;
+}
+
+static UpsampleMode ParseUpsampling(const std::wstring& value, UpsampleMode fallback) {
+    UpsampleMode mode = ParseUpsampleMode(value);
+    if (mode != UpsampleMode::Off || value == L"off" || value == L"Off") return mode;
+    WarnSetting(L"Upsampling", value, L"should be 'off', 'linear' or 'hermite'", UpsampleModeName(fallback));
+    return fallback;
+}
+
+FFBConfig BuildFFBConfig(const FFBSettingsText& text, const FFBConfig& fallback) {
+    FFBConfig config;
+    config.masterScale = ParseScale(L"Force", text.forceSetting, fallback.masterScale);
+    config.deadzoneScale = ParseScale(L"Deadzone", text.deadzoneSetting, fallback.deadzoneScale);
+    config.constantScale = ParseScale(L"Constant Scale", text.constantScale, fallback.constantScale);
+    config.brakingScale = ParseNumber(L"Braking Scale", text.brakingScale, fallback.brakingScale, 0.0, 1000.0);
+    config.vibrationScale = ParseScale(L"Vibration Scale", text.vibrationScale, fallback.vibrationScale);
+    config.weightScale = ParseScale(L"Weight Scale", text.weightScale, fallback.weightScale);
+    config.damperScale = ParseScale(L"Damper Scale", text.damperScale, fallback.damperScale);
+    config.invert = ParseFlag(L"Invert", text.invertFFB, fallback.invert);
+
+    config.constantEnabled = ParseFlag(L"Constant", text.constantEnabled, fallback.constantEnabled);
+    config.vibrationEnabled = ParseFlag(L"Vibration", text.vibrationEnabled, fallback.vibrationEnabled);
+    config.weightEnabled = ParseFlag(L"Weight", text.weightEnabled, fallback.weightEnabled);
+    config.damperEnabled = ParseFlag(L"Damper", text.damperEnabled, fallback.damperEnabled);
+    config.springEnabled = ParseFlag(L"Spring", text.springEnabled, fallback.springEnabled);
+    config.updateRateHz = ParseNumber(L"Update Rate", text.updateRate, fallback.updateRateHz, FFB_MIN_RATE_HZ, FFB_MAX_RATE_HZ);
+    config.upsampling = ParseUpsampling(text.upsampling, fallback.upsampling);
+    config.upsamplingPredict = ParseFlag(L"Upsampling Predict", text.upsamplingPredict, fallback.upsamplingPredict);
+    config.watchdogTimeoutMs = ParseNumber(L"Watchdog Timeout", text.watchdogTimeout, fallback.watchdogTimeoutMs, 0.0, 60000.0);
+    config.controlChannel = ParseFlag(L"Control Channel", text.controlChannel, fallback.controlChannel);
+    config.logFormat = ParseLogFormat(text.logFormat, fallback.logFormat);
+    config.recordEnabled = ParseFlag(L"Record", text.recordEnabled, fallback.recordEnabled);
+    config.recordFile = text.recordFile.empty() ? fallback.recordFile : text.recordFile;
+
+    // Not in the file
+    config.constantOn = fallback.constantOn;
+    config.vibrationOn = fallback.vibrationOn;
+    config.damperOn = fallback.damperOn;
+    config.springOn = fallback.springOn;
+    return config;
+}
+
+std::shared_ptr<const FFBConfig> GetFFBConfig() {
+    return std::atomic_load(&currentConfig);
+}
+
+// publishMutex held. The replaced snapshot is freed by whoever lets go of it last
+static void PublishLocked(const FFBConfig& config) {
+    std::shared_ptr<FFBConfig> snapshot = std::make_shared<FFBConfig>(config);
+    snapshot->version = ++publishedVersion;
+    std::atomic_store(&currentConfig, std::shared_ptr<const FFBConfig>(std::move(snapshot)));
+}
+
+void PublishFFBConfig(const FFBConfig& config) {
+    std::lock_guard<std::mutex> lock(publishMutex);
+    PublishLocked(config);
+}
+
+bool EditFFBConfig(const std::function<bool(FFBConfig& next, const FFBConfig& running)>& edit) {
+    std::lock_guard<std::mutex> lock(publishMutex);
+    std::shared_ptr<const FFBConfig> running = std::atomic_load(&currentConfig);
+    if (!running) return false;
+
+    FFBConfig next = *running;
+    if (!edit(next, *running)) return false;
+    PublishLocked(next);
+    return true;
+}
+
+FFBGains GainsOf(const FFBConfig& config) {
+    FFBGains gains;
+    gains.master = config.masterScale;
+    gains.deadzone = config.deadzoneScale;
+    gains.constant = config.constantOn ? config.constantScale : 0.0;
+    gains.braking = config.brakingScale;
+    gains.vibration = config.vibrationOn ? config.vibrationScale : 0.0;
+    gains.weight = config.weightScale;
+    gains.damper = config.damperOn ? config.damperScale : 0.0;
+    gains.spring = config.springOn ? 1.0 : 0.0;
+    gains.direction = config.invert ? -1.0 : 1.0;
+    return gains;
+}
+
+const FFBGains& FFBGainRamp::Update(const FFBConfig& config, double nowMs) {
+    if (config.version != version) {
+        // The first snapshot applies as is, later ones blend from wherever the gains are now
+        to = GainsOf(config);
+        from = version == 0 ? to : current;
+        startMs = nowMs;
+        version = config.version;
+    }
+
+    double t = std::clamp((nowMs - startMs) / FFB_CONFIG_RAMP_MS, 0.0, 1.0);
+    auto blend = [t](double a, double b) { return a + (b - a) * t; };
+    current.master = blend(from.master, to.master);
+    current.deadzone = blend(from.deadzone, to.deadzone);
+    current.constant = blend(from.constant, to.constant);
+    current.braking = blend(from.braking, to.braking);
+    current.vibration = blend(from.vibration, to.vibration);
+    current.weight = blend(from.weight, to.weight);
+    current.damper = blend(from.damper, to.damper);
+    current.spring = blend(from.spring, to.spring);
+    current.direction = blend(from.direction, to.direction);
+    return current;
+}
+
+static void LogLiveChange(const wchar_t* name, double from, double to) {
+    if (from == to) return;
+    LogMessage(L"[INFO] " + std::wstring(name) + L": " + FormatNumber(from) + L" -> " + FormatNumber(to));
+}
+
+static void LogRestartChange(const wchar_t* name, bool changed) {
+    if (changed) LogMessage(L"[WARNING] " + std::wstring(name) + L" changed in ffb.ini, it takes effect after a restart");
+}
+
+static void ReloadFFBConfig(const std::wstring& filename) {
+    FFBSettingsText text;
+    if (!ReadFFBSettings(filename, text)) {
+        LogMessage(L"[WARNING] Could not read " + filename + L", keeping the current settings");
+        return;
+    }
+
+    // Built against whatever is running at the time, so a control channel change made meanwhile stays
+    EditFFBConfig([&text](FFBConfig& next, const FFBConfig& running) {
+        next = BuildFFBConfig(text, running);
+
+        // These were used to set things up - say so if they changed, but keep describing what is running
+        LogRestartChange(L"Constant", next.constantEnabled != running.constantEnabled);
+        LogRestartChange(L"Vibration", next.vibrationEnabled != running.vibrationEnabled);
+        LogRestartChange(L"Weight", next.weightEnabled != running.weightEnabled);
+        LogRestartChange(L"Damper", next.damperEnabled != running.damperEnabled);
+        LogRestartChange(L"Spring", next.springEnabled != running.springEnabled);
+        LogRestartChange(L"Update Rate", next.updateRateHz != running.updateRateHz);
+        LogRestartChange(L"Upsampling", next.upsampling != running.upsampling || next.upsamplingPredict != running.upsamplingPredict);
+        LogRestartChange(L"Watchdog Timeout", next.watchdogTimeoutMs != running.watchdogTimeoutMs);
+        LogRestartChange(L"Control Channel", next.controlChannel != running.controlChannel);
+        LogRestartChange(L"Log Format", next.logFormat != running.logFormat);
+        LogRestartChange(L"Record", next.recordEnabled != running.recordEnabled || next.recordFile != running.recordFile);
+        next.constantEnabled = running.constantEnabled;
+        next.vibrationEnabled = running.vibrationEnabled;
+        next.weightEnabled = running.weightEnabled;
+        next.damperEnabled = running.damperEnabled;
+        next.springEnabled = running.springEnabled;
+        next.updateRateHz = running.updateRateHz;
+        next.upsampling = running.upsampling;
+        next.upsamplingPredict = running.upsamplingPredict;
+        next.watchdogTimeoutMs = running.watchdogTimeoutMs;
+        next.controlChannel = running.controlChannel;
+        next.logFormat = running.logFormat;
+        next.recordEnabled = running.recordEnabled;
+        next.recordFile = running.recordFile;
+
+        // Saved without touching a live setting (a comment, or one of the above)
+        if (next.masterScale == running.masterScale && next.deadzoneScale == running.deadzoneScale &&
+            next.constantScale == running.constantScale && next.brakingScale == running.brakingScale &&
+            next.vibrationScale == running.vibrationScale && next.weightScale == running.weightScale &&
+            next.damperScale == running.damperScale && next.invert == running.invert) {
+            return false;
+        }
+
+        LogMessage(L"[INFO] ffb.ini changed, ramping in the new settings");
+        LogLiveChange(L"Force", running.masterScale * 100.0, next.masterScale * 100.0);
+        LogLiveChange(L"Deadzone", running.deadzoneScale * 100.0, next.deadzoneScale * 100.0);
+        LogLiveChange(L"Constant Scale", running.constantScale * 100.0, next.constantScale * 100.0);
+        LogLiveChange(L"Braking Scale", running.brakingScale, next.brakingScale);
+        LogLiveChange(L"Vibration Scale", running.vibrationScale * 100.0, next.vibrationScale * 100.0);
+        LogLiveChange(L"Weight Scale", running.weightScale * 100.0, next.weightScale * 100.0);
+        LogLiveChange(L"Damper Scale", running.damperScale * 100.0, next.damperScale * 100.0);
+        if (next.invert != running.invert) LogMessage(L"[INFO] Invert: " + std::wstring(next.invert ? L"true" : L"false"));
+
+        return true;
+    });
+}
+
+// Directory and bare name, for watching the directory
+static void SplitPath(const std::wstring& path, std::wstring& directory, std::wstring& name) {
+    size_t slash = path.find_last_of(L"\\/");
+    if (slash == std::wstring::npos) {
+        directory = L".";
+        name = path;
+    }
+    else {
+        directory = path.substr(0, slash + 1);
+        name = path.substr(slash + 1);
+    }
+}
+
+static void SettleWrite() {
+    std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(FFB_CONFIG_SETTLE_MS));
+}
+
+#ifdef _WIN32
+
+static bool LastWriteTime(const std::wstring& path, FILETIME& time) {
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data)) return false;
+    time = data.ftLastWriteTime;
+    return true;
+}
+
+static void WatchLoop(std::wstring filename) {
+    std::wstring directory, name;
+    SplitPath(filename, directory, name);
+
+    // Fires for anything written in the directory (the log too), the file's own write time says if it was us
+    HANDLE change = FindFirstChangeNotificationW(directory.c_str(), FALSE,
+        FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+    if (change == INVALID_HANDLE_VALUE) {
+        LogMessage(L"[WARNING] Can't watch " + filename + L" for changes (error " + std::to_wstring(GetLastError()) +
+            L"), restart the app to apply new settings");
+        return;
+    }
+
+    FILETIME lastWrite = {};
+    LastWriteTime(filename, lastWrite);
+
+    while (WaitForSingleObject(change, INFINITE) == WAIT_OBJECT_0) {
+        FILETIME written = {};
+        if (LastWriteTime(filename, written) && CompareFileTime(&written, &lastWrite) != 0) {
+            SettleWrite();
+            LastWriteTime(filename, lastWrite);
+            ReloadFFBConfig(filename);
+        }
+        if (!FindNextChangeNotification(change)) break;
+    }
+    FindCloseChangeNotification(change);
+    LogMessage(L"[WARNING] Stopped watching " + filename + L" for changes");
+}
+
+#else
+
+static std::string NarrowPath(const std::wstring& path) {
+    std::string narrow(path.size() * MB_LEN_MAX + 1, '\0');
+    size_t length = wcstombs(&narrow[0], path.c_str(), narrow.size());
+    if (length == static_cast<size_t>(-1)) return std::string(path.begin(), path.end());
+    narrow.resize(length);
+    return narrow;
+}
+
+static void WatchLoop(std::wstring filename) {
+    std::wstring directory, name;
+    SplitPath(filename, directory, name);
+    std::string narrowName = NarrowPath(name);
+
+    // The directory, not the file: editors often save by renaming a new file over the old one
+    int fd = inotify_init1(IN_CLOEXEC);
+    if (fd < 0 || inotify_add_watch(fd, NarrowPath(directory).c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        LogMessage(L"[WARNING] Can't watch " + filename + L" for changes, restart the app to apply new settings");
+        if (fd >= 0) close(fd);
+        return;
+    }
+
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0) break;
+
+        bool ours = false;
+        for (ssize_t offset = 0; offset < length; ) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            if (event->len > 0 && narrowName == event->name) ours = true;
+            offset += sizeof(inotify_event) + event->len;
+        }
+        if (ours) {
+            SettleWrite();
+            ReloadFFBConfig(filename);
+        }
+    }
+    close(fd);
+    LogMessage(L"[WARNING] Stopped watching " + filename + L" for changes");
+}
+
+#endif
+
+void StartFFBConfigWatcher(const std::wstring& filename) {
+    if (!GetFFBConfig()) return;
+    std::thread watcher(WatchLoop, filename);
+    watcher.detach();
+    LogMessage(L"[INFO] Watching " + filename + L" - Force, Deadzone, Invert and the Scale settings apply when it is saved");
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include "ffb_settings_text.h"
+#include "forces/force_upsampler.h"
+#include "logger.h"
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// Settings snapshot
+// ffb.ini is checked once into an FFBConfig of plain numbers and flags, so the force code never parses
+// text per frame. Snapshots are immutable: a reload builds a new one and swaps the pointer. They are shared_ptrs,
+// so a replaced one lives on for as long as any reader still holds it, however long that thread is kept waiting.
+//
+// While the app runs ffb.ini is watched. Saving it reloads the live settings - Force, Deadzone, Invert and the
+// Scale settings - which FFBGainRamp blends in over FFB_CONFIG_RAMP_MS instead of stepping the wheel.
+// Everything else picks effects, rates or threads at startup and only logs that it needs a restart.
+
+#define FFB_CONFIG_RAMP_MS 500.0        // how long a reloaded gain takes to fully apply
+#define FFB_CONFIG_SETTLE_MS 100.0      // after a change notification, let the editor finish writing
+#define FFB_MIN_RATE_HZ 30.0            // Update Rate limits
+#define FFB_MAX_RATE_HZ 1000.0
+
+struct FFBConfig {
+    unsigned long long version = 0;     // 1 for the startup settings, +1 per reload
+
+    // Live, reloaded while running. Scales are 0 - 1 as the force code applies them
+    double masterScale = 0.25;          // Force
+    double deadzoneScale = 0.0;
+    double constantScale = 1.0;
+    double brakingScale = 50.0;         // as written, the force code does the /100
+    double vibrationScale = 0.25;
+    double weightScale = 0.01;
+    double damperScale = 1.0;
+    bool invert = false;
+
+    // Live effect switches, only the control channel (control_channel.h) turns them off.
+    // An effect that is off keeps running at zero, so it can come back without a restart
+    bool constantOn = true;
+    bool vibrationOn = true;
+    bool damperOn = true;
+    bool springOn = true;
+
+    // Startup only
+    bool constantEnabled = false;
+    bool vibrationEnabled = false;
+    bool weightEnabled = false;
+    bool damperEnabled = false;
+    bool springEnabled = false;
+    double updateRateHz = 60.0;
+    UpsampleMode upsampling = UpsampleMode::Off;
+    bool upsamplingPredict = false;
+    double watchdogTimeoutMs = 250.0;
+    bool controlChannel = true;
+    LogFormat logFormat = LogFormat::Text;
+    bool recordEnabled = false;
+    std::wstring recordFile = L"telemetry.gp2rec";
+};
+
+// The gains the force code multiplies by, blended by FFBGainRamp
+struct FFBGains {
+    double master = 0.0;
+    double deadzone = 0.0;
+    double constant = 0.0;
+    double braking = 0.0;
+    double vibration = 0.0;
+    double weight = 0.0;
+    double damper = 0.0;
+    double spring = 0.0;                // 0 or 1, the spring only follows Force
+    double direction = 1.0;             // -1 inverted, passes through 0 while Invert is ramped over
+};
+
+// Include logging
+void LogMessage(const std::wstring& msg);
+
+// Checks every value. One that is missing, not a number or out of range is logged and
+// replaced by fallback's (the defaults at startup, the running value on a reload)
+FFBConfig BuildFFBConfig(const FFBSettingsText& text, const FFBConfig& fallback);
+
+// Never null once LoadFFBSettings has run. One atomic load, safe from any thread.
+// The snapshot stays valid while the returned pointer is held, even after it is replaced
+std::shared_ptr<const FFBConfig> GetFFBConfig();
+void PublishFFBConfig(const FFBConfig& config);
+
+// Copy the running snapshot, let edit change the copy and publish it, all under the one lock, so two
+// changes made at once can't both start from the same snapshot and undo each other.
+// edit returns false to leave things as they are. False if nothing was published
+bool EditFFBConfig(const std::function<bool(FFBConfig& next, const FFBConfig& running)>& edit);
+
+FFBGains GainsOf(const FFBConfig& config);
+
+// Owned by the thread that applies the gains
+class FFBGainRamp {
+public:
+    // Gains to use now, moving toward config's whenever a newer version turns up
+    const FFBGains& Update(const FFBConfig& config, double nowMs);
+
+private:
+    unsigned long long version = 0;
+    double startMs = 0.0;
+    FFBGains from;
+    FFBGains to;
+    FFBGains current;
+};
+
+// Reload the live settings whenever filename is saved (inotify on Linux, change notifications on Windows)
+void StartFFBConfigWatcher(const std::wstring& filename);
@@ -0,0 +1,107 @@
+#include "ffb_output.h"
+#include "forces/constant_force.h"
+#include <algorithm>
+#include <cmath>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// The order they go out in each tick, the constant force after the slow effects as before
+static const DeviceEffectSlot postOrder[DEVICE_EFFECT_COUNT] = {
+    DEVICE_EFFECT_DAMPER, DEVICE_EFFECT_SPRING, DEVICE_EFFECT_CONSTANT, DEVICE_EFFECT_VIBRATION
+};
+
+FFBOutput::FFBOutput(double intervalMs, UpsampleMode mode, bool predict, bool upsampleConstant,
+    EffectUpdateGate* const gates[DEVICE_EFFECT_COUNT], FFBOutputSink& sink)
+    : intervalMs(intervalMs), scheduler(intervalMs), upsampler(mode, predict),
+      upsampling(mode != UpsampleMode::Off && upsampleConstant), sink(sink) {
+    for (int slot = 0; slot < DEVICE_EFFECT_COUNT; slot++) this->gates[slot] = gates[slot];
+}
+
+void FFBOutput::FrameArrived(ForceFrame& force) {
+    state = force.state;
+    if (force.restart || GameStateIsIdle(force.state)) {
+        upsampler.Reset();
+        frameLock.Reset();
+        upsampledForceSent = false;
+    }
+
+    // An idle frame only carries the zeroed effects, it isn't a game frame to lock on to
+    if (!GameStateIsIdle(force.state)) {
+        // Once locked, the tick grid follows the game's frames (several ticks a frame above 60Hz)
+        frameLock.FrameArrived(force.arrivalMs, force.fps);
+        if (frameLock.Locked()) {
+            double ticksPerFrame = std::max(1.0, std::round(frameLock.PeriodMs() / intervalMs));
+            scheduler.LockTo(frameLock.NextTickMs(), frameLock.PeriodMs() / ticksPerFrame);
+            ticksLocked = true;
+        }
+        else if (ticksLocked) {
+            scheduler.SetPeriodMs(intervalMs);
+            ticksLocked = false;
+        }
+
+        // Upsampled, the constant force's magnitude goes out on every tick instead
+        LONG magnitude = 0;
+        if (upsampling && force.constant.ConstantMagnitude(magnitude)) {
+            if (force.fps > 1.0f) upsampler.SetFramePeriodMs(1000.0 / force.fps);
+            upsampler.AddSample(force.arrivalMs, magnitude);
+            force.constant.flags &= ~DIEP_TYPESPECIFICPARAMS;
+        }
+
+        pendingPoll = pendingPoll || force.pollDevice;
+        framesSinceTick++;
+    }
+
+    pending[DEVICE_EFFECT_CONSTANT].Merge(force.constant);
+    pending[DEVICE_EFFECT_DAMPER].Merge(force.damper);
+    pending[DEVICE_EFFECT_SPRING].Merge(force.spring);
+    pending[DEVICE_EFFECT_VIBRATION].Merge(force.vibration);
+}
+
+int FFBOutput::Tick(double nowMs, bool forcesZeroed) {
+    int frames = framesSinceTick;
+    framesSinceTick = 0;
+
+    if (pendingPoll) {
+        sink.PostPoll();
+        pendingPoll = false;
+    }
+
+    EffectCommand& constant = pending[DEVICE_EFFECT_CONSTANT];
+    if (constant.run == EffectRunChange::Start) constantRunning = true;
+    if (constant.run == EffectRunChange::Stop) constantRunning = false;
+
+    // Each effect at its own rate, anything held back stays pending and newer frames merge on top
+    for (DeviceEffectSlot slot : postOrder) {
+        if (gates[slot]->Ready(pending[slot], nowMs)) {
+            sink.PostEffect(slot, pending[slot]);
+            pending[slot].Clear();
+        }
+    }
+
+    // Between game frames the upsampler fills in the constant force at the output rate
+    // (not while the forces are zeroed - it would only be stretching out old frames)
+    if (upsampling && constantRunning && !GameStateIsIdle(state) && !forcesZeroed) {
+        long upsampledForce = 0;
+        if (upsampler.Evaluate(nowMs, upsampledForce) && (!upsampledForceSent || upsampledForce != lastUpsampledForce)) {
+            SendConstantForceMagnitude(&upsampledConstant, upsampledForce);
+            sink.PostEffect(DEVICE_EFFECT_CONSTANT, upsampledConstant.Take());
+            lastUpsampledForce = upsampledForce;
+            upsampledForceSent = true;
+        }
+    }
+
+    scheduler.CompleteTick(nowMs);
+    return frames;
+}
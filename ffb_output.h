@@ -0,0 +1,85 @@
+#pragma once
+#include <string>
+#include "ffb_pipeline.h"
+#include "ffb_scheduler.h"
+#include "frame_lock.h"
+#include "effect_update.h"
+#include "device_io.h"
+#include "forces/force_upsampler.h"
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// FFB output
+// What the output stage decides each tick, apart from the thread it runs on and the clock it waits on:
+// ForceFrames from compute are folded together (newest wins), the frame lock steers the tick grid onto the
+// game's frames, the upsampler fills in the constant force between them and each effect's update gate
+// decides what is worth sending. The result goes to an FFBOutputSink - the device I/O thread live, a
+// stand-in in tools/ffb_replay.cpp, so a replay runs exactly what the wheel would have been sent.
+
+// Include logging
+void LogMessage(const std::wstring& msg);
+
+// Where a tick's commands go
+class FFBOutputSink {
+public:
+    virtual ~FFBOutputSink() {}
+    virtual void PostEffect(DeviceEffectSlot slot, const EffectCommand& command) = 0;
+    virtual void PostPoll() = 0;
+};
+
+class FFBOutput {
+public:
+    // gates are indexed by DeviceEffectSlot. upsampleConstant is false if there is no constant force to upsample
+    FFBOutput(double intervalMs, UpsampleMode mode, bool predict, bool upsampleConstant,
+        EffectUpdateGate* const gates[DEVICE_EFFECT_COUNT], FFBOutputSink& sink);
+
+    // A frame from compute, folded into what the next tick sends
+    void FrameArrived(ForceFrame& force);
+
+    // One tick starting at nowMs. forcesZeroed leaves the upsampler alone (the watchdog has the wheel at zero).
+    // Returns how many frames went into it, 0 = a tick with no new frame
+    int Tick(double nowMs, bool forcesZeroed);
+
+    // State of the newest frame. Idle means there is nothing to tick for until the next one
+    GameState State() const { return state; }
+
+    FFBTickScheduler& Scheduler() { return scheduler; }
+    const FramePhaseLock& FrameLock() const { return frameLock; }
+    const ForceUpsampler& Upsampler() const { return upsampler; }
+    double IntervalMs() const { return intervalMs; }
+    bool Upsampling() const { return upsampling; }
+
+private:
+    double intervalMs;
+    FFBTickScheduler scheduler;
+    FramePhaseLock frameLock;
+    bool ticksLocked = false;
+
+    ForceUpsampler upsampler;
+    bool upsampling;
+    DeferredEffect upsampledConstant;
+    long lastUpsampledForce = 0;
+    bool upsampledForceSent = false;
+
+    EffectUpdateGate* gates[DEVICE_EFFECT_COUNT];
+    FFBOutputSink& sink;
+
+    // What has come in since the last tick, newest wins
+    EffectCommand pending[DEVICE_EFFECT_COUNT];
+    bool pendingPoll = false;
+    int framesSinceTick = 0;
+    bool constantRunning = false;
+    GameState state = GameState::Detached;     // nothing to tick for until the first race frame
+};
@@ -0,0 +1,123 @@
+#include "ffb_pipeline.h"
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// === EffectCommand ===
+
+bool EffectCommand::Capture(LPCDIEFFECT source, DWORD sourceFlags) {
+    if (!source) return false;
+    if (source->cAxes > EFFECT_COMMAND_AXES) return false;
+    if (source->lpvTypeSpecificParams && source->cbTypeSpecificParams > EFFECT_COMMAND_PARAMS_MAX) return false;
+
+    eff = *source;
+    if (source->rgdwAxes) memcpy(axes, source->rgdwAxes, source->cAxes * sizeof(DWORD));
+    if (source->rglDirection) memcpy(direction, source->rglDirection, source->cAxes * sizeof(LONG));
+    if (source->lpEnvelope) envelope = *source->lpEnvelope;
+    if (source->lpvTypeSpecificParams) memcpy(params, source->lpvTypeSpecificParams, source->cbTypeSpecificParams);
+
+    flags |= sourceFlags;
+    return true;
+}
+
+void EffectCommand::Merge(const EffectCommand& newer) {
+    if (newer.flags != 0) {
+        DWORD merged = flags | newer.flags;
+        EffectRunChange keepRun = run;
+        *this = newer;
+        flags = merged;
+        run = keepRun;
+    }
+    if (newer.run != EffectRunChange::None) run = newer.run;
+}
+
+bool EffectCommand::ConstantMagnitude(LONG& magnitude) const {
+    if (!(flags & DIEP_TYPESPECIFICPARAMS) || eff.cbTypeSpecificParams != sizeof(DICONSTANTFORCE)) return false;
+    DICONSTANTFORCE cf;
+    memcpy(&cf, params, sizeof(cf));
+    magnitude = cf.lMagnitude;
+    return true;
+}
+
+HRESULT EffectCommand::Apply(IDirectInputEffect* effect) const {
+    if (!effect) return E_POINTER;
+    HRESULT result = S_OK;
+
+    if (flags != 0) {
+        // Point the copy at our own storage
+        DIEFFECT send = eff;
+        DIENVELOPE sendEnvelope = envelope;
+        send.rgdwAxes = eff.rgdwAxes ? const_cast<DWORD*>(axes) : nullptr;
+        send.rglDirection = eff.rglDirection ? const_cast<LONG*>(direction) : nullptr;
+        send.lpEnvelope = eff.lpEnvelope ? &sendEnvelope : nullptr;
+        send.lpvTypeSpecificParams = eff.lpvTypeSpecificParams ? const_cast<unsigned char*>(params) : nullptr;
+        result = effect->SetParameters(&send, flags);
+    }
+
+    HRESULT runResult = S_OK;
+    if (run == EffectRunChange::Start) runResult = effect->Start(1, 0);
+    else if (run == EffectRunChange::Stop) runResult = effect->Stop();
+
+    return FAILED(result) ? result : runResult;
+}
+
+// === StageSignal ===
+
+void StageSignal::Notify() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        signalled = true;
+    }
+    condition.notify_one();
+}
+
+bool StageSignal::Wait(double timeoutMs) {
+    std::unique_lock<std::mutex> lock(mutex);
+    bool woken = condition.wait_for(lock, std::chrono::duration<double, std::milli>(timeoutMs), [this] { return signalled; });
+    signalled = false;
+    return woken;
+}
+
+// === PipelineStageMeter ===
+
+static double MeterNowMs() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void PipelineStageMeter::Begin() {
+    beginMs = MeterNowMs();
+}
+
+void PipelineStageMeter::End() {
+    double spent = MeterNowMs() - beginMs;
+    // Only this stage's thread writes, so a load/store pair is enough
+    busyMs.store(busyMs.load(std::memory_order_relaxed) + spent, std::memory_order_relaxed);
+    items.fetch_add(1, std::memory_order_relaxed);
+}
+
+PipelineStageStats PipelineStageMeter::Stats() const {
+    PipelineStageStats s;
+    s.items = items.load(std::memory_order_relaxed);
+    s.busyMs = busyMs.load(std::memory_order_relaxed);
+    s.atMs = MeterNowMs();
+    return s;
+}
+
+double PipelineStageStats::Occupancy(const PipelineStageStats& previous) const {
+    if (previous.atMs < 0.0 || atMs <= previous.atMs) return 0.0;
+    return std::clamp((busyMs - previous.busyMs) / (atMs - previous.atMs), 0.0, 1.0);
+}
@@ -0,0 +1,175 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <dinput.h>
+#include "telemetry_reader.h"
+#include "game_state.h"
+#include "spsc_ring.h"
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// FFB pipeline
+// The process loop is three threads joined by SpscRings:
+//
+//   reader  - waits for x86GP2's frames, version check, pushes each new frame      -> PipelineFrame ring
+//   compute - vehicle dynamics and the force effects, per frame                     -> ForceFrame ring
+//   output  - the FFB tick: frame lock and upsampling                               -> device I/O thread (device_io.h)
+//
+// The force code still talks to IDirectInputEffects, but on the compute thread those are DeferredEffects
+// that only write down what was asked for. The output thread folds everything that arrived since its
+// last tick into one EffectCommand per effect (newest wins) and posts that to the device I/O thread,
+// so a slow USB call holds up the next device update and nothing else.
+//
+// Everything from here to the wheel is Windows-only: the force code, EffectCommand/DeferredEffect, the update
+// gates (effect_update.h), the output stage (ffb_output.h), device I/O and tools/ffb_replay.cpp all work in
+// DIEFFECTs and need dinput.h. What builds on Linux without it is the telemetry side (telemetry_source.h,
+// the reader and recorder), vehicle dynamics, game state, the tick scheduler and frame lock, the upsampler,
+// the settings (ffb_config.h, ffb_settings_text.h), the control channel, the logger, the clock, thread
+// policy and the console.
+
+#define PIPELINE_FRAME_RING 16          // reader -> compute, frames
+#define PIPELINE_FORCE_RING 16          // compute -> output, force updates
+#define EFFECT_COMMAND_PARAMS_MAX 32    // biggest type specific block sent (DIPERIODIC 16, DICONDITION 24)
+#define EFFECT_COMMAND_AXES 2
+
+// Reader -> compute
+struct PipelineFrame {
+    RawTelemetry telemetry;
+    RawTelemetryExtras extras;
+    bool hasDisplayFields = false;  // decoded with DISPLAY_FIELDS, compute copies it to the display
+    bool restart = false;           // first frame after (re)attaching or back from idle, drop anything carried over
+    GameState state = GameState::Racing;    // idle states only send a frame when they are entered
+    double arrivalMs = 0.0;         // FFB clock time the reader saw it
+};
+
+enum class EffectRunChange {
+    None,
+    Start,
+    Stop
+};
+
+// One effect's pending SetParameters/Start/Stop, with its own copy of everything the DIEFFECT pointed at
+// The force code always fills in the whole DIEFFECT, so a newer capture replaces an older one outright
+struct EffectCommand {
+    DWORD flags = 0;                // DIEP_* to send, 0 = no parameter change
+    EffectRunChange run = EffectRunChange::None;
+    DIEFFECT eff = {};
+    DWORD axes[EFFECT_COMMAND_AXES] = {};
+    LONG direction[EFFECT_COMMAND_AXES] = {};
+    DIENVELOPE envelope = {};
+    unsigned char params[EFFECT_COMMAND_PARAMS_MAX] = {};
+
+    bool Empty() const { return flags == 0 && run == EffectRunChange::None; }
+    void Clear() { flags = 0; run = EffectRunChange::None; }
+
+    // False if the parameters don't fit (the call is dropped)
+    bool Capture(LPCDIEFFECT source, DWORD sourceFlags);
+
+    // Fold a newer command in on top of this one
+    void Merge(const EffectCommand& newer);
+
+    // The constant force magnitude, if this command sets one
+    bool ConstantMagnitude(LONG& magnitude) const;
+
+    // SetParameters, then Start/Stop. Returns the first failure
+    HRESULT Apply(IDirectInputEffect* effect) const;
+};
+
+// Compute -> output
+struct ForceFrame {
+    double arrivalMs = 0.0;         // when the frame it came from turned up, for the frame lock
+    float fps = 0.0f;
+    bool restart = false;
+    GameState state = GameState::Racing;
+    bool pollDevice = false;        // the old loop polled the wheel on every frame with valid dynamics
+    EffectCommand constant;
+    EffectCommand damper;
+    EffectCommand spring;
+    EffectCommand vibration;
+};
+
+// Looks like an effect to the force code, writes its calls down for the output thread
+// Only the calls the force code makes do anything, the rest say not implemented
+class DeferredEffect : public IDirectInputEffect {
+public:
+    // Hand over what has built up and start a fresh command
+    EffectCommand Take() {
+        EffectCommand taken = pending;
+        pending.Clear();
+        return taken;
+    }
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID, LPVOID* out) override { if (out) *out = nullptr; return E_NOINTERFACE; }
+    ULONG STDMETHODCALLTYPE AddRef() override { return 1; }
+    ULONG STDMETHODCALLTYPE Release() override { return 1; }
+    HRESULT STDMETHODCALLTYPE Initialize(HINSTANCE, DWORD, REFGUID) override { return E_NOTIMPL; }
+    HRESULT STDMETHODCALLTYPE GetEffectGuid(LPGUID) override { return E_NOTIMPL; }
+    HRESULT STDMETHODCALLTYPE GetParameters(LPDIEFFECT, DWORD) override { return E_NOTIMPL; }
+    HRESULT STDMETHODCALLTYPE GetEffectStatus(LPDWORD) override { return E_NOTIMPL; }
+    HRESULT STDMETHODCALLTYPE Download() override { return E_NOTIMPL; }
+    HRESULT STDMETHODCALLTYPE Unload() override { return E_NOTIMPL; }
+    HRESULT STDMETHODCALLTYPE Escape(LPDIEFFESCAPE) override { return E_NOTIMPL; }
+
+    HRESULT STDMETHODCALLTYPE SetParameters(LPCDIEFFECT eff, DWORD flags) override {
+        return pending.Capture(eff, flags) ? S_OK : E_INVALIDARG;
+    }
+    HRESULT STDMETHODCALLTYPE Start(DWORD, DWORD) override { pending.run = EffectRunChange::Start; return S_OK; }
+    HRESULT STDMETHODCALLTYPE Stop() override { pending.run = EffectRunChange::Stop; return S_OK; }
+
+private:
+    EffectCommand pending;
+};
+
+// Wakes a stage when the one before it has pushed something
+// The rings don't need it, it is only so an idle stage can sleep instead of spinning
+class StageSignal {
+public:
+    void Notify();
+
+    // True if notified, false on timeout
+    bool Wait(double timeoutMs);
+
+private:
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool signalled = false;
+};
+
+struct PipelineStageStats {
+    unsigned long long items = 0;   // frames/ticks the stage has handled
+    double busyMs = 0.0;            // total time spent working rather than waiting
+    double atMs = -1.0;             // when the totals were read, -1 = never
+
+    // Share of the time busy between an earlier sample and this one, 0 for the first
+    double Occupancy(const PipelineStageStats& previous) const;
+};
+
+// Busy time for one stage. Begin/End on the stage's thread, Stats from any thread
+// Stats only reads the running totals, so the display and the control channel each keep their own
+// previous sample and work out the occupancy over their own interval
+class PipelineStageMeter {
+public:
+    void Begin();
+    void End();
+
+    PipelineStageStats Stats() const;
+
+private:
+    double beginMs = 0.0;
+    std::atomic<unsigned long long> items{ 0 };
+    std::atomic<double> busyMs{ 0.0 };
+};
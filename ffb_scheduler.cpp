@@ -0,0 +1,123 @@
+#include "ffb_scheduler.h"
+#include "ffb_clock.h"
+#include "logger.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+#define FFB_SCHEDULER_REPORT_MS 60000.0 // log tick timing once a minute, whatever the rate
+
+FFBTickScheduler::FFBTickScheduler(double periodMs) : periodMs(periodMs) {
+    jitter.reserve(FFB_JITTER_WINDOW);
+    wakeLate.reserve(FFB_JITTER_WINDOW);
+}
+
+void FFBTickScheduler::SetPeriodMs(double newPeriodMs) {
+    // Keep the next deadline, only the spacing after it changes
+    periodMs = newPeriodMs;
+    lastTickMs = -1.0; // intervals across the change aren't jitter
+}
+
+void FFBTickScheduler::LockTo(double anchorMs, double newPeriodMs) {
+    periodMs = newPeriodMs;
+    if (lastTickMs < 0.0) {
+        nextDeadlineMs = anchorMs;
+        return;
+    }
+    double earliest = lastTickMs + periodMs * 0.5;
+    nextDeadlineMs = anchorMs - std::floor((anchorMs - earliest) / periodMs) * periodMs;
+}
+
+void FFBTickScheduler::CompleteTick(double tickStartMs) {
+    ticks++;
+
+    if (lastTickMs >= 0.0) {
+        double error = std::fabs((tickStartMs - lastTickMs) - periodMs);
+        double late = std::max(0.0, tickStartMs - nextDeadlineMs);
+        if (jitter.size() < FFB_JITTER_WINDOW) {
+            jitter.push_back(error);
+            wakeLate.push_back(late);
+        }
+        else {
+            jitter[jitterNext] = error;
+            wakeLate[jitterNext] = late;
+            jitterNext = (jitterNext + 1) % FFB_JITTER_WINDOW;
+        }
+    }
+    lastTickMs = tickStartMs;
+
+    // Next deadline on the grid, skipping any we have already blown through
+    nextDeadlineMs += periodMs;
+    if (nextDeadlineMs <= tickStartMs) {
+        double missed = std::floor((tickStartMs - nextDeadlineMs) / periodMs) + 1.0;
+        nextDeadlineMs += missed * periodMs;
+        overruns++;
+        skippedTicks += static_cast<unsigned long long>(missed);
+    }
+
+    if (lastReportMs < 0.0) lastReportMs = tickStartMs;
+    if (tickStartMs - lastReportMs >= FFB_SCHEDULER_REPORT_MS) {
+        lastReportMs = tickStartMs;
+        FFBSchedulerStats s = Stats();
+        LOG_INFO(L"[INFO] FFB tick jitter p50 %f ms, p99 %f ms, max %f ms, overruns %llu, skipped %llu, "
+            L"wake late p99 %f ms, max %f ms, preempted %llu (longest %f ms)",
+            s.jitterP50Ms, s.jitterP99Ms, s.jitterMaxMs, s.overruns, s.skippedTicks,
+            s.wakeLateP99Ms, s.wakeLateMaxMs, s.preemptions, s.longestPreemptionMs);
+    }
+}
+
+void FFBTickScheduler::SpinUntilDue() {
+    double previous = GetFFBClock().NowMs();
+    while (previous < nextDeadlineMs) {
+        std::this_thread::yield();
+        double now = GetFFBClock().NowMs();
+        if (now - previous >= FFB_PREEMPT_GAP_MS) {
+            preemptions++;
+            longestPreemptionMs = std::max(longestPreemptionMs, now - previous);
+        }
+        previous = now;
+    }
+}
+
+static double Percentile(std::vector<double>& sorted, double fraction) {
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+FFBSchedulerStats FFBTickScheduler::Stats() const {
+    FFBSchedulerStats s;
+    s.ticks = ticks;
+    s.overruns = overruns;
+    s.skippedTicks = skippedTicks;
+    s.preemptions = preemptions;
+    s.longestPreemptionMs = longestPreemptionMs;
+
+    if (!jitter.empty()) {
+        std::vector<double> sorted(jitter);
+        std::sort(sorted.begin(), sorted.end());
+        s.jitterP50Ms = Percentile(sorted, 0.50);
+        s.jitterP95Ms = Percentile(sorted, 0.95);
+        s.jitterP99Ms = Percentile(sorted, 0.99);
+        s.jitterMaxMs = sorted.back();
+
+        sorted = wakeLate;
+        std::sort(sorted.begin(), sorted.end());
+        s.wakeLateP99Ms = Percentile(sorted, 0.99);
+        s.wakeLateMaxMs = sorted.back();
+    }
+    return s;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <vector>
+#include <string>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// Periodic FFB tick scheduling
+// Deadlines are absolute (start + n * period) so they don't drift, and a tick that comes in late
+// moves on to the next deadline still ahead of us instead of running the missed ones back to back -
+// after a stall the wheel gets one update, not a burst of them.
+// Waiting is sleep for most of the gap, then spin the last FFB_SPIN_MS for sub-millisecond accuracy.
+
+#define FFB_SPIN_MS 0.25            // spin this close to a deadline instead of sleeping
+#define FFB_JITTER_WINDOW 1024      // ticks kept for the jitter percentiles
+#define FFB_PREEMPT_GAP_MS 0.1      // a spin that loses the CPU for this long was preempted
+
+struct FFBSchedulerStats {
+    unsigned long long ticks = 0;
+    unsigned long long overruns = 0;        // ticks that started a full period or more late
+    unsigned long long skippedTicks = 0;    // deadlines dropped instead of run back to back
+    double jitterP50Ms = 0.0;               // |tick interval - period| over the last FFB_JITTER_WINDOW ticks
+    double jitterP95Ms = 0.0;
+    double jitterP99Ms = 0.0;
+    double jitterMaxMs = 0.0;
+    double wakeLateP99Ms = 0.0;             // how long after its deadline a tick started, same window
+    double wakeLateMaxMs = 0.0;
+    unsigned long long preemptions = 0;     // spins that lost the CPU for FFB_PREEMPT_GAP_MS or more
+    double longestPreemptionMs = 0.0;
+};
+
+// Include logging
+void LogMessage(const std::wstring& msg);
+
+class FFBTickScheduler {
+public:
+    explicit FFBTickScheduler(double periodMs);
+
+    double PeriodMs() const { return periodMs; }
+    void SetPeriodMs(double periodMs);
+
+    // Line the next deadline up on a time (first tick, or the game's frame timing)
+    void AlignTo(double deadlineMs) { nextDeadlineMs = deadlineMs; }
+
+    // Pick up again after the output has been idle, the gap since the last tick isn't jitter or an overrun
+    void Restart(double deadlineMs) { nextDeadlineMs = deadlineMs; lastTickMs = -1.0; }
+
+    // Move the grid onto anchorMs at a new period (see frame_lock.h). The next deadline becomes the
+    // first point of the new grid at least half a period after the last tick, so it never doubles a tick up
+    void LockTo(double anchorMs, double newPeriodMs);
+
+    bool Due(double nowMs) const { return nowMs >= nextDeadlineMs; }
+    double MsUntilDue(double nowMs) const { return nextDeadlineMs - nowMs; }
+    double NextDeadlineMs() const { return nextDeadlineMs; }
+
+    // Call once per tick that ran, with the time it started
+    void CompleteTick(double tickStartMs);
+
+    // Busy-wait (yielding) until the deadline, only meant for the last FFB_SPIN_MS
+    // Also where preemption shows up: a gap between two clock reads means something else had the CPU
+    void SpinUntilDue();
+
+    // Percentiles are worked out here, so don't call it every tick
+    FFBSchedulerStats Stats() const;
+
+private:
+    double periodMs;
+    double nextDeadlineMs = 0.0;
+    double lastTickMs = -1.0;
+    double lastReportMs = -1.0;
+
+    std::vector<double> jitter;
+    std::vector<double> wakeLate;
+    size_t jitterNext = 0;
+
+    unsigned long long ticks = 0;
+    unsigned long long overruns = 0;
+    unsigned long long skippedTicks = 0;
+    unsigned long long preemptions = 0;
+    double longestPreemptionMs = 0.0;
+};
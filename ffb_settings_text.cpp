@@ -0,0 +1,148 @@
+#include "ffb_settings_text.h"
+#include <filesystem>
+#include <fstream>
+#include "ffb_config.h"
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+//settings from the ffb.ini
+std::wstring targetDeviceName;
+std::wstring targetGameVersion;
+std::wstring targetForceSetting;
+std::wstring targetDeadzoneSetting;
+std::wstring targetInvertFFB;
+std::wstring targetLimitEnabled;
+std::wstring targetConstantEnabled;
+std::wstring targetConstantScale;
+std::wstring targetBrakingScale;
+std::wstring targetVibrationEnabled;
+std::wstring targetVibrationScale;
+std::wstring targetWeightEnabled;
+std::wstring targetWeightScale;
+std::wstring targetDamperEnabled;
+std::wstring targetDamperScale;
+std::wstring targetSpringEnabled;
+std::wstring targetRecordEnabled;
+std::wstring targetRecordFile;
+std::wstring targetUpdateRate;
+std::wstring targetUpsampling;
+std::wstring targetUpsamplingPredict;
+std::wstring targetThreadPriority;
+std::wstring targetRealtimePriority;
+std::wstring targetThreadAffinity;
+std::wstring targetWatchdogTimeout;
+std::wstring targetControlChannel;
+std::wstring targetLogFormat;
+
+// Read the ini file as written, nothing is checked here (see BuildFFBConfig in ffb_config.h)
+bool ReadFFBSettings(const std::wstring& filename, FFBSettingsText& text) {
+    std::wifstream file{ std::filesystem::path(filename) };   // a wide name opens on Linux too
+    if (!file) return false;
+    std::wstring line;
+    while (std::getline(file, line)) {
+        if (line.rfind(L"Device: ", 0) == 0)
+            text.deviceName = line.substr(8);
+
+        if (line.rfind(L"Force: ", 0) == 0)
+            text.forceSetting = line.substr(7);
+        else if (line.rfind(L"Deadzone: ", 0) == 0)
+            text.deadzoneSetting = line.substr(10);
+        else if (line.rfind(L"Invert: ", 0) == 0)
+            text.invertFFB = line.substr(8);
+        else if (line.rfind(L"Limit: ", 0) == 0)
+            text.limitEnabled = line.substr(7);
+        else if (line.rfind(L"Constant: ", 0) == 0)
+            text.constantEnabled = line.substr(10);
+        else if (line.rfind(L"Constant Scale: ", 0) == 0)
+            text.constantScale = line.substr(16);
+        else if (line.rfind(L"Braking Scale: ", 0) == 0)
+            text.brakingScale = line.substr(15);
+        else if (line.rfind(L"Vibration: ", 0) == 0)
+            text.vibrationEnabled = line.substr(11);
+        else if (line.rfind(L"Vibration Scale: ", 0) == 0)
+            text.vibrationScale = line.substr(17);
+        else if (line.rfind(L"Weight: ", 0) == 0)
+            text.weightEnabled = line.substr(8);
+        else if (line.rfind(L"Weight Scale: ", 0) == 0)
+            text.weightScale = line.substr(14);
+        else if (line.rfind(L"Damper: ", 0) == 0)
+            text.damperEnabled = line.substr(8);
+        else if (line.rfind(L"Damper Scale: ", 0) == 0)
+            text.damperScale = line.substr(14);
+        else if (line.rfind(L"Spring: ", 0) == 0)
+            text.springEnabled = line.substr(8);
+        else if (line.rfind(L"Record: ", 0) == 0)
+            text.recordEnabled = line.substr(8);
+        else if (line.rfind(L"Record File: ", 0) == 0)
+            text.recordFile = line.substr(13);
+        else if (line.rfind(L"Update Rate: ", 0) == 0)
+            text.updateRate = line.substr(13);
+        else if (line.rfind(L"Upsampling: ", 0) == 0)
+            text.upsampling = line.substr(12);
+        else if (line.rfind(L"Upsampling Predict: ", 0) == 0)
+            text.upsamplingPredict = line.substr(20);
+        else if (line.rfind(L"Thread Priority: ", 0) == 0)
+            text.threadPriority = line.substr(17);
+        else if (line.rfind(L"Realtime Priority: ", 0) == 0)
+            text.realtimePriority = line.substr(19);
+        else if (line.rfind(L"Thread Affinity: ", 0) == 0)
+            text.threadAffinity = line.substr(17);
+        else if (line.rfind(L"Watchdog Timeout: ", 0) == 0)
+            text.watchdogTimeout = line.substr(18);
+        else if (line.rfind(L"Control Channel: ", 0) == 0)
+            text.controlChannel = line.substr(17);
+        else if (line.rfind(L"Log Format: ", 0) == 0)
+            text.logFormat = line.substr(12);
+    }
+    return true;
+}
+
+// Search the ini file for settings and find what the user has set them to
+bool LoadFFBSettings(const std::wstring& filename) {
+    FFBSettingsText text;
+    if (!ReadFFBSettings(filename, text)) return false;
+
+    targetDeviceName = text.deviceName;
+    targetGameVersion = text.gameVersion;
+    targetForceSetting = text.forceSetting;
+    targetDeadzoneSetting = text.deadzoneSetting;
+    targetInvertFFB = text.invertFFB;
+    targetLimitEnabled = text.limitEnabled;
+    targetConstantEnabled = text.constantEnabled;
+    targetConstantScale = text.constantScale;
+    targetBrakingScale = text.brakingScale;
+    targetVibrationEnabled = text.vibrationEnabled;
+    targetVibrationScale = text.vibrationScale;
+    targetWeightEnabled = text.weightEnabled;
+    targetWeightScale = text.weightScale;
+    targetDamperEnabled = text.damperEnabled;
+    targetDamperScale = text.damperScale;
+    targetSpringEnabled = text.springEnabled;
+    targetRecordEnabled = text.recordEnabled;
+    targetRecordFile = text.recordFile;
+    targetUpdateRate = text.updateRate;
+    targetUpsampling = text.upsampling;
+    targetUpsamplingPredict = text.upsamplingPredict;
+    targetThreadPriority = text.threadPriority;
+    targetRealtimePriority = text.realtimePriority;
+    targetThreadAffinity = text.threadAffinity;
+    targetWatchdogTimeout = text.watchdogTimeout;
+    targetControlChannel = text.controlChannel;
+    targetLogFormat = text.logFormat;
+
+    // The typed copy everything after startup reads
+    PublishFFBConfig(BuildFFBConfig(text, FFBConfig()));
+    return !targetDeviceName.empty();
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <string>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// FFB settings text
+// Reading ffb.ini, apart from the DirectInput setup in ffb_setup.h. Nothing here needs windows.h, so the
+// settings, the ffb.ini watcher and the control channel (ffb_config.h) build on Linux too.
+
+// Settings from ffb.ini, as written. LoadFFBSettings fills them
+extern std::wstring targetDeviceName;
+extern std::wstring targetGameVersion;
+
+extern std::wstring targetForceSetting;
+extern std::wstring targetDeadzoneSetting;
+extern std::wstring targetInvertFFB;
+extern std::wstring targetLimitEnabled;
+extern std::wstring targetConstantEnabled;
+extern std::wstring targetConstantScale;
+extern std::wstring targetBrakingScale;
+extern std::wstring targetVibrationEnabled;
+extern std::wstring targetVibrationScale;
+extern std::wstring targetWeightEnabled;
+extern std::wstring targetWeightScale;
+extern std::wstring targetDamperEnabled;
+extern std::wstring targetDamperScale;
+extern std::wstring targetSpringEnabled;
+extern std::wstring targetRecordEnabled;
+extern std::wstring targetRecordFile;
+extern std::wstring targetUpdateRate;
+extern std::wstring targetUpsampling;
+extern std::wstring targetUpsamplingPredict;
+extern std::wstring targetThreadPriority;
+extern std::wstring targetRealtimePriority;
+extern std::wstring targetThreadAffinity;
+extern std::wstring targetWatchdogTimeout;
+extern std::wstring targetControlChannel;
+extern std::wstring targetLogFormat;
+
+// ffb.ini as written, defaults for the lines that may be missing
+struct FFBSettingsText {
+    std::wstring deviceName;
+    std::wstring gameVersion = L"x86GP2";
+    std::wstring forceSetting;
+    std::wstring deadzoneSetting;
+    std::wstring invertFFB;
+    std::wstring limitEnabled;
+    std::wstring constantEnabled;
+    std::wstring constantScale;
+    std::wstring brakingScale;
+    std::wstring vibrationEnabled;
+    std::wstring vibrationScale;
+    std::wstring weightEnabled = L"false";
+    std::wstring weightScale = L"1.0";
+    std::wstring damperEnabled;
+    std::wstring damperScale;
+    std::wstring springEnabled;
+    std::wstring recordEnabled = L"false";
+    std::wstring recordFile = L"telemetry.gp2rec";
+    std::wstring updateRate = L"60";
+    std::wstring upsampling = L"off";
+    std::wstring upsamplingPredict = L"false";
+    std::wstring threadPriority = L"normal";
+    std::wstring realtimePriority = L"50";
+    std::wstring threadAffinity = L"any";
+    std::wstring watchdogTimeout = L"250";
+    std::wstring controlChannel = L"true";
+    std::wstring logFormat = L"text";
+};
+
+// Include logging
+void LogMessage(const std::wstring& msg);
+
+// Read the ini file as written, nothing is checked here (see BuildFFBConfig in ffb_config.h)
+bool ReadFFBSettings(const std::wstring& filename, FFBSettingsText& text);
+
+// Reads ffb.ini into the target* strings and publishes the checked FFBConfig. False if it can't be read
+// or names no device
+bool LoadFFBSettings(const std::wstring& filename);
@@ -1,5 +1,4 @@
 #include "ffb_setup.h"
-#include <fstream>
 #include <iostream>
 #include "constant_force.h"
 #include "telemetry_reader.h"
@@ -20,24 +19,6 @@
 
 extern IDirectInputEffect* constantForceEffect;
 
-//settings from the ffb.ini
-std::wstring targetDeviceName;
-std::wstring targetGameVersion;
-std::wstring targetForceSetting;
-std::wstring targetDeadzoneSetting;
-std::wstring targetInvertFFB;
-std::wstring targetLimitEnabled;
-std::wstring targetConstantEnabled;
-std::wstring targetConstantScale;
-std::wstring targetBrakingScale;
-std::wstring targetVibrationEnabled;
-std::wstring targetVibrationScale;
-std::wstring targetWeightEnabled;
-std::wstring targetWeightScale;
-std::wstring targetDamperEnabled;
-std::wstring targetDamperScale;
-std::wstring targetSpringEnabled;
-
 //device id from game
 int g_gameDeviceID = -1;
 
@@ -141,54 +122,6 @@ BOOL CALLBACK EnumDevicesCallback(const DIDEVICEINSTANCE* pdidInstance, VOID* pC
     return DIENUM_CONTINUE;
 }
 
-// Search the ini file for settings and find what the user has set them to
-bool LoadFFBSettings(const std::wstring& filename) {
-    
-    targetWeightEnabled = L"false";
-    targetWeightScale = L"1.0";            
-    targetGameVersion = L"x86GP2";
-    
-    std::wifstream file(filename);
-    if (!file) return false;
-    std::wstring line;
-    while (std::getline(file, line)) {
-        if (line.rfind(L"Device: ", 0) == 0)
-            targetDeviceName = line.substr(8);
-
-        if (line.rfind(L"Force: ", 0) == 0)
-            targetForceSetting = line.substr(7);
-        else if (line.rfind(L"Deadzone: ", 0) == 0)
-            targetDeadzoneSetting = line.substr(10);
-        else if (line.rfind(L"Invert: ", 0) == 0)
-            targetInvertFFB = line.substr(8);
-        else if (line.rfind(L"Limit: ", 0) == 0)
-            targetLimitEnabled = line.substr(7);
-        else if (line.rfind(L"Constant: ", 0) == 0)
-            targetConstantEnabled = line.substr(10);
-        else if (line.rfind(L"Constant Scale: ", 0) == 0)
-            targetConstantScale = line.substr(16);
-        else if (line.rfind(L"Braking Scale: ", 0) == 0)
-            targetBrakingScale = line.substr(15);
-        else if (line.rfind(L"Vibration: ", 0) == 0)
-            targetVibrationEnabled = line.substr(11);
-        else if (line.rfind(L"Vibration Scale: ", 0) == 0)
-            targetVibrationScale = line.substr(17);
-        else if (line.rfind(L"Weight: ", 0) == 0)
-            targetWeightEnabled = line.substr(8);
-        else if (line.rfind(L"Weight Scale: ", 0) == 0)
-            targetWeightScale = line.substr(14);
-        else if (line.rfind(L"Damper: ", 0) == 0)
-            targetDamperEnabled = line.substr(8);
-        else if (line.rfind(L"Damper Scale: ", 0) == 0)
-            targetDamperScale = line.substr(14);
-        else if (line.rfind(L"Spring: ", 0) == 0)
-            targetSpringEnabled = line.substr(8);
-
-
-    }
-    return !targetDeviceName.empty();
-}
-
 // Kick-off DirectInput
 bool InitializeDevice() {
     LogMessage(L"[INFO] Initializing DirectInput...");
@@ -7,27 +7,10 @@
 // === Standard Includes ===
 #include <string>
 
-// === Forward Declarations ===
-extern std::wstring targetDeviceName;
-extern std::wstring targetGameVersion;
-
-extern std::wstring targetForceSetting;
-extern std::wstring targetDeadzoneSetting;
-extern std::wstring targetInvertFFB;
-extern std::wstring targetLimitEnabled;
-extern std::wstring targetConstantEnabled;
-extern std::wstring targetConstantScale;
-extern std::wstring targetBrakingScale;
-extern std::wstring targetVibrationEnabled;
-extern std::wstring targetVibrationScale;
-extern std::wstring targetWeightEnabled;
-extern std::wstring targetWeightScale;
-extern std::wstring targetDamperEnabled;
-extern std::wstring targetDamperScale;
-extern std::wstring targetSpringEnabled;
-
-
+// === FFB Includes ===
+#include "ffb_settings_text.h"
 
+// === Forward Declarations ===
 extern IDirectInputDevice8* matchedDevice;
 extern LPDIRECTINPUT8 directInput;
 
@@ -37,7 +20,6 @@ void ListAvailableDevices();
 void ShowAvailableDevicesOnConsole();
 
 // === FFB Setup Functions ===
-bool LoadFFBSettings(const std::wstring& filename);
 bool InitializeDevice();
 
 void UpdateGameDeviceID(int deviceID);
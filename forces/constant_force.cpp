@@ -1,6 +1,8 @@
 ﻿#include "constant_force.h"
+#include "../logger.h"
 #include <iostream>
 #include <algorithm>
+#include <atomic>
 #include <deque>
 #include <numeric>
 
@@ -19,13 +21,38 @@
  */
 
 
-// Get config data
-extern std::wstring targetInvertFFB;
-
 // To be used in reporting
-extern int g_currentFFBForce;
-extern int g_currentFrontLoad;
+extern std::atomic<int> g_currentFFBForce;
+extern std::atomic<int> g_currentFrontLoad;
+
+
+// Set by ResetConstantForceEffect, the smoothing below starts over on its next frame
+static bool smoothingResetPending = false;
 
+void ZeroConstantForceEffect(IDirectInputEffect* constantForceEffect) {
+    if (!constantForceEffect) return;
+
+    DICONSTANTFORCE cf = { 0 };
+    DIEFFECT eff = {};
+    eff.dwSize = sizeof(DIEFFECT);
+    eff.dwFlags = DIEFF_CARTESIAN | DIEFF_OBJECTOFFSETS;
+    eff.dwDuration = INFINITE;
+    eff.dwGain = 10000;
+    eff.dwTriggerButton = DIEB_NOTRIGGER;
+    eff.cAxes = 1;
+    DWORD axes[1] = { DIJOFS_X };
+    LONG dir[1] = { 0 };
+    eff.rgdwAxes = axes;
+    eff.rglDirection = dir;
+    eff.cbTypeSpecificParams = sizeof(DICONSTANTFORCE);
+    eff.lpvTypeSpecificParams = &cf;
+    constantForceEffect->SetParameters(&eff, DIEP_TYPESPECIFICPARAMS | DIEP_DIRECTION);
+    g_currentFFBForce.store(0, std::memory_order_relaxed);
+}
+
+void ResetConstantForceEffect() {
+    smoothingResetPending = true;
+}
 
 void ApplyConstantForceEffect(const RawTelemetry& current,
     const CalculatedVehicleDynamics& vehicleDynamics,
@@ -39,92 +66,13 @@ void ApplyConstantForceEffect(const RawTelemetry& current,
     double constantForceScale,
     double vibrationForceScale,
     double brakingForceScale,
-    double weightForceScale
+    double weightForceScale,
+    double directionScale       // 1, or -1 for Invert
 ) {
 
     if (!constantForceEffect) return;
 
-    // Beta 0.5
-    // This is a bunch of logic to pause/unpause or prevent forces when the game isn't running
-
-    static double lastKph = 0.0;
-    static bool hasEverMoved = false;
-    static int noMovementFrames = 0;
-    static bool isPaused = true;
-    static bool pauseForceSet = false;
-    static bool isFirstReading = true;
-    static bool lastInactiveState = true; // Track previous state
-    constexpr int movementThreshold = 10;
-    constexpr double movementThreshold_value = 0.001;
-
-    if (isFirstReading) {
-        lastKph = current.gp2_speedKmh;
-        isFirstReading = false;
-        if (!pauseForceSet) {
-            DICONSTANTFORCE cf = { 0 };
-            DIEFFECT eff = {};
-            eff.dwSize = sizeof(DIEFFECT);
-            eff.dwFlags = DIEFF_CARTESIAN | DIEFF_OBJECTOFFSETS;
-            eff.dwDuration = INFINITE;
-            eff.dwGain = 10000;
-            eff.dwTriggerButton = DIEB_NOTRIGGER;
-            eff.cAxes = 1;
-            DWORD axes[1] = { DIJOFS_X };
-            LONG dir[1] = { 0 };
-            eff.rgdwAxes = axes;
-            eff.rglDirection = dir;
-            eff.cbTypeSpecificParams = sizeof(DICONSTANTFORCE);
-            eff.lpvTypeSpecificParams = &cf;
-            constantForceEffect->SetParameters(&eff, DIEP_TYPESPECIFICPARAMS | DIEP_DIRECTION);
-            pauseForceSet = true;
-        }
-        return;
-    }
-
-    bool isInactive = (!current.gp2_isInRace || current.gp2_isPaused || current.gp2_isReplay || current.gp2_isX86MenuOn);
-
-    if (isInactive) {
-        if (!lastInactiveState) { // Only log when transitioning to inactive
-            LogMessage(L"[INFO] Game paused detected - sending zero force");
-        }
-        isPaused = true;
-        pauseForceSet = false;
-        lastInactiveState = true;
-    }
-    else {
-        if (lastInactiveState) { // Only log when transitioning to active
-            LogMessage(L"[INFO] Game resumed - restoring normal forces");
-        }
-        isPaused = false;
-        pauseForceSet = false;
-        lastInactiveState = false;
-        lastKph = current.gp2_speedKmh;
-    }
-
-
-    // If paused, send zero force and return
-    if (isPaused) {
-        if (!pauseForceSet) {
-            DICONSTANTFORCE cf = { 0 };
-            DIEFFECT eff = {};
-            eff.dwSize = sizeof(DIEFFECT);
-            eff.dwFlags = DIEFF_CARTESIAN | DIEFF_OBJECTOFFSETS;
-            eff.dwDuration = INFINITE;
-            eff.dwGain = 10000;
-            eff.dwTriggerButton = DIEB_NOTRIGGER;
-            eff.cAxes = 1;
-            DWORD axes[1] = { DIJOFS_X };
-            LONG dir[1] = { 0 };
-            eff.rgdwAxes = axes;
-            eff.rglDirection = dir;
-            eff.cbTypeSpecificParams = sizeof(DICONSTANTFORCE);
-            eff.lpvTypeSpecificParams = &cf;
-            constantForceEffect->SetParameters(&eff, DIEP_TYPESPECIFICPARAMS | DIEP_DIRECTION);
-            pauseForceSet = true;
-        }
-        return;
-    }
-
+    // Pausing, menus and replays are handled by the game state machine (game_state.h), this only runs while racing
 
     // Low speed filtering
     /*
@@ -229,13 +177,13 @@ void ApplyConstantForceEffect(const RawTelemetry& current,
     double rightForce = vehicleDynamics.frontRightForce_N;
 
     // Reduce force for the wheel with less grip when off asphalt
-    if (current.gp2_surfaceType_rf != 0) {
+    if (current.gp2_surfaceType[CORNER_RF] != 0) {
         if (rightForce >= 0) {
             rightForce = leftForce * 0.15;  // Reduce the force on the wheel with less grip        
         }
     }
 
-    if (current.gp2_surfaceType_lf != 0) {
+    if (current.gp2_surfaceType[CORNER_LF] != 0) {
         if (leftForce <= 0) {
             leftForce = rightForce * 0.15;  // Reduce the force on the wheel with less grip
 
@@ -260,8 +208,8 @@ void ApplyConstantForceEffect(const RawTelemetry& current,
             // Only smooth if outside tire still has significant force
             if (std::abs(rightForce) > 200.0) {
                 smoothedLeftForce = lastLeftForce * 0.8;  // Gradual decay instead of sudden drop
-                LogMessage(L"[DEBUG] Right turn: Smoothing sudden left tire drop from " +
-                    std::to_wstring(lastLeftForce) + L" to " + std::to_wstring(smoothedLeftForce));
+                LOG_DEBUG_EVERY(1000, L"[DEBUG] Right turn: Smoothing sudden left tire drop from %f to %f",
+                    lastLeftForce, smoothedLeftForce);
             }
         }
     }
@@ -272,8 +220,8 @@ void ApplyConstantForceEffect(const RawTelemetry& current,
             // Only smooth if outside tire still has significant force
             if (std::abs(leftForce) > 200.0) {
                 smoothedRightForce = lastRightForce * 0.8;  // Gradual decay instead of sudden drop
-                LogMessage(L"[DEBUG] Left turn: Smoothing sudden right tire drop from " +
-                    std::to_wstring(lastRightForce) + L" to " + std::to_wstring(smoothedRightForce));
+                LOG_DEBUG_EVERY(1000, L"[DEBUG] Left turn: Smoothing sudden right tire drop from %f to %f",
+                    lastRightForce, smoothedRightForce);
             }
         }
     }
@@ -313,6 +261,12 @@ void ApplyConstantForceEffect(const RawTelemetry& current,
      static bool inputInitialized = false;
      const double INPUT_SMOOTHING = 0.4;  // Adjust 0.1-0.4 based on preference
 
+     if (smoothingResetPending) {
+         inputInitialized = false;
+         lastLeftForce = 0.0;
+         lastRightForce = 0.0;
+     }
+
      if (!inputInitialized) {
          smoothedFrontTireLoadSum = frontTireLoadSum;
          inputInitialized = true;
@@ -338,7 +292,7 @@ void ApplyConstantForceEffect(const RawTelemetry& current,
     // Keep frontTireLoad for logging compatibility
     double frontTireLoad = frontTireLoadMagnitude;
 
-    g_currentFrontLoad = frontTireLoad;
+    g_currentFrontLoad.store(static_cast<int>(frontTireLoad), std::memory_order_relaxed);
 
 
 /*
@@ -513,10 +467,8 @@ void ApplyConstantForceEffect(const RawTelemetry& current,
     }
 
     // Handle invert option (no more complex direction logic needed!)
-    bool invert = (targetInvertFFB == L"true" || targetInvertFFB == L"True");
-    if (invert) {
-        force = -force;
-    }
+    // -1 when inverted, in between while a changed Invert is ramped in
+    force *= directionScale;
 
     // Convert to signed magnitude
 
@@ -539,6 +491,10 @@ void ApplyConstantForceEffect(const RawTelemetry& current,
     // Take final magnitude and prevent any massive jumps over a small frame range
 
     static std::deque<int> magnitudeHistory;
+    if (smoothingResetPending) {
+        magnitudeHistory.clear();
+        smoothingResetPending = false;
+    }
     magnitudeHistory.push_back(signedMagnitude);
     if (magnitudeHistory.size() > 2) {
         magnitudeHistory.pop_front();
@@ -730,18 +686,12 @@ void ApplyConstantForceEffect(const RawTelemetry& current,
         lastProcessedMagnitude = magnitude;
     }
 
-    g_currentFFBForce = signedMagnitude;
+    g_currentFFBForce.store(signedMagnitude, std::memory_order_relaxed);
 
     //Logging
-    static int debugCounter = 0;
-    if (debugCounter % 30 == 0) {  // Every 30 frames
-        LogMessage(L"[DEBUG] FL: " + std::to_wstring(vehicleDynamics.frontLeftForce_N) +
-            L", FR: " + std::to_wstring(vehicleDynamics.frontRightForce_N) +
-            L", Total: " + std::to_wstring(frontTireLoad) +
-            L", atan_input: " + std::to_wstring(frontTireLoad * 1.0e-4) +
-            L", atan_result: " + std::to_wstring(atan(frontTireLoad * 1.0e-4)));
-    }
-    debugCounter++;
+    LOG_DEBUG_EVERY(500, L"[DEBUG] FL: %f, FR: %f, Total: %f, atan_input: %f, atan_result: %f",  // Every 30 frames at 60Hz
+        vehicleDynamics.frontLeftForce_N, vehicleDynamics.frontRightForce_N, frontTireLoad,
+        frontTireLoad * 1.0e-4, atan(frontTireLoad * 1.0e-4));
 
 
     DICONSTANTFORCE cf = { signedMagnitude };  // Use signed magnitude
@@ -765,4 +715,25 @@ void ApplyConstantForceEffect(const RawTelemetry& current,
     if (FAILED(hr)) {
         std::wcerr << L"Constant force SetParameters failed: 0x" << std::hex << hr << std::endl;
     }
+}
+
+HRESULT SendConstantForceMagnitude(IDirectInputEffect* effect, LONG magnitude) {
+    if (!effect) return E_POINTER;
+
+    DICONSTANTFORCE cf = { magnitude };
+    DIEFFECT eff = {};
+    eff.dwSize = sizeof(DIEFFECT);
+    eff.dwFlags = DIEFF_CARTESIAN | DIEFF_OBJECTOFFSETS;
+    eff.dwDuration = INFINITE;
+    eff.dwGain = 10000;
+    eff.dwTriggerButton = DIEB_NOTRIGGER;
+    eff.cAxes = 1;
+    DWORD axes[1] = { DIJOFS_X };
+    LONG dir[1] = { 0 };
+    eff.rgdwAxes = axes;
+    eff.rglDirection = dir;
+    eff.cbTypeSpecificParams = sizeof(DICONSTANTFORCE);
+    eff.lpvTypeSpecificParams = &cf;
+
+    return effect->SetParameters(&eff, DIEP_TYPESPECIFICPARAMS);
 }
\ No newline at end of file
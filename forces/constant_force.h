@@ -9,6 +9,12 @@
 // Include logging
 void LogMessage(const std::wstring& msg);
 
+// Telemetry this reads, on top of what it gets through the vehicle dynamics
+#define CONSTANT_FORCE_FIELDS (VEHICLE_DYNAMICS_FIELDS | TELEM_STATE | TELEM_SPEED | TELEM_STEERING | TELEM_SURFACE)
+
+// How often it goes to the wheel (effect_update.h) - it is the force you feel, so all of it
+#define CONSTANT_FORCE_UPDATE_POLICY EffectUpdatePolicy::EveryFrame()
+
 extern IDirectInputEffect* constantForceEffect;
 
 void ApplyConstantForceEffect(const RawTelemetry& current,
@@ -23,5 +29,15 @@ void ApplyConstantForceEffect(const RawTelemetry& current,
     double constantForceScale,
     double vibrationForceScale,
     double brakingForceScale,
-    double weightForceScale
-);
\ No newline at end of file
+    double weightForceScale,
+    double directionScale       // 1, or -1 for Invert
+);
+
+// Zero magnitude, the effect keeps running. Used when the game leaves a race
+void ZeroConstantForceEffect(IDirectInputEffect* constantForceEffect);
+
+// Forget the smoothing history, so a new race doesn't start from where the last one ended
+void ResetConstantForceEffect();
+
+// Sends a constant force magnitude the same way ApplyConstantForceEffect does (upsampled ticks, ffb_output.h)
+HRESULT SendConstantForceMagnitude(IDirectInputEffect* effect, LONG magnitude);
@@ -5,6 +5,13 @@
 // Include logging
 void LogMessage(const std::wstring& msg);
 
+// Telemetry this reads
+#define DAMPER_FIELDS (TELEM_SPEED)
+
+// How often it goes to the wheel (effect_update.h) - strength only follows speed, so when it has
+// moved by 100 (of 5000), and once a second anyway
+#define DAMPER_UPDATE_POLICY EffectUpdatePolicy::OnChange(100, 1000.0)
+
 extern IDirectInputEffect* damperEffect;
 
 void UpdateDamperEffect(double gp2_speedKmh, IDirectInputEffect* effect, double masterForceScale, double damperForceScale);
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "force_upsampler.h"
+#include <algorithm>
+#include <cmath>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+UpsampleMode ParseUpsampleMode(const std::wstring& value) {
+    if (value == L"linear" || value == L"Linear") return UpsampleMode::Linear;
+    if (value == L"hermite" || value == L"Hermite") return UpsampleMode::Hermite;
+    return UpsampleMode::Off;
+}
+
+const wchar_t* UpsampleModeName(UpsampleMode mode) {
+    switch (mode) {
+    case UpsampleMode::Linear: return L"linear";
+    case UpsampleMode::Hermite: return L"hermite";
+    default: return L"off";
+    }
+}
+
+void ForceUpsampler::SetFramePeriodMs(double periodMs) {
+    // Ignore nonsense from menus/loading, the curve is only ever a frame or so long
+    if (periodMs >= 5.0 && periodMs <= 100.0) framePeriodMs = periodMs;
+}
+
+void ForceUpsampler::AddSample(double timeMs, long magnitude) {
+    history[next] = { timeMs, static_cast<double>(magnitude) };
+    next = (next + 1) % UPSAMPLER_HISTORY;
+    if (count < UPSAMPLER_HISTORY) count++;
+}
+
+// Slope (force per ms) through sample i, from its neighbours where it has them (Catmull-Rom)
+double ForceUpsampler::Tangent(int i) const {
+    int newer = i > 0 ? i - 1 : i;
+    int older = i + 1 < count ? i + 1 : i;
+    double dt = Newest(newer).timeMs - Newest(older).timeMs;
+    if (newer == older || dt <= 0.0) return 0.0;
+
+    // Across a gap (pause, rate limited) the slope means nothing
+    double intervals = (newer == i || older == i) ? 1.0 : 2.0;
+    if (dt > 2.0 * framePeriodMs * intervals) return 0.0;
+    return (Newest(newer).value - Newest(older).value) / dt;
+}
+
+// p0 -> p1 over u = 0..1, tangents already scaled to the segment length
+double ForceUpsampler::Curve(double p0, double p1, double m0, double m1, double u) const {
+    if (mode == UpsampleMode::Linear) return p0 + (p1 - p0) * u;
+
+    double u2 = u * u;
+    double u3 = u2 * u;
+    return (2.0 * u3 - 3.0 * u2 + 1.0) * p0 + (u3 - 2.0 * u2 + u) * m0 +
+        (-2.0 * u3 + 3.0 * u2) * p1 + (u3 - u2) * m1;
+}
+
+bool ForceUpsampler::Evaluate(double timeMs, long& magnitude) const {
+    if (count == 0) return false;
+
+    double value = Newest(0).value;
+
+    if (mode != UpsampleMode::Off && count > 1) {
+        if (predict) {
+            // Head on from the newest sample along its slope, ease into a hold one frame later
+            double slope = Tangent(0) * UPSAMPLER_PREDICT_DAMPING;
+            double u = std::clamp((timeMs - Newest(0).timeMs) / framePeriodMs, 0.0, 1.0);
+            double target = Newest(0).value + slope * framePeriodMs;
+            value = Curve(Newest(0).value, target, slope * framePeriodMs, 0.0, u);
+        }
+        else {
+            // Draw one frame behind, between the two samples either side of that time
+            double t = timeMs - framePeriodMs;
+            if (t < Newest(0).timeMs) {
+                value = Newest(count - 1).value;
+                for (int i = 0; i + 1 < count; i++) {
+                    const Sample& newer = Newest(i);
+                    const Sample& older = Newest(i + 1);
+                    if (t < older.timeMs) continue;
+
+                    // After a gap, hold the old value and only ramp over the last frame before the new one
+                    double start = std::max(older.timeMs, newer.timeMs - framePeriodMs);
+                    if (t < start) {
+                        value = older.value;
+                    }
+                    else {
+                        double dt = newer.timeMs - start;
+                        double u = dt > 0.0 ? (t - start) / dt : 1.0;
+                        value = Curve(older.value, newer.value, Tangent(i + 1) * dt, Tangent(i) * dt, u);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    magnitude = std::lround(std::clamp(value, -static_cast<double>(UPSAMPLER_MAX_MAGNITUDE), static_cast<double>(UPSAMPLER_MAX_MAGNITUDE)));
+    return true;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <string>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// Constant force upsampling
+// The game only publishes ~60 frames a second, but direct drive bases take 500-1000 updates a second.
+// The force code still runs once per game frame; its result becomes a sample here, and every output
+// tick sends a value on a curve through the samples instead of holding each one for a whole frame.
+//
+// Two ways to place the curve:
+//   interpolate - runs one game frame behind and draws between real samples. Smooth, never overshoots,
+//                 but the wheel is a frame (~17ms) later than with no upsampling
+//   predict     - carries on past the newest sample along its slope, for at most a frame. No added delay,
+//                 but it overshoots when the force turns around and snaps back when the next frame lands
+
+#define UPSAMPLER_HISTORY 4                 // samples kept, enough for Catmull-Rom tangents on both ends
+#define UPSAMPLER_DEFAULT_FRAME_MS 16.67    // until the game tells us its frame rate
+#define UPSAMPLER_PREDICT_DAMPING 0.5       // fraction of the last slope the prediction follows
+#define UPSAMPLER_MAX_MAGNITUDE 10000       // DI_FFNOMINALMAX, without pulling in dinput.h
+
+enum class UpsampleMode {
+    Off,        // 60Hz steps, same as before
+    Linear,
+    Hermite     // cubic Hermite with Catmull-Rom tangents, no corners at the samples
+};
+
+// "off" / "linear" / "hermite" from ffb.ini, anything else is Off
+UpsampleMode ParseUpsampleMode(const std::wstring& value);
+const wchar_t* UpsampleModeName(UpsampleMode mode);
+
+class ForceUpsampler {
+public:
+    ForceUpsampler(UpsampleMode mode = UpsampleMode::Off, bool predict = false) : mode(mode), predict(predict) {}
+
+    UpsampleMode Mode() const { return mode; }
+    bool Predicting() const { return predict; }
+
+    // Game frame spacing, from gp2_fps
+    void SetFramePeriodMs(double periodMs);
+
+    // A new force from the force code, at the time its frame turned up
+    void AddSample(double timeMs, long magnitude);
+
+    // Force to send at timeMs. False until there is a sample
+    bool Evaluate(double timeMs, long& magnitude) const;
+
+    // Drop the history (reattach, effects restarted) so we don't draw across the gap
+    void Reset() { count = 0; }
+
+private:
+    struct Sample {
+        double timeMs;
+        double value;
+    };
+
+    // i = 0 is the newest
+    const Sample& Newest(int i) const { return history[(next + UPSAMPLER_HISTORY - 1 - i) % UPSAMPLER_HISTORY]; }
+    double Tangent(int i) const;
+    double Curve(double p0, double p1, double m0, double m1, double u) const;
+
+    UpsampleMode mode;
+    bool predict;
+    double framePeriodMs = UPSAMPLER_DEFAULT_FRAME_MS;
+
+    Sample history[UPSAMPLER_HISTORY] = {};
+    int next = 0;
+    int count = 0;
+};
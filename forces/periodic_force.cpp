@@ -1,4 +1,5 @@
 #include "periodic_force.h"
+#include "../logger.h"
 #include <iostream>
 
 /*
@@ -15,8 +16,9 @@
  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
  */
 
- // External logging function
-extern void LogMessage(const std::wstring& msg);
+// Whether the vibration is running, kept out here so StopPeriodicVibrationEffect can reset it
+static bool wasOnKerb = false;
+static bool effectStarted = false;
 
 void ApplyPeriodicVibrationEffect(const RawTelemetry& current,
     IDirectInputEffect* periodicVibrationEffect,
@@ -24,39 +26,30 @@ void ApplyPeriodicVibrationEffect(const RawTelemetry& current,
     double masterForceScale,
     double vibrationForceScale) {
 
-    // Debug logging every 60 frames
-    static int debugCounter = 0;
-    debugCounter++;
-
-    if (debugCounter % 300 == 0) {  // Every 5 seconds instead of every 1 second
-        LogMessage(L"[VIBRATION DEBUG] Speed: " + std::to_wstring(current.gp2_speedKmh) +
-            L", Surface LF: " + std::to_wstring(current.gp2_surfaceType_lf) +
-            L", Surface RF: " + std::to_wstring(current.gp2_surfaceType_rf) +
-            L", Enable: " + std::to_wstring(enableVibrationForce) +
-            L", VibScale: " + std::to_wstring(vibrationForceScale) +
-            L", Effect ptr: " + std::to_wstring(periodicVibrationEffect != nullptr));
-    }
+    // Debug logging every 5 seconds
+    LOG_DEBUG_EVERY(5000, L"[VIBRATION DEBUG] Speed: %f, Surface LF: %d, Surface RF: %d, Enable: %d, VibScale: %f, Effect ptr: %d",
+        static_cast<double>(current.gp2_speedKmh), static_cast<int>(current.gp2_surfaceType[CORNER_LF]),
+        static_cast<int>(current.gp2_surfaceType[CORNER_RF]), enableVibrationForce ? 1 : 0, vibrationForceScale,
+        periodicVibrationEffect != nullptr ? 1 : 0);
 
     if (!periodicVibrationEffect || !enableVibrationForce) {
-        if (debugCounter % 600 == 0) {  // Every 10 seconds instead of every 2 seconds
-            LogMessage(L"[VIBRATION DEBUG] Effect disabled - ptr: " + std::to_wstring(periodicVibrationEffect != nullptr) +
-                L", enabled: " + std::to_wstring(enableVibrationForce));
-        }
+        LOG_DEBUG_EVERY(10000, L"[VIBRATION DEBUG] Effect disabled - ptr: %d, enabled: %d",
+            periodicVibrationEffect != nullptr ? 1 : 0, enableVibrationForce ? 1 : 0);
         return;
     }
 
-    // Check if any tire is on kerb (surface types 1 or 2)
-    bool onKerb = (current.gp2_surfaceType_lf == 1 || current.gp2_surfaceType_lf == 2 ||
-        current.gp2_surfaceType_rf == 1 || current.gp2_surfaceType_rf == 2 ||
-        current.gp2_surfaceType_lr == 1 || current.gp2_surfaceType_lr == 2 ||
-        current.gp2_surfaceType_rr == 1 || current.gp2_surfaceType_rr == 2);
-
-    static bool wasOnKerb = false;
-    static bool effectStarted = false;
+    // Check if any tire is on kerb (surface types 1 or 2), the count is used for intensity scaling
+    int tiresOnKerb = 0;
+    for (int corner = 0; corner < 4; corner++) {
+        if (current.gp2_surfaceType[corner] == 1 || current.gp2_surfaceType[corner] == 2) tiresOnKerb++;
+    }
+    bool onKerb = tiresOnKerb > 0;
 
-    if (onKerb && current.gp2_speedKmh > 5.0) {
+    // A scale of 0 (Vibration Scale, or turned off from the control channel) stops it rather than
+    // leaving it running at no strength
+    if (onKerb && current.gp2_speedKmh > 5.0 && vibrationForceScale > 0.0) {
         if (!wasOnKerb) {
-            LogMessage(L"[VIBRATION DEBUG] KERB DETECTED! Speed: " + std::to_wstring(current.gp2_speedKmh));
+            LOG_DEBUG(L"[VIBRATION DEBUG] KERB DETECTED! Speed: %f", static_cast<double>(current.gp2_speedKmh));
         }
 
         // Speed scaling - stronger at all speeds but scales with speed
@@ -71,13 +64,6 @@ void ApplyPeriodicVibrationEffect(const RawTelemetry& current,
             speedFactor = 1.0;  // Full strength above 200kph
         }
 
-        // Count tires on kerb for intensity scaling
-        int tiresOnKerb = 0;
-        if (current.gp2_surfaceType_lf == 1 || current.gp2_surfaceType_lf == 2) tiresOnKerb++;
-        if (current.gp2_surfaceType_rf == 1 || current.gp2_surfaceType_rf == 2) tiresOnKerb++;
-        if (current.gp2_surfaceType_lr == 1 || current.gp2_surfaceType_lr == 2) tiresOnKerb++;
-        if (current.gp2_surfaceType_rr == 1 || current.gp2_surfaceType_rr == 2) tiresOnKerb++;
-
         double tireIntensity = 0.7 + (tiresOnKerb * 0.075);
         if (tireIntensity > 1.0) tireIntensity = 1.0;
 
@@ -94,13 +80,8 @@ void ApplyPeriodicVibrationEffect(const RawTelemetry& current,
         }
 
         // Only log detailed calculations every 5 seconds while on kerb
-        if (debugCounter % 300 == 0) {
-            LogMessage(L"[VIBRATION DEBUG] SpeedFactor: " + std::to_wstring(speedFactor) +
-                L", TireIntensity: " + std::to_wstring(tireIntensity) +
-                L", FinalIntensity: " + std::to_wstring(finalIntensity) +
-                L", CalcMag: " + std::to_wstring(calculatedMagnitude) +
-                L", FinalMag: " + std::to_wstring(finalMagnitude));
-        }
+        LOG_DEBUG_EVERY(5000, L"[VIBRATION DEBUG] SpeedFactor: %f, TireIntensity: %f, FinalIntensity: %f, CalcMag: %d, FinalMag: %d",
+            speedFactor, tireIntensity, finalIntensity, calculatedMagnitude, finalMagnitude);
 
         // Set up the periodic effect parameters
         DIPERIODIC periodicForce = {};
@@ -123,11 +104,11 @@ void ApplyPeriodicVibrationEffect(const RawTelemetry& current,
         eff.cbTypeSpecificParams = sizeof(DIPERIODIC);
         eff.lpvTypeSpecificParams = &periodicForce;
 
-        // Update effect parameters
+        // Every frame, the update gate only lets it through once the strength has moved far enough
         HRESULT hr = periodicVibrationEffect->SetParameters(&eff, DIEP_TYPESPECIFICPARAMS | DIEP_DURATION | DIEP_GAIN);
 
         if (FAILED(hr)) {
-            LogMessage(L"[VIBRATION ERROR] SetParameters failed: 0x" + std::to_wstring(hr));
+            LOG_ERROR_EVERY(1000, L"[VIBRATION ERROR] SetParameters failed: 0x%08lX", static_cast<unsigned long>(hr));
         }
 
         // Start effect if not already started
@@ -135,10 +116,10 @@ void ApplyPeriodicVibrationEffect(const RawTelemetry& current,
             hr = periodicVibrationEffect->Start(1, 0);
             if (SUCCEEDED(hr)) {
                 effectStarted = true;
-                LogMessage(L"[VIBRATION] Started periodic effect, magnitude: " + std::to_wstring(finalMagnitude));
+                LOG_INFO(L"[VIBRATION] Started periodic effect, magnitude: %d", finalMagnitude);
             }
             else {
-                LogMessage(L"[VIBRATION ERROR] Start failed: 0x" + std::to_wstring(hr));
+                LOG_ERROR_EVERY(1000, L"[VIBRATION ERROR] Start failed: 0x%08lX", static_cast<unsigned long>(hr));
             }
         }
 
@@ -146,14 +127,14 @@ void ApplyPeriodicVibrationEffect(const RawTelemetry& current,
 
     }
     else {
-        // Stop vibration when off kerb
+        // Stop vibration when off kerb (or scaled down to nothing)
         if (wasOnKerb && effectStarted) {
             HRESULT hr = periodicVibrationEffect->Stop();
             if (SUCCEEDED(hr)) {
-                LogMessage(L"[VIBRATION] Stopped periodic effect");
+                LOG_INFO(L"[VIBRATION] Stopped periodic effect");
             }
             else {
-                LogMessage(L"[VIBRATION ERROR] Stop failed: 0x" + std::to_wstring(hr));
+                LOG_ERROR_EVERY(1000, L"[VIBRATION ERROR] Stop failed: 0x%08lX", static_cast<unsigned long>(hr));
             }
             effectStarted = false;
             wasOnKerb = false;
@@ -161,6 +142,17 @@ void ApplyPeriodicVibrationEffect(const RawTelemetry& current,
     }
 }
 
+void StopPeriodicVibrationEffect(IDirectInputEffect* periodicVibrationEffect) {
+    if (periodicVibrationEffect && effectStarted) {
+        HRESULT hr = periodicVibrationEffect->Stop();
+        if (FAILED(hr)) {
+            LogPrintf(L"[VIBRATION ERROR] Stop failed: 0x%08lX", static_cast<unsigned long>(hr));
+        }
+    }
+    effectStarted = false;
+    wasOnKerb = false;
+}
+
 HRESULT CreatePeriodicVibrationEffect(IDirectInputDevice8* device, IDirectInputEffect** periodicVibrationEffect) {
     if (!device || !periodicVibrationEffect) return E_INVALIDARG;
 
@@ -186,7 +178,7 @@ HRESULT CreatePeriodicVibrationEffect(IDirectInputDevice8* device, IDirectInputE
 
     HRESULT hr = device->CreateEffect(GUID_Sine, &eff, periodicVibrationEffect, nullptr);
     if (FAILED(hr)) {
-        LogMessage(L"[ERROR] Failed to create periodic vibration effect. HRESULT: 0x" + std::to_wstring(hr));
+        LogPrintf(L"[ERROR] Failed to create periodic vibration effect. HRESULT: 0x%08lX", static_cast<unsigned long>(hr));
         *periodicVibrationEffect = nullptr;
     }
     else {
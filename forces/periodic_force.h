@@ -3,6 +3,14 @@
 #include <dinput.h>
 #include "../telemetry_reader.h"
 
+// Telemetry this reads
+#define VIBRATION_FIELDS (TELEM_SPEED | TELEM_SURFACE)
+
+// How often it goes to the wheel (effect_update.h) - the strength follows speed and how many tyres are on
+// the kerb, so when it has moved by 200 (of 4000), and once a second anyway so a slow drift still arrives.
+// Started on a kerb, stopped off it or once its scale is 0
+#define VIBRATION_UPDATE_POLICY EffectUpdatePolicy::OnChange(200, 1000.0)
+
 
 void ApplyPeriodicVibrationEffect(const RawTelemetry& current,
     IDirectInputEffect* periodicVibrationEffect,
@@ -10,6 +18,9 @@ void ApplyPeriodicVibrationEffect(const RawTelemetry& current,
     double masterForceScale,
     double vibrationForceScale);
 
+// Stop it if it is running and forget the kerb state, for when the game leaves a race
+void StopPeriodicVibrationEffect(IDirectInputEffect* periodicVibrationEffect);
+
 // Function to create the periodic vibration effect
 HRESULT CreatePeriodicVibrationEffect(IDirectInputDevice8* device, IDirectInputEffect** periodicVibrationEffect);
 
@@ -5,6 +5,12 @@
 // Include logging
 void LogMessage(const std::wstring& msg);
 
+// Doesn't read any telemetry, it's a fixed centering spring
+#define SPRING_FIELDS 0
+
+// How often it goes to the wheel (effect_update.h) - only changes with the master force, resent once a second
+#define SPRING_UPDATE_POLICY EffectUpdatePolicy::OnChange(0, 1000.0)
+
 extern IDirectInputEffect* springEffect;
 
 void UpdateSpringEffect(IDirectInputEffect* effect, double masterForceScale);
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "frame_lock.h"
+#include "logger.h"
+#include <algorithm>
+#include <cmath>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+#define FRAME_LOCK_DEFAULT_PERIOD_MS 16.67  // until the game fills in its fps
+#define FRAME_LOCK_PERIOD_RANGE 0.1         // estimate stays within 10% of the fps field's period
+
+void FramePhaseLock::Seed(double timeMs, double fps) {
+    nominalPeriodMs = fps > 1.0 ? 1000.0 / fps : FRAME_LOCK_DEFAULT_PERIOD_MS;
+    periodMs = nominalPeriodMs;
+    nextFrameMs = timeMs + periodMs;
+    lockErrorMs = periodMs * 0.5; // has to earn the lock
+    seeded = true;
+}
+
+void FramePhaseLock::Reset() {
+    if (locked) {
+        LOG_INFO(L"[INFO] Frame lock released");
+    }
+    seeded = false;
+    locked = false;
+}
+
+void FramePhaseLock::FrameArrived(double timeMs, double fps) {
+    frames++;
+
+    if (!seeded) {
+        Seed(timeMs, fps);
+        return;
+    }
+
+    // The game changed its frame rate under us, start from its new figure
+    if (fps > 1.0 && std::fabs(1000.0 / fps - nominalPeriodMs) > nominalPeriodMs * FRAME_LOCK_PERIOD_RANGE) {
+        relocks++;
+        Reset();
+        Seed(timeMs, fps);
+        return;
+    }
+
+    // Whole frames we didn't see (or a stall) aren't phase error, step the prediction over them
+    double error = timeMs - nextFrameMs;
+    double wholeFrames = std::round(error / periodMs);
+    if (std::fabs(wholeFrames) > FRAME_LOCK_RELOCK_FRAMES) {
+        relocks++;
+        Reset();
+        Seed(timeMs, fps);
+        return;
+    }
+    nextFrameMs += wholeFrames * periodMs;
+    error -= wholeFrames * periodMs;
+
+    periodMs = std::clamp(periodMs + FRAME_LOCK_PERIOD_GAIN * error,
+        nominalPeriodMs * (1.0 - FRAME_LOCK_PERIOD_RANGE), nominalPeriodMs * (1.0 + FRAME_LOCK_PERIOD_RANGE));
+    nextFrameMs += FRAME_LOCK_PHASE_GAIN * error + periodMs;
+    lockErrorMs += FRAME_LOCK_ERROR_SMOOTHING * (std::fabs(error) - lockErrorMs);
+
+    // Some hysteresis so a noisy frame doesn't flip it back and forth
+    if (!locked && lockErrorMs < FRAME_LOCK_LOCKED_MS) {
+        locked = true;
+        LOG_INFO(L"[INFO] Locked to game frames at %f fps (error %f ms)", 1000.0 / periodMs, lockErrorMs);
+    }
+    else if (locked && lockErrorMs > 2.0 * FRAME_LOCK_LOCKED_MS) {
+        locked = false;
+        LOG_WARNING(L"[WARNING] Lost lock on game frames (error %f ms)", lockErrorMs);
+    }
+}
+
+double FramePhaseLock::NextTickMs() const {
+    return nextFrameMs + FRAME_LOCK_TICK_OFFSET_MS + std::min(2.0 * lockErrorMs, periodMs * 0.25);
+}
+
+FrameLockStats FramePhaseLock::Stats() const {
+    FrameLockStats s;
+    s.locked = locked;
+    s.periodMs = periodMs;
+    s.lockErrorMs = lockErrorMs;
+    s.frames = frames;
+    s.relocks = relocks;
+    return s;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <string>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// Game frame phase lock
+// A free running 16.67ms FFB timer beats against the game's own frame clock: some ticks see the same
+// frame twice, others miss one. This is a small software PLL on frame arrivals - it tracks the game's
+// frame period (seeded from the fps field) and when the next frame is due, so the FFB ticks can be
+// steered to land just after each frame instead of wherever the two clocks happen to drift to.
+//
+// Each arrival is compared with the prediction; the error nudges the phase (FRAME_LOCK_PHASE_GAIN) and,
+// more slowly, the period (FRAME_LOCK_PERIOD_GAIN). A proportional + integral loop, so it settles on the
+// game's real rate with no steady phase error.
+
+#define FRAME_LOCK_PHASE_GAIN 0.15      // share of each arrival's error taken out of the phase
+#define FRAME_LOCK_PERIOD_GAIN 0.01     // share of it folded into the period estimate
+#define FRAME_LOCK_ERROR_SMOOTHING 0.05 // EMA weight of the lock error
+#define FRAME_LOCK_LOCKED_MS 1.0        // lock error under this counts as locked
+#define FRAME_LOCK_RELOCK_FRAMES 30     // an arrival this many frames off the prediction starts over
+#define FRAME_LOCK_TICK_OFFSET_MS 1.0   // tick this long after the predicted frame, plus the lock error
+
+struct FrameLockStats {
+    bool locked = false;
+    double periodMs = 0.0;          // estimated game frame period
+    double lockErrorMs = 0.0;       // smoothed |arrival - prediction|
+    unsigned long long frames = 0;
+    unsigned long long relocks = 0;
+};
+
+// Include logging
+void LogMessage(const std::wstring& msg);
+
+class FramePhaseLock {
+public:
+    // A new frame turned up at timeMs. fps is the game's own figure (0 if it doesn't have one yet)
+    void FrameArrived(double timeMs, double fps);
+
+    // Start over (reattached, paused)
+    void Reset();
+
+    bool Locked() const { return locked; }
+    double PeriodMs() const { return periodMs; }
+    double NextFrameMs() const { return nextFrameMs; }
+    double LockErrorMs() const { return lockErrorMs; }
+
+    // Where a tick should go to catch the next frame: just after it, with room for the arrival jitter
+    double NextTickMs() const;
+
+    FrameLockStats Stats() const;
+
+private:
+    void Seed(double timeMs, double fps);
+
+    bool seeded = false;
+    bool locked = false;
+    double periodMs = 0.0;
+    double nominalPeriodMs = 0.0;   // from the fps field, keeps the estimate from wandering off
+    double nextFrameMs = 0.0;
+    double lockErrorMs = 0.0;
+    unsigned long long frames = 0;
+    unsigned long long relocks = 0;
+};
@@ -0,0 +1,77 @@
+#include "game_state.h"
+#include "logger.h"
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+const wchar_t* GameStateName(GameState state) {
+    switch (state) {
+    case GameState::Detached: return L"detached";
+    case GameState::Menu: return L"menu";
+    case GameState::Replay: return L"replay";
+    case GameState::Paused: return L"paused";
+    case GameState::Racing: return L"racing";
+    default: return L"unknown";
+    }
+}
+
+GameState ClassifyGameState(const RawTelemetry& telemetry) {
+    if (!telemetry.gp2_isInRace || telemetry.gp2_isX86MenuOn) return GameState::Menu;
+    if (telemetry.gp2_isReplay) return GameState::Replay;
+    if (telemetry.gp2_isPaused) return GameState::Paused;
+    return GameState::Racing;
+}
+
+bool GameStateMachine::Update(GameState next, double nowMs) {
+    if (totals.enteredMs < 0.0) {
+        totals.enteredMs = nowMs;
+        published.Store(totals);
+    }
+    if (next == totals.state) return false;
+
+    GameState previous = totals.state;
+    double stayedMs = nowMs - totals.enteredMs;
+    totals.totalMs[static_cast<int>(previous)] += stayedMs;
+    totals.state = next;
+    totals.enteredMs = nowMs;
+    totals.transitions++;
+    published.Store(totals);
+
+    LOG_INFO(L"[INFO] Game state: %ls -> %ls (after %lld s)", GameStateName(previous), GameStateName(next),
+        static_cast<long long>(stayedMs / 1000.0));
+    return true;
+}
+
+GameState GameStateMachine::State() const {
+    return published.Load().state;
+}
+
+GameStateStats GameStateMachine::Stats(double nowMs) const {
+    Totals t = published.Load();
+    GameStateStats s;
+    s.state = t.state;
+    s.transitions = t.transitions;
+    s.inStateMs = t.enteredMs < 0.0 ? 0.0 : nowMs - t.enteredMs;
+
+    double sessionMs = 0.0;
+    for (int i = 0; i < static_cast<int>(GameState::Count); i++) {
+        s.totalMs[i] = t.totalMs[i];
+        if (i == static_cast<int>(t.state)) s.totalMs[i] += s.inStateMs;
+        sessionMs += s.totalMs[i];
+    }
+    if (sessionMs > 0.0) {
+        s.idleShare = 1.0 - s.totalMs[static_cast<int>(GameState::Racing)] / sessionMs;
+    }
+    return s;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <string>
+#include "telemetry_reader.h"
+#include "seqlock.h"
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// What the game is doing, decided once per read by the reader and passed down the pipeline with each frame
+//
+//   detached - x86GP2 isn't running (or we lost its memory)
+//   menu     - not in a race, or the x86 menu is up over one
+//   replay   - watching a replay
+//   paused   - in a race, paused
+//   racing   - the only state that gets forces
+//
+// Everything but racing is idle: the reader drops to GAME_IDLE_POLL_MS reading only the state flags,
+// compute zeroes the forces once on the way in, the device isn't polled and the output thread stops ticking.
+
+#define GAME_IDLE_POLL_MS 100.0     // reader poll spacing while idle (10Hz is plenty to notice a race starting)
+
+enum class GameState {
+    Detached,
+    Menu,
+    Replay,
+    Paused,
+    Racing,
+    Count
+};
+
+const wchar_t* GameStateName(GameState state);
+
+// From the TELEM_STATE flags. Menu wins over replay, replay over paused
+GameState ClassifyGameState(const RawTelemetry& telemetry);
+
+inline bool GameStateIsIdle(GameState state) { return state != GameState::Racing; }
+
+struct GameStateStats {
+    GameState state = GameState::Detached;
+    double inStateMs = 0.0;                                     // time since the last transition
+    double totalMs[static_cast<int>(GameState::Count)] = {};    // time spent in each state so far
+    double idleShare = 0.0;                                     // share of the session not racing
+    unsigned long long transitions = 0;
+};
+
+// Include logging
+void LogMessage(const std::wstring& msg);
+
+// Update from the reader thread, State/Stats from anywhere
+// The reader is the only writer, and publishes through a Seqlock so the display and the idle priority
+// control channel never hold anything it needs
+class GameStateMachine {
+public:
+    // True if this moved to a new state (logged)
+    bool Update(GameState next, double nowMs);
+
+    GameState State() const;
+    GameStateStats Stats(double nowMs) const;
+
+private:
+    struct Totals {
+        GameState state = GameState::Detached;
+        double enteredMs = -1.0;
+        double totalMs[static_cast<int>(GameState::Count)] = {};
+        unsigned long long transitions = 0;
+    };
+
+    Totals totals;                  // reader thread's own copy
+    Seqlock<Totals> published;
+};
@@ -0,0 +1,251 @@
+#include "logger.h"
+#include "mpsc_ring.h"
+#include "ffb_clock.h"
+#include "thread_policy.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <wchar.h>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+struct LogRecord {
+    double timeMs;
+    unsigned int length;
+    wchar_t text[LOG_RECORD_CHARS];
+};
+
+static MpscRing<LogRecord, LOG_RING_SIZE> logRing;
+static std::atomic<unsigned long long> truncatedMessages{ 0 };
+static std::atomic<unsigned long long> writtenMessages{ 0 };
+static std::atomic<LogFormat> requestedFormat{ LogFormat::Text };
+static std::atomic<LogFormat> currentFormat{ LogFormat::Text };
+
+static std::mutex recentMutex;
+static std::deque<std::wstring> recentLines;
+
+void LogMessage(const std::wstring& msg) {
+    double now = GetFFBClock().NowMs();
+    logRing.Push([&](LogRecord& record) {
+        size_t length = std::min(msg.size(), static_cast<size_t>(LOG_RECORD_CHARS));
+        if (length < msg.size()) truncatedMessages.fetch_add(1, std::memory_order_relaxed);
+        record.timeMs = now;
+        record.length = static_cast<unsigned int>(length);
+        wmemcpy(record.text, msg.data(), length);
+    });
+}
+
+void LogPrintf(const wchar_t* format, ...) {
+    double now = GetFFBClock().NowMs();
+    va_list args;
+    va_start(args, format);
+    logRing.Push([&](LogRecord& record) {
+        int length = vswprintf(record.text, LOG_RECORD_CHARS, format, args);
+        if (length < 0) {
+            // Didn't fit, keep what did
+            record.text[LOG_RECORD_CHARS - 1] = L'\0';
+            length = static_cast<int>(wcslen(record.text));
+            truncatedMessages.fetch_add(1, std::memory_order_relaxed);
+        }
+        record.timeMs = now;
+        record.length = static_cast<unsigned int>(length);
+    });
+    va_end(args);
+}
+
+const wchar_t* LogFormatName(LogFormat format) {
+    return format == LogFormat::Binary ? L"binary" : L"text";
+}
+
+void SetLogFormat(LogFormat format) {
+    requestedFormat.store(format, std::memory_order_relaxed);
+}
+
+// wchar_t is UTF-16 on Windows and UTF-32 on Linux, both end up as UTF-8 in the file
+void AppendUtf8(std::string& out, const wchar_t* text, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        unsigned long c = static_cast<unsigned long>(text[i]);
+        if (c >= 0xD800 && c <= 0xDBFF && i + 1 < length) {
+            unsigned long low = static_cast<unsigned long>(text[i + 1]);
+            if (low >= 0xDC00 && low <= 0xDFFF) {
+                c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                i++;
+            }
+        }
+        if (c < 0x80) {
+            out += static_cast<char>(c);
+        }
+        else if (c < 0x800) {
+            out += static_cast<char>(0xC0 | (c >> 6));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        }
+        else if (c < 0x10000) {
+            out += static_cast<char>(0xE0 | (c >> 12));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        }
+        else {
+            out += static_cast<char>(0xF0 | (c >> 18));
+            out += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+}
+
+static void AppendRecord(std::string& out, LogFormat format, const LogRecord& record) {
+    if (format == LogFormat::Text) {
+        AppendUtf8(out, record.text, record.length);
+        out += '\n';
+        return;
+    }
+
+    size_t headerAt = out.size();
+    out.resize(headerAt + sizeof(LogBinaryHeader));
+    AppendUtf8(out, record.text, record.length);
+
+    LogBinaryHeader header;
+    header.timeMs = static_cast<unsigned int>(std::max(record.timeMs, 0.0));
+    header.length = static_cast<unsigned short>(out.size() - headerAt - sizeof(LogBinaryHeader));
+    memcpy(&out[headerAt], &header, sizeof(header));
+}
+
+static LogRecord MakeRecord(const std::wstring& msg) {
+    LogRecord record;
+    record.timeMs = GetFFBClock().NowMs();
+    record.length = static_cast<unsigned int>(std::min(msg.size(), static_cast<size_t>(LOG_RECORD_CHARS)));
+    wmemcpy(record.text, msg.data(), record.length);
+    return record;
+}
+
+static FILE* OpenLogFile(LogFormat format) {
+    if (format == LogFormat::Text) return fopen(LOG_TEXT_FILE, "w");   // text mode, CRLF on Windows like before
+
+    FILE* file = fopen(LOG_BINARY_FILE, "wb");
+    if (file) fwrite(LOG_BINARY_MAGIC, 1, 8, file);
+    return file;
+}
+
+static void WriterLoop(FILE* file) {
+    ApplyBackgroundPriority(L"Logger");
+
+    LogFormat format = LogFormat::Text;
+    unsigned long long reportedDrops = 0;
+    std::string out;
+    std::vector<std::wstring> batchLines;
+    LogRecord record;
+
+    while (true) {
+        out.clear();
+        batchLines.clear();
+        size_t count = 0;
+        while (count < LOG_BATCH_RECORDS && logRing.Pop(record)) {
+            AppendRecord(out, format, record);
+            batchLines.emplace_back(record.text, record.length);
+            count++;
+        }
+        bool more = count == LOG_BATCH_RECORDS;
+
+        // Say where they went missing, so the gap in the log explains itself
+        unsigned long long drops = logRing.Dropped();
+        if (drops != reportedDrops) {
+            std::wstring note = L"[WARNING] " + std::to_wstring(drops - reportedDrops) + L" log messages dropped, the log couldn't keep up";
+            AppendRecord(out, format, MakeRecord(note));
+            batchLines.push_back(note);
+            reportedDrops = drops;
+            count++;
+        }
+
+        if (count > 0) {
+            if (file) {
+                fwrite(out.data(), 1, out.size(), file);
+                fflush(file);
+            }
+            writtenMessages.fetch_add(count, std::memory_order_relaxed);
+
+            std::lock_guard<std::mutex> lock(recentMutex);
+            for (std::wstring& line : batchLines) {
+                recentLines.push_back(std::move(line));
+                if (recentLines.size() > LOG_RECENT_LINES) recentLines.pop_front();
+            }
+        }
+        if (more) continue;
+
+        // Caught up, a good point to change files
+        LogFormat wanted = requestedFormat.load(std::memory_order_relaxed);
+        if (wanted != format) {
+            FILE* next = OpenLogFile(wanted);
+            std::wstring note = next
+                ? L"[INFO] Log Format: " + std::wstring(LogFormatName(wanted)) + L", the rest of the log is in " +
+                    (wanted == LogFormat::Binary ? L"" LOG_BINARY_FILE : L"" LOG_TEXT_FILE)
+                : L"[WARNING] Could not open the " + std::wstring(LogFormatName(wanted)) + L" log, staying with " +
+                    LogFormatName(format);
+            out.clear();
+            AppendRecord(out, format, MakeRecord(note));
+            if (file) {
+                fwrite(out.data(), 1, out.size(), file);
+                fflush(file);
+            }
+            if (next) {
+                if (file) fclose(file);
+                file = next;
+                format = wanted;
+                currentFormat.store(format, std::memory_order_relaxed);
+            }
+            else {
+                requestedFormat.store(format, std::memory_order_relaxed);
+            }
+            continue;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(LOG_WRITER_IDLE_MS));
+    }
+}
+
+void StartLogger() {
+    // Empty log.txt from the last run before anything new goes in
+    FILE* file = OpenLogFile(LogFormat::Text);
+    std::thread writerThread(WriterLoop, file);
+    writerThread.detach();
+}
+
+void RecentLogLines(size_t count, std::vector<std::wstring>& lines) {
+    // Only a handful are asked for, a linear look for repeats beats building a set
+    size_t found = 0;
+    lines.resize(count);
+    {
+        std::lock_guard<std::mutex> lock(recentMutex);
+        for (auto it = recentLines.rbegin(); it != recentLines.rend() && found < count; ++it) {
+            if (std::find(lines.begin(), lines.begin() + found, *it) == lines.begin() + found) lines[found++] = *it;
+        }
+    }
+    lines.resize(found);
+    std::reverse(lines.begin(), lines.end());
+}
+
+LoggerStats GetLoggerStats() {
+    LoggerStats stats;
+    stats.written = writtenMessages.load(std::memory_order_relaxed);
+    stats.dropped = logRing.Dropped();
+    stats.truncated = truncatedMessages.load(std::memory_order_relaxed);
+    stats.format = currentFormat.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include <vector>
+#include "ffb_clock.h"
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// Logger
+// LogMessage is called from the FFB threads (the constant force logs its smoothing, device I/O its
+// failures...) so it can't take a lock or touch the disk. It copies the message into a fixed size record
+// in an MpscRing (mpsc_ring.h) and returns. A thread of its own drains the ring in batches into a file it
+// keeps open, and keeps the last few lines for the console. A full ring drops the message and counts it,
+// and the writer puts "N messages dropped" in the log where they went missing.
+//
+//   text   - log.txt, one message per line as always
+//   binary - log.bin, compact records of the time stamp and the UTF-8 text, nothing formatted on the way
+//            out. tools/log_dump.cpp turns it back into text with the times
+//
+// Startup messages go to log.txt until ffb.ini has been read, then Log Format picks where the rest go.
+//
+// Log levels
+// The force code logs through the LOG_* macros below instead of building a std::wstring per call:
+//
+//   LOG_DEBUG(L"[DEBUG] Smoothing from %f to %f", from, to);
+//   LOG_DEBUG_EVERY(5000, L"[VIBRATION DEBUG] Speed: %f", speed);    at most once per 5 s from this line
+//
+// A level above FFB_LOG_LEVEL is compiled out, arguments and all. What is left is printf'd straight into
+// the ring record by LogPrintf, and only once the ring has room - nothing is allocated either way.
+// Release builds (NDEBUG) stop at INFO, so none of the [DEBUG] lines are in the FFB loop;
+// build with FFB_LOG_LEVEL=4 to get them back. The rate limit runs on the FFB clock, so replays keep it too.
+// Wide printf: %d %f %ld %lu %ls (not %s, MSVC and the rest disagree on it).
+
+#define LOG_TEXT_FILE "log.txt"
+#define LOG_BINARY_FILE "log.bin"
+#define LOG_BINARY_MAGIC "GP2LOG1\n"    // first 8 bytes of log.bin
+#define LOG_RING_SIZE 1024              // messages waiting for the writer before new ones are dropped
+#define LOG_RECORD_CHARS 240            // longer messages are cut
+#define LOG_BATCH_RECORDS 256           // most messages per file write
+#define LOG_WRITER_IDLE_MS 10           // writer sleep when the ring is empty
+#define LOG_RECENT_LINES 100            // kept for the console
+
+#define LOG_LEVEL_OFF 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef FFB_LOG_LEVEL
+#ifdef NDEBUG
+#define FFB_LOG_LEVEL LOG_LEVEL_INFO
+#else
+#define FFB_LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+#endif
+
+#define FFB_LOG(level, ...) \
+    do { if constexpr ((level) <= FFB_LOG_LEVEL) LogPrintf(__VA_ARGS__); } while (0)
+
+#define FFB_LOG_EVERY(level, intervalMs, ...) \
+    do { \
+        if constexpr ((level) <= FFB_LOG_LEVEL) { \
+            static LogRateLimit logSite(intervalMs); \
+            if (logSite.Allow()) LogPrintf(__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_ERROR(...) FFB_LOG(LOG_LEVEL_ERROR, __VA_ARGS__)
+#define LOG_WARNING(...) FFB_LOG(LOG_LEVEL_WARNING, __VA_ARGS__)
+#define LOG_INFO(...) FFB_LOG(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_DEBUG(...) FFB_LOG(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_ERROR_EVERY(intervalMs, ...) FFB_LOG_EVERY(LOG_LEVEL_ERROR, intervalMs, __VA_ARGS__)
+#define LOG_WARNING_EVERY(intervalMs, ...) FFB_LOG_EVERY(LOG_LEVEL_WARNING, intervalMs, __VA_ARGS__)
+#define LOG_INFO_EVERY(intervalMs, ...) FFB_LOG_EVERY(LOG_LEVEL_INFO, intervalMs, __VA_ARGS__)
+#define LOG_DEBUG_EVERY(intervalMs, ...) FFB_LOG_EVERY(LOG_LEVEL_DEBUG, intervalMs, __VA_ARGS__)
+
+enum class LogFormat {
+    Text,
+    Binary
+};
+
+// One log.bin record after the magic, little endian: uint32 ms since start, uint16 byte count, UTF-8 text
+#pragma pack(push, 1)
+struct LogBinaryHeader {
+    unsigned int timeMs;
+    unsigned short length;
+};
+#pragma pack(pop)
+
+struct LoggerStats {
+    unsigned long long written = 0;
+    unsigned long long dropped = 0;     // ring was full
+    unsigned long long truncated = 0;   // longer than LOG_RECORD_CHARS
+    LogFormat format = LogFormat::Text;
+};
+
+// Any thread, never blocks. Safe before StartLogger, the ring just fills until the writer starts
+void LogMessage(const std::wstring& msg);
+
+// Same, formatted into the ring record (cut at LOG_RECORD_CHARS). Use it through the LOG_* macros
+void LogPrintf(const wchar_t* format, ...);
+
+// One per call site, made by FFB_LOG_EVERY. Any thread - if two race for the same slot only one logs
+class LogRateLimit {
+public:
+    explicit LogRateLimit(double intervalMs) : intervalMs(intervalMs) {}
+
+    bool Allow() {
+        double now = GetFFBClock().NowMs();
+        double next = nextMs.load(std::memory_order_relaxed);
+        return now >= next && nextMs.compare_exchange_strong(next, now + intervalMs, std::memory_order_relaxed);
+    }
+
+private:
+    double intervalMs;
+    std::atomic<double> nextMs{ 0.0 };
+};
+
+// Empties log.txt and starts the writer in text mode
+void StartLogger();
+
+// "text" / "binary"
+const wchar_t* LogFormatName(LogFormat format);
+
+// The writer finishes what is queued in the current file and moves on to the other one
+void SetLogFormat(LogFormat format);
+
+// Most recent distinct messages into lines, oldest first. Reuses lines' storage, so calling it every
+// refresh with the same vector doesn't allocate. Only the writer and this take the lock behind it
+void RecentLogLines(size_t count, std::vector<std::wstring>& lines);
+
+LoggerStats GetLoggerStats();
+
+// wchar_t text (UTF-16 on Windows, UTF-32 on Linux) appended as UTF-8
+void AppendUtf8(std::string& out, const wchar_t* text, size_t length);
@@ -40,30 +40,46 @@
 // === Project Includes ===
 #include "ffb_setup.h"
 #include "telemetry_reader.h"
+#include "telemetry_layout.h"
+#include "telemetry_wakeup.h"
+#include "telemetry_recorder.h"
+#include "ffb_clock.h"
+#include "ffb_scheduler.h"
+#include "frame_lock.h"
+#include "ffb_pipeline.h"
+#include "ffb_output.h"
+#include "seqlock.h"
+#include "device_io.h"
+#include "game_state.h"
+#include "effect_update.h"
+#include "thread_policy.h"
+#include "watchdog.h"
+#include "ffb_config.h"
+#include "control_channel.h"
+#include "logger.h"
+#include "console_screen.h"
 #include "calculations/vehicle_dynamics.h"
 #include "forces/constant_force.h"
 #include "forces/periodic_force.h"
 #include "forces/damper_effect.h"
 #include "forces/spring_effect.h"
+#include "forces/force_upsampler.h"
 
 // Global timing buffers
-LARGE_INTEGER start, end, frequency;
-double printTime = 0.0, telemetryTime = 0.0, FFBTime = 0.0;
+double printTime = 0.0, telemetryTime = 0.0;
 
 #define PRINT_INTERVAL 66.68     // log timing ~15fps
-#define TELEMETRY_INTERVAL 16.67  // ~60 FPS telemetry
-#define FFB_INTERVAL 16.67        // ~60 FPS FFB
+#define READER_WAIT_MS 100.0      // longest the reader sleeps without hearing from the game
+#define MAX_MISSED_FRAMES_PER_GAP 30  // longer gaps are the game stalling/loading, not frames we missed
 
+// Telemetry the console display reads, only decoded on the ticks that copy to the display
+#define DISPLAY_FIELDS (TELEM_STATE | TELEM_SPEED | TELEM_STEERING | TELEM_SLIP_ANGLES | TELEM_TYRE_FORCES | TELEM_SURFACE | TELEM_EXTRAS)
+
+// Loop time in ms, from the FFB clock so a replay can drive it (realtime otherwise)
 double getPerformanceCounterTime() {
-    QueryPerformanceCounter(&end);
-    return (double)(end.QuadPart - start.QuadPart) * 1000.0 / frequency.QuadPart;
+    return GetFFBClock().NowMs();
 }
 
-// Global log buffer
-std::mutex logMutex;
-std::deque<std::wstring> logLines;
-const size_t maxLogLines = 1000;  // Show last 1000 log lines
-
 // === Global Force Feedback Flags & States ===
 // I have 3 effects right now which all get calculated separately
 // I think probably all you need are these three to make good FFB
@@ -87,7 +103,6 @@ IDirectInputEffect* periodicVibrationEffect = nullptr;
 IDirectInputEffect* damperEffect = nullptr;
 IDirectInputEffect* springEffect = nullptr;
 
-DIJOYSTATE2 js; // No idea what this is
 
 
 // === Shared Telemetry Display Data ===
@@ -172,12 +187,53 @@ struct TelemetryDisplayData {
     double vd_yawMoment = 0.0;
 };
 
+// FFB tick timing, published by the output thread through a Seqlock so the display and the control
+// channel can read it without taking a lock the output thread also needs
+struct OutputStageFigures {
+    double jitterP50Ms = 0.0;
+    double jitterP99Ms = 0.0;
+    unsigned long long overruns = 0;
+    double wakeLateP99Ms = 0.0;
+    unsigned long long preemptions = 0;
+    bool frameLocked = false;
+    double framePeriodMs = 0.0;
+    double frameLockErrorMs = 0.0;
+};
+
 // === Shared Globals ===
 std::mutex displayMutex;
 TelemetryDisplayData displayData;
+static Seqlock<OutputStageFigures> outputFigures;
 std::atomic<double> currentSpeed = 0.0;
-int g_currentFFBForce = 0;
-int g_currentFrontLoad = 0;
+// Written by compute (constant_force.cpp), read by the display and the control channel
+std::atomic<int> g_currentFFBForce{ 0 };
+std::atomic<int> g_currentFrontLoad{ 0 };
+
+// Frame counters - fresh = new game frame used, duplicate = tick with no new frame,
+// missed = game frames that came and went between two of our reads,
+// coalesced = frames the output folded into a newer one before sending (it only ever sends the newest)
+std::atomic<unsigned long long> g_freshFrames = 0;
+std::atomic<unsigned long long> g_duplicateFrames = 0;
+std::atomic<unsigned long long> g_missedFrames = 0;
+std::atomic<unsigned long long> g_coalescedFrames = 0;
+
+// Pipeline stages and the rings between them
+static SpscRing<PipelineFrame, PIPELINE_FRAME_RING> frameRing;
+static SpscRing<ForceFrame, PIPELINE_FORCE_RING> forceRing;
+static StageSignal computeSignal;
+static PipelineStageMeter readerMeter;
+static PipelineStageMeter computeMeter;
+static PipelineStageMeter outputMeter;
+static StageSignal outputSignal;
+
+// Each effect's update policy, the output stage only sends when it says so
+static EffectUpdateGate constantGate(CONSTANT_FORCE_UPDATE_POLICY);
+static EffectUpdateGate damperGate(DAMPER_UPDATE_POLICY);
+static EffectUpdateGate springGate(SPRING_UPDATE_POLICY);
+static EffectUpdateGate vibrationGate(VIBRATION_UPDATE_POLICY);
+
+// Racing or not, the reader keeps it up to date
+static GameStateMachine gameStateMachine;
 
 // Check Admin rights
 bool IsRunningAsAdmin() {
@@ -280,16 +336,10 @@ void DisableConsoleQuickEdit() {
     }
 }
 
-void MoveCursorToTop() {
-    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-    COORD topLeft = { 0, 0 };
-    SetConsoleCursorPosition(hConsole, topLeft);
-}
-
-void MoveCursorToLine(short lineNumber) {
-    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-    COORD pos = { 0, lineNumber };
-    SetConsoleCursorPosition(hConsole, pos);
+// Closing the console window ends the process, finish the recording first so it gets its index
+BOOL WINAPI ConsoleCloseHandler(DWORD ctrlType) {
+    StopTelemetryRecording();
+    return FALSE; // let the default handler exit
 }
 
 void HideConsoleCursor() {
@@ -315,285 +365,170 @@ void HideConsoleCursor() {
 }
 
 // New display
+// Each line goes into the screen's cells, Present then sends only what changed (console_screen.h)
 
-void DisplayTelemetry(const TelemetryDisplayData& displayData, double masterForceValue) {
-    // Move cursor to top and set up formatting
-    MoveCursorToTop();
-    std::cout << std::fixed << std::setprecision(2);
-    std::wcout << std::fixed << std::setprecision(2);  // Also set for wide cout
-
-    // Define console width
-    const size_t CONSOLE_WIDTH = 80;
-
-    // Helper lambda to pad lines
-    auto padLine = [CONSOLE_WIDTH](const std::wstring& text) {
-        std::wstring padded = text;
-        if (padded.length() < CONSOLE_WIDTH) {
-            padded.append(CONSOLE_WIDTH - padded.length(), L' ');
-        }
-        else if (padded.length() > CONSOLE_WIDTH) {
-            padded = padded.substr(0, CONSOLE_WIDTH);  // Truncate if too long
-        }
-        return padded;
-        };
-
+void DisplayTelemetry(ConsoleScreen& screen, const TelemetryDisplayData& displayData, double masterForceValue) {
     // Header section
-    std::wcout << padLine(L"GP2 FFB Program Version 0.4.4 BETA") << L"\n";
-    std::wcout << padLine(L"") << L"\n";
-    std::wcout << padLine(L"Connected Device: " + targetDeviceName) << L"\n";
-    std::wcout << padLine(L"Game: " + targetGameVersion) << L"\n";
-
-    std::wostringstream ss;
-    ss << std::fixed << std::setprecision(2);  // Set formatting for stringstream too
-    ss << L"Master Force Scale: " << masterForceValue << L"%";
-    std::wcout << padLine(ss.str()) << L"\n";
-    std::wcout << padLine(L"") << L"\n";  // Empty line
+    screen.Print(L"GP2 FFB Program Version 0.4.4 BETA");
+    screen.Print(L"");
+    screen.Print(L"Connected Device: %ls", targetDeviceName.c_str());
+    screen.Print(L"Game: %ls", targetGameVersion.c_str());
+    screen.Print(L"Master Force Scale: %.2f%%", masterForceValue);
+    screen.Print(L"");  // Empty line
 
     // Raw data section
-    std::wcout << padLine(L"      == Raw Data ==") << L"\n";
-    std::wcout << padLine(L"") << L"\n";
+    screen.Print(L"      == Raw Data ==");
+    screen.Print(L"");
 
     /*
     // GP2 Program States
-    ss.str(L""); ss.clear();
-    ss << L"In Race: " << std::setw(10) << displayData.gp2_isInRace;
-    std::wcout << padLine(ss.str()) << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << L"Is Player: " << std::setw(10) << displayData.gp2_isPlayer;
-    std::wcout << padLine(ss.str()) << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << L"Is Paused: " << std::setw(10) << displayData.gp2_isPaused;
-    std::wcout << padLine(ss.str()) << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << L"Is Replay: " << std::setw(10) << displayData.gp2_isReplay;
-    std::wcout << padLine(ss.str()) << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << L"x86 Menu: " << std::setw(10) << displayData.gp2_isX86MenuOn;
-    std::wcout << padLine(ss.str()) << L"\n";
+    screen.Print(L"In Race: %10.2f", displayData.gp2_isInRace);
+    screen.Print(L"Is Player: %10.2f", displayData.gp2_isPlayer);
+    screen.Print(L"Is Paused: %10.2f", displayData.gp2_isPaused);
+    screen.Print(L"Is Replay: %10.2f", displayData.gp2_isReplay);
+    screen.Print(L"x86 Menu: %10.2f", displayData.gp2_isX86MenuOn);
     */
 
-    std::wcout << padLine(L"") << L"\n";  // Empty line
-
-
-   // ss.str(L""); ss.clear();
-   // ss << L"Device Name: " << std::setw(10) << displayData.gp2_deviceID;
-   // std::wcout << padLine(ss.str()) << L"\n";
+    screen.Print(L"");  // Empty line
 
+   // screen.Print(L"Device Name: %10d", displayData.gp2_deviceID);
 
-    ss.str(L""); ss.clear();
-    ss << L"Speed: " << std::setw(8) << displayData.gp2_speedKmh << L" kph";
-    std::wcout << padLine(ss.str()) << L"\n";
+    screen.Print(L"Speed: %8.2f kph", displayData.gp2_speedKmh);
+    screen.Print(L"Steering Wheel Angle: %10.2f", displayData.gp2_stWheelAngle);
+    screen.Print(L"Tyre Turn Angle: %10.2f", displayData.gp2_tyreTurnAngle);
+    screen.Print(L"Slip Angle Front: %10.2f", displayData.gp2_slipAngleFront);
+    screen.Print(L"Slip Angle Rear: %10.2f", displayData.gp2_slipAngleRear);
 
-    ss.str(L""); ss.clear();
-    ss << L"Steering Wheel Angle: " << std::setw(10) << displayData.gp2_stWheelAngle;
-    std::wcout << padLine(ss.str()) << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << L"Tyre Turn Angle: " << std::setw(10) << displayData.gp2_tyreTurnAngle;
-    std::wcout << padLine(ss.str()) << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << L"Slip Angle Front: " << std::setw(10) << displayData.gp2_slipAngleFront;
-    std::wcout << padLine(ss.str()) << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << L"Slip Angle Rear: " << std::setw(10) << displayData.gp2_slipAngleRear;
-    std::wcout << padLine(ss.str()) << L"\n";
-
-
-    std::wcout << padLine(L"") << L"\n";  // Empty line
+    screen.Print(L"");  // Empty line
 
     // Tire loads section
-    std::wcout << padLine(L"      == Tire/Suspension Data ==") << L"\n";
-    std::wcout << padLine(L"") << L"\n";
-    std::wcout << padLine(L"      Left Front      Right Front") << L"\n";
-
+    screen.Print(L"      == Tire/Suspension Data ==");
+    screen.Print(L"");
+    screen.Print(L"      Left Front      Right Front");
 
     //Raw Forces
     /*
-    ss.str(L""); ss.clear();
-    ss << std::setw(10) << L"Mag Lat: " << static_cast<int>(displayData.gp2_magLat_lf) << L"           " << std::setw(10) << static_cast<int>(displayData.gp2_magLat_rf);
-    std::wcout << padLine(ss.str()) << L"\n";
-    std::wcout << padLine(L"") << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << std::setw(10) << L"Mag Long: " << static_cast<int>(displayData.gp2_magLong_lf) << L"           " << std::setw(10) << static_cast<int>(displayData.gp2_magLong_rf);
-    std::wcout << padLine(ss.str()) << L"\n";
-    std::wcout << padLine(L"") << L"\n";
+    screen.Print(L"%10ls%d           %10d", L"Mag Lat: ", static_cast<int>(displayData.gp2_magLat_lf), static_cast<int>(displayData.gp2_magLat_rf));
+    screen.Print(L"");
+    screen.Print(L"%10ls%d           %10d", L"Mag Long: ", static_cast<int>(displayData.gp2_magLong_lf), static_cast<int>(displayData.gp2_magLong_rf));
+    screen.Print(L"");
     */
 
-    ss.str(L""); ss.clear();
-    ss << std::setw(10) << L"Mag Lat: " << static_cast<int>(displayData.vd_frontLeftForce_N) << L"           " << std::setw(10) << static_cast<int>(displayData.vd_frontRightForce_N);
-    std::wcout << padLine(ss.str()) << L"\n";
-    std::wcout << padLine(L"") << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << std::setw(10) << L"Mag Long: " << static_cast<int>(displayData.vd_frontLeftLong_N) << L"           " << std::setw(10) << static_cast<int>(displayData.vd_frontRightLong_N);
-    std::wcout << padLine(ss.str()) << L"\n";
-    std::wcout << padLine(L"") << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << std::setw(10) << L"Surface: " << static_cast<int>(displayData.gp2_surfaceType_lf) << L"           " << std::setw(10) << static_cast<int>(displayData.gp2_surfaceType_rf);
-    std::wcout << padLine(ss.str()) << L"\n";
-    std::wcout << padLine(L"") << L"\n";
+    screen.Print(L"%10ls%d           %10d", L"Mag Lat: ", static_cast<int>(displayData.vd_frontLeftForce_N), static_cast<int>(displayData.vd_frontRightForce_N));
+    screen.Print(L"");
+    screen.Print(L"%10ls%d           %10d", L"Mag Long: ", static_cast<int>(displayData.vd_frontLeftLong_N), static_cast<int>(displayData.vd_frontRightLong_N));
+    screen.Print(L"");
+    screen.Print(L"%10ls%d           %10d", L"Surface: ", static_cast<int>(displayData.gp2_surfaceType_lf), static_cast<int>(displayData.gp2_surfaceType_rf));
+    screen.Print(L"");
     /*
-    ss.str(L""); ss.clear();
-    ss << std::setw(10) << L"Ride Height: " << static_cast<int>(std::abs(displayData.gp2_rideHeights_lf)) << L"           " << std::setw(10) << static_cast<int>(std::abs(displayData.gp2_rideHeights_rf));
-    std::wcout << padLine(ss.str()) << L"\n";
-    std::wcout << padLine(L"") << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << std::setw(10) << L"Wheel Spin: " << static_cast<int>(displayData.gp2_wheelSpin_13C_lf) << L"           " << std::setw(10) << static_cast<int>(displayData.gp2_wheelSpin_13C_rf);
-    std::wcout << padLine(ss.str()) << L"\n";
-    std::wcout << padLine(L"") << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << std::setw(10) << L"Not on Damper: " << static_cast<int>(displayData.gp2_notOnDamper_lf) << L"           " << std::setw(10) << static_cast<int>(displayData.gp2_notOnDamper_rf);
-    std::wcout << padLine(ss.str()) << L"\n";
-    std::wcout << padLine(L"") << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << std::setw(10) << L"Calc 248: " << static_cast<int>(displayData.gp2_calc_248_lf) << L"           " << std::setw(10) << static_cast<int>(displayData.gp2_calc_248_rf);
-    std::wcout << padLine(ss.str()) << L"\n";
-    std::wcout << padLine(L"") << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << std::setw(10) << L"Wheel 2AC: " << static_cast<int>(displayData.gp2_wheel_2AC_lf) << L"           " << std::setw(10) << static_cast<int>(displayData.gp2_wheel_2AC_rf);
-    std::wcout << padLine(ss.str()) << L"\n";
-    std::wcout << padLine(L"") << L"\n";
-
+    screen.Print(L"%10ls%d           %10d", L"Ride Height: ", static_cast<int>(std::abs(displayData.gp2_rideHeights_lf)), static_cast<int>(std::abs(displayData.gp2_rideHeights_rf)));
+    screen.Print(L"");
+    screen.Print(L"%10ls%d           %10d", L"Wheel Spin: ", static_cast<int>(displayData.gp2_wheelSpin_13C_lf), static_cast<int>(displayData.gp2_wheelSpin_13C_rf));
+    screen.Print(L"");
+    screen.Print(L"%10ls%d           %10d", L"Not on Damper: ", static_cast<int>(displayData.gp2_notOnDamper_lf), static_cast<int>(displayData.gp2_notOnDamper_rf));
+    screen.Print(L"");
+    screen.Print(L"%10ls%d           %10d", L"Calc 248: ", static_cast<int>(displayData.gp2_calc_248_lf), static_cast<int>(displayData.gp2_calc_248_rf));
+    screen.Print(L"");
+    screen.Print(L"%10ls%d           %10d", L"Wheel 2AC: ", static_cast<int>(displayData.gp2_wheel_2AC_lf), static_cast<int>(displayData.gp2_wheel_2AC_rf));
+    screen.Print(L"");
     */
 
-    //ss.str(L""); ss.clear();
-    //ss << std::setw(10) << L"latN: " << static_cast<int16_t>(displayData.vd_frontLeftForce_N) << L"           " << std::setw(10) << static_cast<int16_t>(displayData.vd_frontRightForce_N);
-    //std::wcout << padLine(ss.str()) << L"\n";
-    //std::wcout << padLine(L"") << L"\n";
-  
-   // std::wcout << padLine(L"      Left Rear      Right Rear") << L"\n";
-    //ss.str(L""); ss.clear();
-    //ss << std::setw(10) << displayData.tireload_lr << L"           " << std::setw(10) << displayData.tireload_rr;
-    //std::wcout << padLine(ss.str()) << L"\n";
-    //std::wcout << padLine(L"") << L"\n";
-
-
-
-    //ss.str(L""); ss.clear();
-    //ss << std::setw(10) << L"Surface: " << static_cast<int>(displayData.gp2_surfaceType_lr) << L"           " << std::setw(10) << static_cast<int>(displayData.gp2_surfaceType_rr);
-    //std::wcout << padLine(ss.str()) << L"\n";
-    //std::wcout << padLine(L"") << L"\n";
+   // screen.Print(L"      Left Rear      Right Rear");
+    //screen.Print(L"%10ls%d           %10d", L"Surface: ", static_cast<int>(displayData.gp2_surfaceType_lr), static_cast<int>(displayData.gp2_surfaceType_rr));
+    //screen.Print(L"");
   /*
-    ss.str(L""); ss.clear();
-    ss << std::setw(10) << L"Ride Height: " << static_cast<int>(displayData.gp2_rideHeights_lr) << L"           " << std::setw(10) << static_cast<int>(displayData.gp2_rideHeights_rr);
-    std::wcout << padLine(ss.str()) << L"\n";
-    std::wcout << padLine(L"") << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << std::setw(10) << L"Wheel Spin: " << static_cast<int>(displayData.gp2_wheelSpin_13C_lr) << L"           " << std::setw(10) << static_cast<int>(displayData.gp2_wheelSpin_13C_rr);
-    std::wcout << padLine(ss.str()) << L"\n";
-    std::wcout << padLine(L"") << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << std::setw(10) << L"Not on Damper: " << static_cast<int>(displayData.gp2_notOnDamper_lr) << L"           " << std::setw(10) << static_cast<int>(displayData.gp2_notOnDamper_rr);
-    std::wcout << padLine(ss.str()) << L"\n";
-    std::wcout << padLine(L"") << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << std::setw(10) << L"Calc 248: " << static_cast<int>(displayData.gp2_calc_248_lr) << L"           " << std::setw(10) << static_cast<int>(displayData.gp2_calc_248_rr);
-    std::wcout << padLine(ss.str()) << L"\n";
-    std::wcout << padLine(L"") << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << std::setw(10) << L"Wheel 2AC: " << static_cast<int>(displayData.gp2_wheel_2AC_lr) << L"           " << std::setw(10) << static_cast<int>(displayData.gp2_wheel_2AC_rr);
-    std::wcout << padLine(ss.str()) << L"\n";
-    std::wcout << padLine(L"") << L"\n";
+    screen.Print(L"%10ls%d           %10d", L"Ride Height: ", static_cast<int>(displayData.gp2_rideHeights_lr), static_cast<int>(displayData.gp2_rideHeights_rr));
+    screen.Print(L"");
+    screen.Print(L"%10ls%d           %10d", L"Wheel Spin: ", static_cast<int>(displayData.gp2_wheelSpin_13C_lr), static_cast<int>(displayData.gp2_wheelSpin_13C_rr));
+    screen.Print(L"");
+    screen.Print(L"%10ls%d           %10d", L"Not on Damper: ", static_cast<int>(displayData.gp2_notOnDamper_lr), static_cast<int>(displayData.gp2_notOnDamper_rr));
+    screen.Print(L"");
+    screen.Print(L"%10ls%d           %10d", L"Calc 248: ", static_cast<int>(displayData.gp2_calc_248_lr), static_cast<int>(displayData.gp2_calc_248_rr));
+    screen.Print(L"");
+    screen.Print(L"%10ls%d           %10d", L"Wheel 2AC: ", static_cast<int>(displayData.gp2_wheel_2AC_lr), static_cast<int>(displayData.gp2_wheel_2AC_rr));
+    screen.Print(L"");
 */
 
     // Vehicle Dynamics section
-    std::wcout << padLine(L"      == Vehicle Dynamics ==") << L"\n";
-    std::wcout << padLine(L"") << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << L"Lateral G: " << std::setw(8) << displayData.vd_lateralG << L" G";
-    std::wcout << padLine(ss.str()) << L"\n";
-
-    //ss.str(L""); ss.clear();
-    //ss << L"Yaw Rate: " << std::setw(8) << displayData.vd_yaw << L" deg/s";
-    //std::wcout << padLine(ss.str()) << L"\n";
-
-    //ss.str(L""); ss.clear();
-    //ss << L"Longi Force: " << std::setw(8) << displayData.long_force << L"";
-    //std::wcout << padLine(ss.str()) << L"\n";
-
-    //ss.str(L""); ss.clear();
-    //ss << L"Direction Value: " << displayData.vd_directionVal;
-    //std::wcout << padLine(ss.str()) << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << L"Front Force Calc: " << std::setw(10) << g_currentFrontLoad;
-    std::wcout << padLine(ss.str()) << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << L"Force Magnitude: " << g_currentFFBForce;
-    std::wcout << padLine(ss.str()) << L"\n";
-    std::wcout << padLine(L"") << L"\n";
+    screen.Print(L"      == Vehicle Dynamics ==");
+    screen.Print(L"");
+
+    screen.Print(L"Lateral G: %8.2f G", displayData.vd_lateralG);
+    //screen.Print(L"Direction Value: %d", displayData.vd_directionVal);
+    screen.Print(L"Front Force Calc: %10d", g_currentFrontLoad.load(std::memory_order_relaxed));
+    screen.Print(L"Force Magnitude: %d", g_currentFFBForce.load(std::memory_order_relaxed));
+
+    GameStateStats stateStats = gameStateMachine.Stats(getPerformanceCounterTime());
+    screen.Print(L"Game State: %ls for %.0f s, idle %.0f%% of the session", GameStateName(stateStats.state),
+        stateStats.inStateMs / 1000.0, stateStats.idleShare * 100.0);
+
+    screen.Print(L"Frames: %llu fresh, %llu duplicate, %llu missed, %llu coalesced", g_freshFrames.load(),
+        g_duplicateFrames.load(), g_missedFrames.load(), g_coalescedFrames.load());
+
+    OutputStageFigures output = outputFigures.Load();
+    screen.Print(L"Tick Jitter: %.3f ms p50, %.3f ms p99, %llu overruns", output.jitterP50Ms, output.jitterP99Ms,
+        output.overruns);
+    screen.Print(L"Tick Wake: %.3f ms late p99, %llu preempted while spinning", output.wakeLateP99Ms,
+        output.preemptions);
+    screen.Print(L"Frame Lock: %ls%.3f fps, %.3f ms error", output.frameLocked ? L"locked, " : L"searching, ",
+        output.framePeriodMs > 0.0 ? 1000.0 / output.framePeriodMs : 0.0, output.frameLockErrorMs);
+    // Busy share since the previous refresh, the control channel keeps its own
+    static PipelineStageStats lastReaderStats, lastComputeStats, lastOutputStats;
+    PipelineStageStats readerStats = readerMeter.Stats();
+    PipelineStageStats computeStats = computeMeter.Stats();
+    PipelineStageStats outputStats = outputMeter.Stats();
+    screen.Print(L"Pipeline: read %.1f%%, compute %.1f%%, output %.1f%% busy", readerStats.Occupancy(lastReaderStats) * 100.0,
+        computeStats.Occupancy(lastComputeStats) * 100.0, outputStats.Occupancy(lastOutputStats) * 100.0);
+    lastReaderStats = readerStats;
+    lastComputeStats = computeStats;
+    lastOutputStats = outputStats;
+    screen.Print(L"Queues: frames %llu (max %llu, dropped %llu), forces %llu (max %llu, dropped %llu)",
+        static_cast<unsigned long long>(frameRing.Depth()), static_cast<unsigned long long>(frameRing.HighWater()), frameRing.Dropped(),
+        static_cast<unsigned long long>(forceRing.Depth()), static_cast<unsigned long long>(forceRing.HighWater()), forceRing.Dropped());
+    screen.Print(L"Sent/Held: constant %llu/%llu, damper %llu/%llu, spring %llu/%llu, vibration %llu/%llu",
+        constantGate.Sent(), constantGate.Held(), damperGate.Sent(), damperGate.Held(), springGate.Sent(), springGate.Held(),
+        vibrationGate.Sent(), vibrationGate.Held());
+    DeviceIOStats ioStats = GetDeviceIOStats();
+    screen.Print(L"Device I/O: %llu sent, %llu coalesced, %llu dropped, %llu failed, slowest %.2f ms", ioStats.total.sent,
+        ioStats.total.coalesced, ioStats.total.dropped, ioStats.total.failed, ioStats.maxCallMs);
+    WatchdogStats watchdogStats = GetWatchdogStats();
+    if (!watchdogStats.enabled) {
+        screen.Print(L"Watchdog: off");
+    }
+    else if (watchdogStats.stalls > 0) {
+        screen.Print(L"Watchdog: %ls%llu stalls, %.1f s total, longest %.0f ms (%ls)", watchdogStats.tripped ? L"TRIPPED, " : L"",
+            watchdogStats.stalls, watchdogStats.totalStallMs / 1000.0, watchdogStats.longestStallMs, WatchdogStageName(watchdogStats.lastStalled));
+    }
+    else {
+        screen.Print(L"Watchdog: %ls%llu stalls, %.1f s total, longest %.0f ms", watchdogStats.tripped ? L"TRIPPED, " : L"",
+            watchdogStats.stalls, watchdogStats.totalStallMs / 1000.0, watchdogStats.longestStallMs);
+    }
+    LoggerStats loggerStats = GetLoggerStats();
+    screen.Print(L"Log (%ls): %llu written, %llu dropped, %llu cut short", LogFormatName(loggerStats.format), loggerStats.written,
+        loggerStats.dropped, loggerStats.truncated);
+    screen.Print(L"");
 
     /*
     // Tire Forces
-    std::wcout << padLine(L"      == Decoded Tire Forces ==") << L"\n";
-    std::wcout << padLine(L"") << L"\n";
-    std::wcout << padLine(L"Front Left      Front Right") << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << std::setw(10) << displayData.vd_force_lf << L"           " << std::setw(10) << displayData.vd_force_rf;
-    std::wcout << padLine(ss.str()) << L"\n";
-    std::wcout << padLine(L"") << L"\n";
-
-    std::wcout << padLine(L"Rear Left       Rear Right") << L"\n";
-    ss.str(L""); ss.clear();
-    ss << std::setw(10) << displayData.vd_force_lr << L"           " << std::setw(10) << displayData.vd_force_rr;
-    std::wcout << padLine(ss.str()) << L"\n";
-    std::wcout << padLine(L"") << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << L"Front Total: " << std::setw(8) << displayData.vd_frontLateralForce << L"   Rear Total: " << std::setw(8) << displayData.vd_rearLateralForce;
-    std::wcout << padLine(ss.str()) << L"\n";
-
-    ss.str(L""); ss.clear();
-    ss << L"Total Force: " << std::setw(8) << displayData.vd_totalLateralForce << L"   Yaw Moment: " << std::setw(8) << displayData.vd_yawMoment;
-    std::wcout << padLine(ss.str()) << L"\n";
-    std::wcout << padLine(L"") << L"\n";
-
-    /*
+    screen.Print(L"      == Decoded Tire Forces ==");
+    screen.Print(L"");
+    screen.Print(L"Front Left      Front Right");
+    screen.Print(L"%10.2f           %10.2f", displayData.vd_force_lf, displayData.vd_force_rf);
+    screen.Print(L"");
+
+    screen.Print(L"Rear Left       Rear Right");
+    screen.Print(L"%10.2f           %10.2f", displayData.vd_force_lr, displayData.vd_force_rr);
+    screen.Print(L"");
+
+    screen.Print(L"Front Total: %8.2f   Rear Total: %8.2f", displayData.vd_frontLateralForce, displayData.vd_rearLateralForce);
+    screen.Print(L"Total Force: %8.2f   Yaw Moment: %8.2f", displayData.vd_totalLateralForce, displayData.vd_yawMoment);
+    screen.Print(L"");
     */
-    
 
-    //ss.str(L""); ss.clear();
-    //ss << L"Force Magnitude: " << displayData.forceMagnitude;
-    //std::wcout << padLine(ss.str()) << L"\n";
+    //screen.Print(L"Force Magnitude: %d", displayData.forceMagnitude);
 
-    std::wcout << padLine(L"----------------------------------------") << L"\n";
-    std::wcout << padLine(L"Log:") << L"\n";
-}
-
-// Logging stuff - Keeps messages for future debugging!
-// Write to log.txt
-void LogMessage(const std::wstring& msg) {
-    std::lock_guard<std::mutex> lock(logMutex);
-
-    // Add to in-memory deque for optional UI display (if needed)
-    logLines.push_back(msg);
-    if (logLines.size() > maxLogLines)
-        logLines.pop_front();
-
-    // Append to log.txt
-    std::wofstream logFile("log.txt", std::ios::app);
-    if (logFile.is_open()) {
-        logFile << msg << std::endl;
-    }
+    screen.Print(L"----------------------------------------");
+    screen.Print(L"Log:");
 }
 
 // === Force Effect Creators ===
@@ -702,241 +637,610 @@ void CreateSpringEffect(IDirectInputDevice8* device) {
     }
 }
 
-// Loop which kicks stuff off and coordinates everything!
-void ProcessLoop() {
-   
-    //Get some data from RawTelemetry -> not 100% sure what this does
-    RawTelemetry current{};
+// === FFB Pipeline ===
+// Reader -> compute -> output, each on its own thread (see ffb_pipeline.h)
+
+// Copy a frame out to the display, in the old all-double layout only the display wants
+static void CopyToDisplay(const RawTelemetry& current, const RawTelemetryExtras& currentExtras,
+    const CalculatedVehicleDynamics& vehicleDynamics, bool vehicleDynamicsValid) {
+    std::lock_guard<std::mutex> lock(displayMutex);
+
+    //GP2 Telemetry
+
+    // Back to the old all-double layout, only the display wants it like this
+    displayData.gp2_structSize = current.gp2_structSize;
+
+    displayData.gp2_isInRace = current.gp2_isInRace;
+    displayData.gp2_isPlayer = current.gp2_isPlayer;
+    displayData.gp2_isPaused = current.gp2_isPaused;
+    displayData.gp2_isReplay = current.gp2_isReplay;
+    displayData.gp2_isX86MenuOn = current.gp2_isX86MenuOn;
+    displayData.gp2_deviceID = current.gp2_deviceID;
+
+    displayData.gp2_speedKmh = current.gp2_speedKmh;
+    displayData.gp2_stWheelAngle = current.gp2_stWheelAngle;
+    displayData.gp2_tyreTurnAngle = current.gp2_tyreTurnAngle;
+    displayData.gp2_slipAngleFront = current.gp2_slipAngleFront;
+    displayData.gp2_slipAngleRear = current.gp2_slipAngleRear;
+
+    displayData.gp2_magLat_lf = static_cast<float>(current.gp2_magLat[CORNER_LF]);
+    displayData.gp2_magLat_rf = static_cast<float>(current.gp2_magLat[CORNER_RF]);
+
+    displayData.gp2_magLong_lf = static_cast<float>(current.gp2_magLong[CORNER_LF]);
+    displayData.gp2_magLong_rf = static_cast<float>(current.gp2_magLong[CORNER_RF]);
+
+    displayData.gp2_surfaceType_lf = current.gp2_surfaceType[CORNER_LF];
+    displayData.gp2_surfaceType_rf = current.gp2_surfaceType[CORNER_RF];
+    displayData.gp2_surfaceType_lr = current.gp2_surfaceType[CORNER_LR];
+    displayData.gp2_surfaceType_rr = current.gp2_surfaceType[CORNER_RR];
+
+    displayData.gp2_rideHeights_lf = currentExtras.gp2_rideHeights[CORNER_LF];
+    displayData.gp2_rideHeights_rf = currentExtras.gp2_rideHeights[CORNER_RF];
+    displayData.gp2_rideHeights_lr = currentExtras.gp2_rideHeights[CORNER_LR];
+    displayData.gp2_rideHeights_rr = currentExtras.gp2_rideHeights[CORNER_RR];
+
+    displayData.gp2_wheelSpin_13C_lf = currentExtras.gp2_wheelSpin_13C[CORNER_LF];
+    displayData.gp2_wheelSpin_13C_rf = currentExtras.gp2_wheelSpin_13C[CORNER_RF];
+    displayData.gp2_wheelSpin_13C_lr = currentExtras.gp2_wheelSpin_13C[CORNER_LR];
+    displayData.gp2_wheelSpin_13C_rr = currentExtras.gp2_wheelSpin_13C[CORNER_RR];
+
+    displayData.gp2_notOnDamper_lf = currentExtras.gp2_notOnDamper[CORNER_LF];
+    displayData.gp2_notOnDamper_rf = currentExtras.gp2_notOnDamper[CORNER_RF];
+    displayData.gp2_notOnDamper_lr = currentExtras.gp2_notOnDamper[CORNER_LR];
+    displayData.gp2_notOnDamper_rr = currentExtras.gp2_notOnDamper[CORNER_RR];
+
+    displayData.gp2_calc_248_lf = currentExtras.gp2_calc_248[CORNER_LF];
+    displayData.gp2_calc_248_rf = currentExtras.gp2_calc_248[CORNER_RF];
+    displayData.gp2_calc_248_lr = currentExtras.gp2_calc_248[CORNER_LR];
+    displayData.gp2_calc_248_rr = currentExtras.gp2_calc_248[CORNER_RR];
+
+    displayData.gp2_wheel_2AC_lf = currentExtras.gp2_wheel_2AC[CORNER_LF];
+    displayData.gp2_wheel_2AC_rf = currentExtras.gp2_wheel_2AC[CORNER_RF];
+    displayData.gp2_wheel_2AC_lr = currentExtras.gp2_wheel_2AC[CORNER_LR];
+    displayData.gp2_wheel_2AC_rr = currentExtras.gp2_wheel_2AC[CORNER_RR];
+
+
+    // NEW: Vehicle dynamics data (only update if calculation was successful)
+    if (vehicleDynamicsValid) {
+        displayData.vd_lateralG = vehicleDynamics.lateralG;
+        displayData.vd_directionVal = vehicleDynamics.directionVal;
+        displayData.vd_frontLeftForce_N = vehicleDynamics.frontLeftForce_N;
+        displayData.vd_frontRightForce_N = vehicleDynamics.frontRightForce_N;
+        displayData.vd_frontLeftLong_N = vehicleDynamics.frontLeftLong_N;
+        displayData.vd_frontRightLong_N = vehicleDynamics.frontRightLong_N;
+        //displayData.vd_yaw = vehicleDynamics.yaw;
+        displayData.vd_slip = vehicleDynamics.slip;
+        displayData.vd_forceMagnitude = vehicleDynamics.forceMagnitude;
+
+        // Individual tire forces
+        displayData.vd_force_lf = vehicleDynamics.force_lf;
+        displayData.vd_force_rf = vehicleDynamics.force_rf;
+        displayData.vd_force_lr = vehicleDynamics.force_lr;
+        displayData.vd_force_rr = vehicleDynamics.force_rr;
+
+        // Aggregate forces
+        displayData.vd_frontLateralForce = vehicleDynamics.frontLateralForce;
+        displayData.vd_rearLateralForce = vehicleDynamics.rearLateralForce;
+        displayData.vd_totalLateralForce = vehicleDynamics.totalLateralForce;
+        displayData.vd_yawMoment = vehicleDynamics.yawMoment;
+    }
+}
+
+// Compute stage: dynamics and the force effects for every frame the reader hands over
+// Effects only write down what they want here, the output stage does the talking to the wheel
+static void ComputeStage() {
+    ApplyThreadPolicy(L"Compute");
+
     RawTelemetry previousVD{};
     bool firstReadingVD = true;
 
-    double previousDlong = 0.0;
-    int noMovementFrames = 0;
-    const int movementThreshold = 3;  // number of frames to consider "stopped"
-    bool effectPaused = false;
-
     //Added for feedback skipping if stopped
     RawTelemetry previousPos{};
     bool firstPos = true;
 
-    static bool versionChecked = false;  // Only check once
+    DeferredEffect deferredConstant;
+    DeferredEffect deferredDamper;
+    DeferredEffect deferredSpring;
+    DeferredEffect deferredVibration;
+
+    FFBGainRamp gainRamp;
+
+    PipelineFrame frame;
+
+    // A force frame the ring had no room for. The effects' flags already say its Start/Stop went out, so it
+    // can't just be dropped - it is tried again while compute waits, and the next frame merges on top of it
+    ForceFrame heldForce;
+    bool holdingForce = false;
+    auto pushForce = [&](ForceFrame& force) {
+        if (holdingForce) {
+            heldForce.constant.Merge(force.constant);
+            heldForce.damper.Merge(force.damper);
+            heldForce.spring.Merge(force.spring);
+            heldForce.vibration.Merge(force.vibration);
+            force.constant = heldForce.constant;
+            force.damper = heldForce.damper;
+            force.spring = heldForce.spring;
+            force.vibration = heldForce.vibration;
+            force.restart = force.restart || heldForce.restart;
+            force.pollDevice = force.pollDevice || heldForce.pollDevice;
+        }
+        holdingForce = !forceRing.Push(force);
+        if (holdingForce) heldForce = force;
+        outputSignal.Notify();
+    };
 
     while (true) {
-        double currentTime = getPerformanceCounterTime();
+        WatchdogBeat(WATCHDOG_COMPUTE);
 
-        // Check to see if Telemetry is coming in, but if not then wait for it!
-        if (!ReadTelemetryData(current)) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        // The watchdog stopped everything while a thread was stuck, start the effects over
+        if (WatchdogTakeRecovery()) {
+            damperStarted = false;
+            springStarted = false;
+            StopPeriodicVibrationEffect(&deferredVibration);
+        }
+
+        if (!frameRing.Pop(frame)) {
+            if (holdingForce) {
+                holdingForce = !forceRing.Push(heldForce);
+                outputSignal.Notify();
+            }
+            computeSignal.Wait(holdingForce ? 1.0 : WatchdogIdleWaitMs());
             continue;
         }
+        computeMeter.Begin();
 
-        static int versionCheckAttempts = 0;
+        const RawTelemetry& current = frame.telemetry;
+        if (frame.restart) {
+            firstReadingVD = true;
+            firstPos = true;
+            ResetConstantForceEffect();
+        }
 
-        if (!versionChecked) {
-            if (current.gp2_structSize == 0) {
-                // Game hasn't fully initialized yet, keep waiting
-                versionCheckAttempts++;
-                if (versionCheckAttempts % 100 == 0) { // Log every ~1.5 seconds at 60fps
-                    LogMessage(L"[INFO] Waiting for x86GP2 to initialize... (attempt " + std::to_wstring(versionCheckAttempts) + L")");
+        if (firstPos) { previousPos = current; firstPos = false; }
+
+        ForceFrame force;
+        force.arrivalMs = frame.arrivalMs;
+        force.fps = current.gp2_fps;
+        force.restart = frame.restart;
+        force.state = frame.state;
+
+        // Left the race - this is the only frame until it starts again, so zero everything now
+        if (GameStateIsIdle(frame.state)) {
+            if (constantStarted) ZeroConstantForceEffect(&deferredConstant);
+            if (damperStarted) {
+                deferredDamper.Stop();
+                damperStarted = false;
+            }
+            if (springStarted) {
+                deferredSpring.Stop();
+                springStarted = false;
+            }
+            StopPeriodicVibrationEffect(&deferredVibration);
+
+            force.constant = deferredConstant.Take();
+            force.damper = deferredDamper.Take();
+            force.spring = deferredSpring.Take();
+            force.vibration = deferredVibration.Take();
+            pushForce(force);
+
+            computeMeter.End();
+            continue;
+        }
+
+        // Start damper/spring effects once telemetry is valid, and again each time racing resumes
+        // Also need to maybe fade in and out the effects when waking/sleeping
+        if (!damperStarted && damperEffect && enableDamperEffect) {
+            deferredDamper.Start(1, 0);
+            damperStarted = true;
+            LogMessage(L"[INFO] Damper effect started");
+        }
+
+        if (!springStarted && springEffect && enableSpringEffect) {
+            deferredSpring.Start(1, 0);
+            springStarted = true;
+            LogMessage(L"[INFO] Spring effect started");
+        }
+
+        // Master force scale -> Keeping Hands Safe
+        // Already checked and clamped in the settings snapshot, a saved ffb.ini blends in over FFB_CONFIG_RAMP_MS
+        const FFBGains& gains = gainRamp.Update(*GetFFBConfig(), frame.arrivalMs);
+        double masterForceScale = gains.master;
+        double deadzoneForceScale = gains.deadzone;
+        double constantForceScale = gains.constant;
+        double vibrationForceScale = gains.vibration;
+        double brakingForceScale = gains.braking;
+        double weightForceScale = gains.weight;
+        double damperForceScale = gains.damper;
+
+        // Update Effects
+        if (damperEffect && enableDamperEffect)
+            UpdateDamperEffect(current.gp2_speedKmh, &deferredDamper, masterForceScale, damperForceScale);
+
+        if (springEffect && enableSpringEffect)
+            UpdateSpringEffect(&deferredSpring, masterForceScale * gains.spring);
+
+
+        CalculatedVehicleDynamics vehicleDynamics{};
+        bool vehicleDynamicsValid = CalculateVehicleDynamics(current, previousVD, firstReadingVD, vehicleDynamics);
+
+        if (vehicleDynamicsValid) {
+            force.pollDevice = true;
+
+            // Start constant force once telemetry is valid 
+            if (enableConstantForce && constantForceEffect) {
+                if (!constantStarted) {
+                    deferredConstant.Start(1, 0);
+                    constantStarted = true;
+                    LogMessage(L"[INFO] Constant force started");
                 }
-                continue; // Skip to next loop iteration
+
+                //This is what will add the "Constant Force" effect if all the calculations work. 
+                // Probably could smooth all this out
+                ApplyConstantForceEffect(current,
+                    vehicleDynamics, current.gp2_speedKmh, &deferredConstant, enableVibrationForce, enableWeightForce, enableRateLimit,
+                    masterForceScale, deadzoneForceScale,
+                    constantForceScale, vibrationForceScale, brakingForceScale, weightForceScale, gains.direction);
+
             }
-            else if (current.gp2_structSize != 2720) {
-                LogMessage(L"[ERROR] Wrong version of x86GP2 detected");
-                LogMessage(L"[ERROR] Expected struct size: 2720, Got: " + std::to_wstring(current.gp2_structSize));
-                LogMessage(L"[ERROR] This is the wrong version of x86GP2, please update and try again.");
-                std::cin.get();
-                exit(1);
+
+            //create kerb effects
+            if (enableVibrationForce && periodicVibrationEffect) {
+                ApplyPeriodicVibrationEffect(current, &deferredVibration, enableVibrationForce, masterForceScale, vibrationForceScale);
             }
-            else {
-                // Valid version detected
-                versionChecked = true;
-                LogMessage(L"[INFO] x86GP2 version check passed - struct size: " + std::to_wstring(current.gp2_structSize));
-                LogMessage(L"[INFO] Version check completed after " + std::to_wstring(versionCheckAttempts) + L" attempts");
+
+
+            //Setting variables for next update
+            currentSpeed = current.gp2_speedKmh;
+
+            // Update telemetry for display, on the frames the reader decoded the display's fields for
+            if (frame.hasDisplayFields) {
+                CopyToDisplay(current, frame.extras, vehicleDynamics, vehicleDynamicsValid);
             }
         }
 
+        force.constant = deferredConstant.Take();
+        force.damper = deferredDamper.Take();
+        force.spring = deferredSpring.Take();
+        force.vibration = deferredVibration.Take();
+        pushForce(force);
 
-        if (currentTime >= FFBTime) {
+        computeMeter.End();
+    }
+}
+
+// Live, a tick's commands go to the device I/O thread
+class DeviceIOSink : public FFBOutputSink {
+public:
+    void PostEffect(DeviceEffectSlot slot, const EffectCommand& command) override { PostEffectCommand(slot, command); }
+    void PostPoll() override { PostDevicePoll(); }
+};
 
-            if (firstPos) { previousPos = current; firstPos = false; }
+// Output stage: the FFB tick. The thread and its timing, ffb_output.cpp decides what goes to the wheel
+// and device_io.cpp does the sending
+static void OutputStage() {
+    ApplyThreadPolicy(L"Output");
+
+    // Output rate from ffb.ini - above the game's ~60fps the constant force is upsampled between frames
+    const FFBConfig config = *GetFFBConfig();
+    EffectUpdateGate* gates[DEVICE_EFFECT_COUNT] = {};
+    gates[DEVICE_EFFECT_CONSTANT] = &constantGate;
+    gates[DEVICE_EFFECT_DAMPER] = &damperGate;
+    gates[DEVICE_EFFECT_SPRING] = &springGate;
+    gates[DEVICE_EFFECT_VIBRATION] = &vibrationGate;
+    DeviceIOSink sink;
+    FFBOutput output(1000.0 / config.updateRateHz, config.upsampling, config.upsamplingPredict, constantForceEffect != nullptr,
+        gates, sink);
+
+    LogMessage(L"[INFO] FFB output at " + std::to_wstring(static_cast<int>(config.updateRateHz + 0.5)) + L" Hz, upsampling " +
+        UpsampleModeName(output.Upsampler().Mode()) + (output.Upsampler().Predicting() ? L" (predict)" : L""));
+    LogMessage(L"[INFO] Effect updates: constant " + std::wstring(EffectUpdateModeName(constantGate.Policy().mode)) +
+        L", damper " + EffectUpdateModeName(damperGate.Policy().mode) + L", spring " + EffectUpdateModeName(springGate.Policy().mode) +
+        L", vibration " + EffectUpdateModeName(vibrationGate.Policy().mode));
+
+    // FFB ticks on absolute deadlines, late ticks skip ahead instead of bursting
+    FFBTickScheduler& ffbScheduler = output.Scheduler();
+    ffbScheduler.AlignTo(getPerformanceCounterTime());
+    double displayCopyTime = 0.0;
+
+    ForceFrame force;
 
+    while (true) {
+        WatchdogBeat(WATCHDOG_OUTPUT);
+        double currentTime = getPerformanceCounterTime();
 
-            // Start damper/spring effects once telemetry is valid
-            // Probably need to also figure out how to stop these when the game pauses
-            // Also need to maybe fade in and out the effects when waking/sleeping
-            if (!damperStarted && damperEffect && enableDamperEffect) {
-                damperEffect->Start(1, 0);
-                damperStarted = true;
-                LogMessage(L"[INFO] Damper effect started");
+        if (ffbScheduler.Due(currentTime)) {
+            outputMeter.Begin();
+
+            while (forceRing.Pop(force)) output.FrameArrived(force);
+
+            // Hand it all to the device I/O thread, this tick doesn't wait for the wheel
+            int frames = output.Tick(currentTime, WatchdogTripped());
+            if (frames == 0) {
+                if (!GameStateIsIdle(output.State())) g_duplicateFrames++;
+            }
+            else if (frames > 1) {
+                g_coalescedFrames += frames - 1;
             }
 
-            if (!springStarted && springEffect && enableSpringEffect) {
-                springEffect->Start(1, 0);
-                springStarted = true;
-                LogMessage(L"[INFO] Spring effect started");
+            if (currentTime >= displayCopyTime) {
+                displayCopyTime = currentTime + PRINT_INTERVAL;
+                FFBSchedulerStats tickStats = ffbScheduler.Stats();
+                const FramePhaseLock& frameLock = output.FrameLock();
+                OutputStageFigures figures;
+                figures.jitterP50Ms = tickStats.jitterP50Ms;
+                figures.jitterP99Ms = tickStats.jitterP99Ms;
+                figures.overruns = tickStats.overruns;
+                figures.wakeLateP99Ms = tickStats.wakeLateP99Ms;
+                figures.preemptions = tickStats.preemptions;
+                figures.frameLocked = frameLock.Locked();
+                figures.framePeriodMs = frameLock.PeriodMs();
+                figures.frameLockErrorMs = frameLock.LockErrorMs();
+                outputFigures.Store(figures);
             }
 
-            // Master force scale -> Keeping Hands Safe
-            double masterForceValue = std::stod(targetForceSetting);
-            double masterForceScale = std::clamp(masterForceValue / 100.0, 0.0, 1.0);
+            outputMeter.End();
+        }
+
+        // Out of a race there is nothing to tick for, sleep until compute sends something
+        if (GameStateIsIdle(output.State())) {
+            outputSignal.Wait(std::min(GAME_IDLE_POLL_MS, WatchdogIdleWaitMs()));
+            ffbScheduler.Restart(getPerformanceCounterTime());
+            continue;
+        }
 
-            double deadzoneForceValue = std::stod(targetDeadzoneSetting);
-            double deadzoneForceScale = std::clamp(deadzoneForceValue / 100.0, 0.0, 1.0);
+        // Sleep until the next tick is nearly due, then spin onto the deadline
+        double untilTick = ffbScheduler.MsUntilDue(getPerformanceCounterTime());
+        if (untilTick > FFB_SPIN_MS) {
+            PreciseSleepMs(untilTick - FFB_SPIN_MS);
+        }
+        else {
+            ffbScheduler.SpinUntilDue();
+        }
+    }
+}
 
-            double constantForceValue = std::stod(targetConstantScale);
-            double constantForceScale = std::clamp(constantForceValue / 100.0, 0.0, 1.0);
+// Idle states reach compute as a single frame when they are entered, it zeroes the forces on that one
+static bool PushIdleFrame(PipelineFrame& frame, const RawTelemetry& telemetry, GameState state, double nowMs) {
+    frame.telemetry = telemetry;
+    frame.hasDisplayFields = false;
+    frame.restart = false;
+    frame.state = state;
+    frame.arrivalMs = nowMs;
+    if (!frameRing.Push(frame)) return false;
+    computeSignal.Notify();
+    return true;
+}
 
-            double vibrationForceValue = std::stod(targetVibrationScale);
-            double vibrationForceScale = std::clamp(vibrationForceValue / 100.0, 0.0, 1.0);
+// Loop which kicks stuff off and coordinates everything!
+// This thread is the reader stage: it watches for x86GP2's frames and hands each new one to compute
+void ProcessLoop() {
+    ApplyThreadPolicy(L"Reader");
+   
+    //Get some data from RawTelemetry -> not 100% sure what this does
+    RawTelemetry current{};
+    RawTelemetryExtras currentExtras{};
 
-            double brakingForceValue = std::stod(targetBrakingScale);
-            double brakingForceScale = brakingForceValue;
+    static bool versionChecked = false;  // Only check once per attach
+    static int versionCheckAttempts = 0;
+    unsigned long long lastAttachCount = 0;
+    bool restartPending = true;
+    bool idleFramePending = false;  // entered an idle state, compute hasn't been told yet
 
-            double weightForceValue = std::stod(targetWeightScale);
-            double weightForceScale = std::clamp(weightForceValue / 100.0, 0.0, 1.0);
+    // Frame identity tracking
+    unsigned long long lastReadHash = 0;
+    unsigned long long lastFrameHash = 0;
+    double lastFreshFrameTime = 0.0;
+    bool firstFrameSeen = false;
 
-            double damperForceValue = std::stod(targetDamperScale);
-            double damperForceScale = std::clamp(damperForceValue / 100.0, 0.0, 1.0);
+    // Only decode what the enabled effects read, the display adds its fields when it is due
+    unsigned int forceFields = TELEM_STATE | VEHICLE_DYNAMICS_FIELDS;
+    if (enableConstantForce) forceFields |= CONSTANT_FORCE_FIELDS;
+    if (enableVibrationForce) forceFields |= VIBRATION_FIELDS;
+    if (enableDamperEffect) forceFields |= DAMPER_FIELDS;
+    if (enableSpringEffect) forceFields |= SPRING_FIELDS;
+    double displayCopyTime = 0.0;
 
-            // Update Effects
-            if (damperEffect && enableDamperEffect)
-                UpdateDamperEffect(current.gp2_speedKmh, damperEffect, masterForceScale, damperForceScale);
+    LogMessage(L"[INFO] Telemetry frame is " + std::to_wstring(sizeof(RawTelemetry)) +
+        L" bytes, display extras " + std::to_wstring(sizeof(RawTelemetryExtras)) + L" bytes");
 
-            if (springEffect && enableSpringEffect)
-                UpdateSpringEffect(springEffect, masterForceScale);
+    // Block on the game's frame signal if it has one, otherwise poll around when frames are due
+    InitTelemetryWakeup();
 
+    std::thread computeThread(ComputeStage);
+    computeThread.detach();
+    std::thread outputThread(OutputStage);
+    outputThread.detach();
 
-            CalculatedVehicleDynamics vehicleDynamics{};
-            bool vehicleDynamicsValid = CalculateVehicleDynamics(current, previousVD, firstReadingVD, vehicleDynamics);
+    PipelineFrame frame;
 
+    while (true) {
+        WatchdogBeat(WATCHDOG_READER);
+        readerMeter.Begin();
+        double currentTime = getPerformanceCounterTime();
+        bool displayDue = currentTime >= displayCopyTime;
 
-        if (vehicleDynamicsValid) {
-            if (FAILED(matchedDevice->Poll())) {
-                    matchedDevice->Acquire();
-                    matchedDevice->Poll();
-                }
-                matchedDevice->GetDeviceState(sizeof(DIJOYSTATE2), &js);
-
-                // Start constant force once telemetry is valid 
-                if (enableConstantForce && constantForceEffect) {
-                    if (!constantStarted) {
-                        constantForceEffect->Start(1, 0);
-                        constantStarted = true;
-                        LogMessage(L"[INFO] Constant force started");
-                    }
-
-                    //This is what will add the "Constant Force" effect if all the calculations work. 
-                    // Probably could smooth all this out
-                    ApplyConstantForceEffect(current,
-                        vehicleDynamics, current.gp2_speedKmh, constantForceEffect, enableVibrationForce, enableWeightForce, enableRateLimit,
-                        masterForceScale, deadzoneForceScale,
-                        constantForceScale, vibrationForceScale, brakingForceScale, weightForceScale);
+        // Out of a race only the state flags are read, to see when one starts
+        bool wasIdle = GameStateIsIdle(gameStateMachine.State());
+        unsigned int fields = wasIdle ? TELEM_STATE : forceFields;
+        if (displayDue && !wasIdle) fields |= DISPLAY_FIELDS;
 
-                }
+        // Check to see if Telemetry is coming in, but if not then wait for it!
+        if (!ReadTelemetryData(current, fields, &currentExtras)) {
+            // Game not running - sleep until the reader's next attach attempt (but stay responsive)
+            if (gameStateMachine.Update(GameState::Detached, currentTime)) idleFramePending = true;
+            if (idleFramePending && PushIdleFrame(frame, current, GameState::Detached, currentTime)) idleFramePending = false;
+            readerMeter.End();
+            double retryMs = std::clamp(GetTelemetryAttachRetryMs(), 1.0, WatchdogIdleWaitMs());
+            std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int>(retryMs)));
+            continue;
+        }
+
+        // The game was restarted - it could be a different build, and the old frames mean nothing now
+        unsigned long long attaches = GetTelemetryAttachStats().attaches;
+        if (attaches != lastAttachCount) {
+            if (lastAttachCount != 0) {
+                LogMessage(L"[INFO] Reattached to x86GP2, checking the version again");
+            }
+            lastAttachCount = attaches;
+            versionChecked = false;
+            versionCheckAttempts = 0;
+            firstFrameSeen = false;
+            restartPending = true;
+        }
+
+        bool newFrame = firstFrameSeen ? (current.frameHash != lastFrameHash) : true;
 
-                //create kerb effects
-                if (enableVibrationForce && periodicVibrationEffect) {
-                    ApplyPeriodicVibrationEffect(current, periodicVibrationEffect, enableVibrationForce, masterForceScale, vibrationForceScale);
+        if (!versionChecked) {
+            if (current.gp2_structSize == 0) {
+                // Game hasn't fully initialized yet, keep waiting
+                versionCheckAttempts++;
+                if (versionCheckAttempts % 100 == 0) { // Log every ~1.5 seconds at 60fps
+                    LogMessage(L"[INFO] Waiting for x86GP2 to initialize... (attempt " + std::to_wstring(versionCheckAttempts) + L")");
+                }
+                newFrame = false; // Skip to the next frame
+            }
+            else if (FindTelemetryLayout(current.gp2_structSize) < 0) {
+                std::wstring supportedSizes;
+                for (const TelemetryLayout& layout : telemetryLayouts) {
+                    if (!supportedSizes.empty()) supportedSizes += L", ";
+                    supportedSizes += std::to_wstring(layout.structSize);
                 }
+                LogMessage(L"[ERROR] Wrong version of x86GP2 detected");
+                LogMessage(L"[ERROR] Expected struct size: " + supportedSizes + L", Got: " + std::to_wstring(current.gp2_structSize));
+                LogMessage(L"[ERROR] This is the wrong version of x86GP2, please update and try again.");
+                std::cin.get();
+                exit(1);
+            }
+            else {
+                // Valid version detected
+                versionChecked = true;
+                LogMessage(L"[INFO] x86GP2 version check passed - struct size: " + std::to_wstring(current.gp2_structSize));
+                LogMessage(L"[INFO] Version check completed after " + std::to_wstring(versionCheckAttempts) + L" attempts");
+            }
+        }
+
+        // Racing or not? Leaving a race zeroes the forces once, coming back starts the effects over
+        if (versionChecked && gameStateMachine.Update(ClassifyGameState(current), currentTime)) {
+            if (GameStateIsIdle(gameStateMachine.State())) {
+                idleFramePending = true;
+            }
+            else {
+                idleFramePending = false;
+                restartPending = true;
+            }
+        }
+
+        if (GameStateIsIdle(gameStateMachine.State())) {
+            if (idleFramePending && PushIdleFrame(frame, current, gameStateMachine.State(), currentTime)) idleFramePending = false;
+            readerMeter.End();
+            std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int>(std::min(GAME_IDLE_POLL_MS, WatchdogIdleWaitMs()))));
+            continue;
+        }
 
+        // Just started racing off a state-only read, go straight round for a full one
+        if (wasIdle) {
+            readerMeter.End();
+            continue;
+        }
 
-                //Setting variables for next update
-                currentSpeed = current.gp2_speedKmh;
-
-
-                // Update telemetry for display
-                {
-                    std::lock_guard<std::mutex> lock(displayMutex);
-
-                    //GP2 Telemetry
-
-                    displayData.gp2_isInRace = current.gp2_structSize;
-
-
-                    displayData.gp2_isInRace = current.gp2_isInRace;
-                    displayData.gp2_isPlayer = current.gp2_isPlayer;
-                    displayData.gp2_isPaused = current.gp2_isPaused;
-                    displayData.gp2_isReplay = current.gp2_isReplay;
-                    displayData.gp2_isX86MenuOn = current.gp2_isX86MenuOn;
-                    displayData.gp2_deviceID = current.gp2_deviceID;
-
-                    displayData.gp2_speedKmh = current.gp2_speedKmh;
-                    displayData.gp2_stWheelAngle = current.gp2_stWheelAngle;
-                    displayData.gp2_tyreTurnAngle = current.gp2_tyreTurnAngle;
-                    displayData.gp2_slipAngleFront = current.gp2_slipAngleFront;
-                    displayData.gp2_slipAngleRear = current.gp2_slipAngleRear;
-
-                    displayData.gp2_magLat_lf = current.gp2_magLat_lf;
-                    displayData.gp2_magLat_rf = current.gp2_magLat_rf;
-
-                    displayData.gp2_magLong_lf = current.gp2_magLong_lf;
-                    displayData.gp2_magLong_rf = current.gp2_magLong_rf;
-
-                    displayData.gp2_surfaceType_lf = current.gp2_surfaceType_lf;
-                    displayData.gp2_surfaceType_rf = current.gp2_surfaceType_rf;
-                    displayData.gp2_surfaceType_lr = current.gp2_surfaceType_lr;
-                    displayData.gp2_surfaceType_rr = current.gp2_surfaceType_rr;
-
-                    displayData.gp2_rideHeights_lf = current.gp2_rideHeights_lf;
-                    displayData.gp2_rideHeights_rf = current.gp2_rideHeights_rf;
-                    displayData.gp2_rideHeights_lr = current.gp2_rideHeights_lr;
-                    displayData.gp2_rideHeights_rr = current.gp2_rideHeights_rr;
-
-                    displayData.gp2_wheelSpin_13C_lf = current.gp2_wheelSpin_13C_lf;
-                    displayData.gp2_wheelSpin_13C_rf = current.gp2_wheelSpin_13C_rf;
-                    displayData.gp2_wheelSpin_13C_lr = current.gp2_wheelSpin_13C_lr;
-                    displayData.gp2_wheelSpin_13C_rr = current.gp2_wheelSpin_13C_rr;
-
-                    displayData.gp2_notOnDamper_lf = current.gp2_notOnDamper_lf;
-                    displayData.gp2_notOnDamper_rf = current.gp2_notOnDamper_rf;
-                    displayData.gp2_notOnDamper_lr = current.gp2_notOnDamper_lr;
-                    displayData.gp2_notOnDamper_rr = current.gp2_notOnDamper_rr;
-
-                    displayData.gp2_calc_248_lf = current.gp2_calc_248_lf;
-                    displayData.gp2_calc_248_rf = current.gp2_calc_248_rf;
-                    displayData.gp2_calc_248_lr = current.gp2_calc_248_lr;
-                    displayData.gp2_calc_248_rr = current.gp2_calc_248_rr;
-
-                    displayData.gp2_wheel_2AC_lf = current.gp2_wheel_2AC_lf;
-                    displayData.gp2_wheel_2AC_rf = current.gp2_wheel_2AC_rf;
-                    displayData.gp2_wheel_2AC_lr = current.gp2_wheel_2AC_lr;
-                    displayData.gp2_wheel_2AC_rr = current.gp2_wheel_2AC_rr;
-
-
-                    // NEW: Vehicle dynamics data (only update if calculation was successful)
-                    if (vehicleDynamicsValid) {
-                        displayData.vd_lateralG = vehicleDynamics.lateralG;
-                        displayData.vd_directionVal = vehicleDynamics.directionVal;
-                        displayData.vd_frontLeftForce_N = vehicleDynamics.frontLeftForce_N;
-                        displayData.vd_frontRightForce_N = vehicleDynamics.frontRightForce_N;
-                        displayData.vd_frontLeftLong_N = vehicleDynamics.frontLeftLong_N;
-                        displayData.vd_frontRightLong_N = vehicleDynamics.frontRightLong_N;
-                        //displayData.vd_yaw = vehicleDynamics.yaw;
-                        displayData.vd_slip = vehicleDynamics.slip;
-                        displayData.vd_forceMagnitude = vehicleDynamics.forceMagnitude;
-
-                        // Individual tire forces
-                        displayData.vd_force_lf = vehicleDynamics.force_lf;
-                        displayData.vd_force_rf = vehicleDynamics.force_rf;
-                        displayData.vd_force_lr = vehicleDynamics.force_lr;
-                        displayData.vd_force_rr = vehicleDynamics.force_rr;
-
-                        // Aggregate forces
-                        displayData.vd_frontLateralForce = vehicleDynamics.frontLateralForce;
-                        displayData.vd_rearLateralForce = vehicleDynamics.rearLateralForce;
-                        displayData.vd_totalLateralForce = vehicleDynamics.totalLateralForce;
-                        displayData.vd_yawMoment = vehicleDynamics.yawMoment;
-                    }
+        // Let the waiter learn when frames turn up
+        NotifyTelemetryPoll(current.frameHash != lastReadHash);
+        lastReadHash = current.frameHash;
+
+        // Has the game published a new frame since the last one we passed on?
+        // If not there is nothing to compute - the frame-counted smoothing (magnitude history, input EMA)
+        // would only advance on stale data
+        if (newFrame) {
+            if (firstFrameSeen && current.gp2_fps > 1.0 && !current.gp2_isPaused) {
+                // Work out how many game frames went by since the last one we used
+                double gameFramePeriod = 1000.0 / current.gp2_fps;
+                int framesElapsed = static_cast<int>((currentTime - lastFreshFrameTime) / gameFramePeriod + 0.5);
+                if (framesElapsed > 1 && framesElapsed <= MAX_MISSED_FRAMES_PER_GAP) {
+                    g_missedFrames += framesElapsed - 1;
                 }
             }
-            FFBTime += FFB_INTERVAL;
+            g_freshFrames++;
+            lastFrameHash = current.frameHash;
+            lastFreshFrameTime = currentTime;
+            firstFrameSeen = true;
+
+            frame.telemetry = current;
+            frame.hasDisplayFields = displayDue;
+            if (displayDue) {
+                frame.extras = currentExtras;
+                displayCopyTime = currentTime + PRINT_INTERVAL;
+            }
+            frame.restart = restartPending;
+            frame.state = GameState::Racing;
+            frame.arrivalMs = currentTime;
+            if (frameRing.Push(frame)) {
+                restartPending = false;
+                computeSignal.Notify();
+            }
         }
+        readerMeter.End();
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        // Sleep until the next game frame turns up
+        WaitForTelemetryFrame(std::min(READER_WAIT_MS, WatchdogIdleWaitMs()));
     }
 }
 
+// What the control channel's stats/get answer with (control_channel.h), on its own thread
+static void CollectControlMetrics(std::vector<ControlMetric>& metrics) {
+    // This runs at idle priority: nothing here takes a lock a FFB thread holds for longer than a shared_ptr copy
+    OutputStageFigures output = outputFigures.Load();
+    GameStateStats stateStats = gameStateMachine.Stats(getPerformanceCounterTime());
+    // Busy share since the previous request
+    static PipelineStageStats lastReaderStats, lastComputeStats, lastOutputStats;
+    PipelineStageStats readerStats = readerMeter.Stats();
+    PipelineStageStats computeStats = computeMeter.Stats();
+    PipelineStageStats outputStats = outputMeter.Stats();
+    DeviceIOStats ioStats = GetDeviceIOStats();
+    WatchdogStats watchdogStats = GetWatchdogStats();
+    LoggerStats loggerStats = GetLoggerStats();
+
+    metrics.push_back({ "game_state", static_cast<double>(stateStats.state) });
+    metrics.push_back({ "game_idle_share", stateStats.idleShare });
+    metrics.push_back({ "speed_kmh", currentSpeed.load() });
+    metrics.push_back({ "force_magnitude", static_cast<double>(g_currentFFBForce.load(std::memory_order_relaxed)) });
+    std::shared_ptr<const FFBConfig> config = GetFFBConfig();
+    metrics.push_back({ "force_percent", config->masterScale * 100.0 });
+    metrics.push_back({ "config_version", static_cast<double>(config->version) });
+    metrics.push_back({ "frames_fresh", static_cast<double>(g_freshFrames.load()) });
+    metrics.push_back({ "frames_duplicate", static_cast<double>(g_duplicateFrames.load()) });
+    metrics.push_back({ "frames_missed", static_cast<double>(g_missedFrames.load()) });
+    metrics.push_back({ "frames_coalesced", static_cast<double>(g_coalescedFrames.load()) });
+    metrics.push_back({ "tick_jitter_p50_ms", output.jitterP50Ms });
+    metrics.push_back({ "tick_jitter_p99_ms", output.jitterP99Ms });
+    metrics.push_back({ "tick_overruns", static_cast<double>(output.overruns) });
+    metrics.push_back({ "tick_wake_late_p99_ms", output.wakeLateP99Ms });
+    metrics.push_back({ "tick_preemptions", static_cast<double>(output.preemptions) });
+    metrics.push_back({ "frame_locked", output.frameLocked ? 1.0 : 0.0 });
+    metrics.push_back({ "frame_fps", output.framePeriodMs > 0.0 ? 1000.0 / output.framePeriodMs : 0.0 });
+    metrics.push_back({ "pipeline_read_busy", readerStats.Occupancy(lastReaderStats) });
+    metrics.push_back({ "pipeline_compute_busy", computeStats.Occupancy(lastComputeStats) });
+    metrics.push_back({ "pipeline_output_busy", outputStats.Occupancy(lastOutputStats) });
+    metrics.push_back({ "queue_frames_dropped", static_cast<double>(frameRing.Dropped()) });
+    metrics.push_back({ "queue_forces_dropped", static_cast<double>(forceRing.Dropped()) });
+    metrics.push_back({ "sent_constant", static_cast<double>(constantGate.Sent()) });
+    metrics.push_back({ "sent_damper", static_cast<double>(damperGate.Sent()) });
+    metrics.push_back({ "sent_spring", static_cast<double>(springGate.Sent()) });
+    metrics.push_back({ "sent_vibration", static_cast<double>(vibrationGate.Sent()) });
+    metrics.push_back({ "device_io_sent", static_cast<double>(ioStats.total.sent) });
+    metrics.push_back({ "device_io_failed", static_cast<double>(ioStats.total.failed) });
+    metrics.push_back({ "device_io_slowest_ms", ioStats.maxCallMs });
+    metrics.push_back({ "watchdog_stalls", static_cast<double>(watchdogStats.stalls) });
+    metrics.push_back({ "watchdog_longest_ms", watchdogStats.longestStallMs });
+    metrics.push_back({ "watchdog_tripped", watchdogStats.tripped ? 1.0 : 0.0 });
+    metrics.push_back({ "log_written", static_cast<double>(loggerStats.written) });
+    metrics.push_back({ "log_dropped", static_cast<double>(loggerStats.dropped) });
+    metrics.push_back({ "log_truncated", static_cast<double>(loggerStats.truncated) });
+
+    lastReaderStats = readerStats;
+    lastComputeStats = computeStats;
+    lastOutputStats = outputStats;
+}
+
 // Where it all happens
 int main() {
 
@@ -985,12 +1289,8 @@ int main() {
     HideConsoleCursor();
     DisableConsoleQuickEdit();
 
-    //timing
-    QueryPerformanceFrequency(&frequency);
-    QueryPerformanceCounter(&start);
-
-    //clear last log
-    std::wofstream clearLog("log.txt", std::ios::trunc);
+    //clear last log and start writing the new one (logger.h)
+    StartLogger();
 
 
     // Load FFB configuration file "ffb.ini"
@@ -1007,6 +1307,7 @@ int main() {
     }
 
     LogMessage(L"[INFO] Successfully loaded FFB settings");
+    SetLogFormat(GetFFBConfig()->logFormat);
     LogMessage(L"[INFO] Target device: " + targetDeviceName);
 
     // Initialize DirectInput device
@@ -1070,12 +1371,13 @@ int main() {
 
     // Parse FFB effect toggles from config <- should all ffb types be enabled? Allows user to select if they dont like damper for instance
     // Would be nice to add a % per effect in the future
-    enableRateLimit = (targetWeightEnabled == L"true" || targetWeightEnabled == L"True");
-    enableConstantForce = (targetConstantEnabled == L"true" || targetConstantEnabled == L"True");
-    enableWeightForce = (targetWeightEnabled == L"true" || targetWeightEnabled == L"True");
-    enableVibrationForce = (targetVibrationEnabled == L"true" || targetVibrationEnabled == L"True");
-    enableDamperEffect = (targetDamperEnabled == L"true" || targetDamperEnabled == L"True");
-    enableSpringEffect = (targetSpringEnabled == L"true" || targetSpringEnabled == L"True");
+    const FFBConfig config = *GetFFBConfig();
+    enableRateLimit = config.weightEnabled;
+    enableConstantForce = config.constantEnabled;
+    enableWeightForce = config.weightEnabled;
+    enableVibrationForce = config.vibrationEnabled;
+    enableDamperEffect = config.damperEnabled;
+    enableSpringEffect = config.springEnabled;
 
     // Create FFB effects as needed
     if (enableConstantForce) CreateConstantForceEffect(matchedDevice);
@@ -1085,57 +1387,63 @@ int main() {
         CreatePeriodicVibrationEffect(matchedDevice, &periodicVibrationEffect);
     }
 
-    // This is to control the max % for any of the FFB effects as specified in the ffb.ini
-    // Prevents broken wrists (hopefully)
-    double masterForceValue = std::stod(targetForceSetting);
-    double constantForceValue = std::stod(targetConstantScale);
-    double weightForceValue = std::stod(targetWeightScale);
-    double vibrationForceValue = std::stod(targetVibrationScale);
-    double damperForceValue = std::stod(targetDamperScale);
+    // Optional raw telemetry recording for replay/tuning
+    if (config.recordEnabled) {
+        if (StartTelemetryRecording(config.recordFile)) {
+            SetConsoleCtrlHandler(ConsoleCloseHandler, TRUE);
+        }
+    }
+
+    // Priority and CPUs for the FFB threads, each one applies it as it starts
+    SetThreadPolicy(ParseThreadPolicy(targetThreadPriority, targetRealtimePriority, targetThreadAffinity));
+    LogMessage(L"[INFO] FFB thread policy: " + DescribeThreadPolicy(GetThreadPolicy()));
+
+    // Zero the forces if any FFB thread hangs
+    StartWatchdog(config.watchdogTimeoutMs);
+
+    // From here on only the device I/O thread talks to the wheel
+    IDirectInputEffect* deviceEffects[DEVICE_EFFECT_COUNT] = { constantForceEffect, damperEffect, springEffect, periodicVibrationEffect };
+    StartDeviceIO(matchedDevice, deviceEffects);
 
     // Start telemetry processing!
     std::thread processThread(ProcessLoop);
     processThread.detach();
 
+    // Pick up changes to the gains without a restart
+    StartFFBConfigWatcher(L"ffb.ini");
+    if (config.controlChannel) StartControlChannel(CollectControlMetrics);
+
     // Now that we're doing everything we can display stuff!
     // Main Display Loop - Set to 200ms? Probably fine
-    // Flickers a lot right now but perhaps moving to a GUI will solve that eventually
+    // Only the cells that changed are redrawn (console_screen.h), so no more flicker
+    static ConsoleScreen screen;
+    std::vector<std::wstring> recentUniqueLines;
     while (true) {
         double currentTime = getPerformanceCounterTime();
 
         if (currentTime >= printTime) {
-            // make sure we stay at most recent display update
-            MoveCursorToLine(0);
+            screen.Begin();
 
             //Trigger display
             {
                 std::lock_guard<std::mutex> lock(displayMutex);
-                DisplayTelemetry(displayData, masterForceValue);
+                DisplayTelemetry(screen, displayData, GetFFBConfig()->masterScale * 100.0);
             }
 
             //Print log data
             {
-                std::lock_guard<std::mutex> lock(logMutex);
                 size_t maxDisplayLines = 1; //how many lines to display
-                std::vector<std::wstring> recentUniqueLines;
-                std::unordered_set<std::wstring> seen;
-
-                // Go backward to find most recent unique messages
-                for (auto it = logLines.rbegin(); it != logLines.rend() && recentUniqueLines.size() < maxDisplayLines; ++it) {
-                    if (seen.insert(*it).second) {
-                        recentUniqueLines.push_back(*it);
-                    }
-                }
 
-                // Reverse to show most recent at bottom
-                std::reverse(recentUniqueLines.begin(), recentUniqueLines.end());
+                // Most recent unique messages, most recent at bottom
+                RecentLogLines(maxDisplayLines, recentUniqueLines);
 
                 for (const auto& line : recentUniqueLines) {
-                    std::wstring padded = line;
-                    padded.resize(80, L' ');  // pad to 80 characters to clear old line leftovers
-                    std::wcout << padded << L"\n";
+                    screen.Print(L"%ls", line.c_str());
                 }
             }
+
+            // Outside displayMutex, the compute thread never waits on the console
+            screen.Present();
             printTime = currentTime + PRINT_INTERVAL;
         }
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
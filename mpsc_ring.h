@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <stddef.h>
+#include "spsc_ring.h"
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// Multi producer / single consumer ring buffer
+// Any number of threads push, one thread pops, no locks. Each slot carries a sequence number that says
+// whether it is free for the push at that position or holds an item for the pop there (Vyukov's bounded queue),
+// so producers only contend on the one compare-exchange that claims a position.
+// A full ring refuses the push (counted in Dropped) rather than blocking the producer - same as SpscRing.
+//
+// Push fills the slot in place, so a big T isn't built on the producer's stack and copied over.
+// A producer that has claimed a slot but not filled it yet holds up the pop, never the other producers.
+
+template <typename T, size_t Capacity>
+class MpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "MpscRing capacity must be a power of two");
+
+public:
+    MpscRing() {
+        for (size_t i = 0; i < Capacity; i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // Any thread. fill(T&) writes the item straight into the claimed slot
+    template <typename Fill>
+    bool Push(Fill fill) {
+        size_t position = head.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots[position & (Capacity - 1)];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            ptrdiff_t diff = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(position);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0) {
+                // The consumer hasn't freed this slot from the last lap yet
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else {
+                position = head.load(std::memory_order_relaxed);
+            }
+        }
+        fill(slot->item);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only
+    bool Pop(T& item) {
+        Slot& slot = slots[tail & (Capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != tail + 1) return false;
+        item = slot.item;
+        slot.sequence.store(tail + Capacity, std::memory_order_release);
+        tail++;
+        return true;
+    }
+
+    unsigned long long Dropped() const { return dropped.load(std::memory_order_relaxed); }
+    static constexpr size_t Size() { return Capacity; }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+    alignas(SPSC_CACHE_LINE) std::atomic<size_t> head{ 0 };
+    alignas(SPSC_CACHE_LINE) size_t tail = 0;   // consumer only
+    alignas(SPSC_CACHE_LINE) std::atomic<unsigned long long> dropped{ 0 };
+    alignas(SPSC_CACHE_LINE) Slot slots[Capacity];
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <stddef.h>
+#include <string.h>
+#include <type_traits>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// Sequence lock
+// One thread publishes a small struct of figures, any number of threads read the latest copy, and nobody
+// waits on anybody: the writer never blocks, a reader that catches a write half done just reads again.
+// For stats the FFB threads hand to the display and the control channel, which run at lower priority and
+// must never hold something a FFB thread needs.
+// The value sits in relaxed atomic words so a torn read is only ever thrown away, never undefined.
+
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock values are copied a word at a time");
+
+public:
+    // Writer thread only
+    void Store(const T& value) {
+        unsigned long long copy[Words] = {};
+        memcpy(copy, &value, sizeof(T));
+
+        unsigned long long s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed);   // odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < Words; i++) words[i].store(copy[i], std::memory_order_relaxed);
+        sequence.store(s + 2, std::memory_order_release);
+    }
+
+    // Any thread. A default T until the first Store
+    T Load() const {
+        unsigned long long copy[Words];
+        unsigned long long before, after;
+        do {
+            before = sequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < Words; i++) copy[i] = words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+
+        if (before == 0) return T();
+        T value;
+        memcpy(&value, copy, sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr size_t Words = (sizeof(T) + sizeof(unsigned long long) - 1) / sizeof(unsigned long long);
+
+    std::atomic<unsigned long long> sequence{ 0 };
+    std::atomic<unsigned long long> words[Words] = {};
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <stddef.h>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// Single producer / single consumer ring buffer
+// Exactly one thread pushes and one thread pops, no locks. Head and tail sit on their own cache lines
+// and each side keeps a cached copy of the other's index, so a push or pop normally touches one shared line.
+// A full ring refuses the push (counted in Dropped) rather than blocking the producer.
+// Depth/HighWater/Dropped are safe to read from any thread, for diagnostics.
+
+#define SPSC_CACHE_LINE 64
+
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    // Producer thread only
+    bool Push(const T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tailCache >= Capacity) {
+            tailCache = tail.load(std::memory_order_acquire);
+            if (h - tailCache >= Capacity) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        slots[h & (Capacity - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+
+        size_t depth = h + 1 - tailCache;
+        if (depth > highWater.load(std::memory_order_relaxed)) highWater.store(depth, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Consumer thread only
+    bool Pop(T& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == headCache) {
+            headCache = head.load(std::memory_order_acquire);
+            if (t == headCache) return false;
+        }
+        item = slots[t & (Capacity - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Tail first so the difference can't go negative while the other threads move on
+    size_t Depth() const {
+        size_t t = tail.load(std::memory_order_acquire);
+        return head.load(std::memory_order_acquire) - t;
+    }
+    size_t HighWater() const { return highWater.load(std::memory_order_relaxed); }
+    unsigned long long Dropped() const { return dropped.load(std::memory_order_relaxed); }
+    static constexpr size_t Size() { return Capacity; }
+
+private:
+    alignas(SPSC_CACHE_LINE) std::atomic<size_t> head{ 0 };
+    size_t tailCache = 0;       // producer's view of tail
+    alignas(SPSC_CACHE_LINE) std::atomic<size_t> tail{ 0 };
+    size_t headCache = 0;       // consumer's view of head
+    alignas(SPSC_CACHE_LINE) std::atomic<size_t> highWater{ 0 };
+    std::atomic<unsigned long long> dropped{ 0 };
+    alignas(SPSC_CACHE_LINE) T slots[Capacity];
+};
@@ -0,0 +1,167 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <stddef.h>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// The block x86GP2 writes to "Local\x86GP2FFB"
+// deviceName is UTF-16 on the game side, char16_t keeps the layout the same when built on Linux
+typedef struct {
+    int structSize;
+
+    int  deviceID; // just the enumerated ID, not the GUID
+    char16_t deviceName[260];
+
+    bool isInRace; // to not apply anything when not in a race, there could be bogus data left in memory
+    bool isPaused;
+    bool isReplay;
+    bool isX86GP2MenuOn;
+    bool isPlayer; // to not have any FBB when the POV is not the player
+
+    float fps;
+
+    // these are in real world units
+    float speedKmh;
+
+    float stWheelAngle;
+    float tyreTurnAngle;
+
+    float slipAngleFront;
+    float slipAngleRear;
+
+    int surfaceType[4];
+
+    // i don't know the scaling or the unit for these
+    int suspensionTravel[4]; // could this indirectly tell the tyre load?
+    int rideHeights[4]; // this could be more in world space than in relation to the car because it goes very high when you get lifted in the box
+    int wheelSpin_13C[4]; // this is the rotation of the wheels
+    int notOnDamper[4]; // someone else named it like this, i don't know what he meant by not on damper
+    int calc_248[4]; // no clue
+    int wheel_2AC[4]; // no clue
+
+    unsigned char wheelsData[2048];
+} SharedMemory;
+
+static_assert(sizeof(SharedMemory) == 2720, "SharedMemory must match the block x86GP2 writes");
+
+#define SURFACE_ASPHALT 0
+#define SURFACE_LOW_CURB 1
+#define SURFACE_HIGH_CURB 2
+#define SURFACE_GRASS 3
+#define SURFACE_GRAVEL 4
+
+// === Layout descriptors ===
+// Everything that changes between x86GP2 builds lives in this table.
+// To support a new build add an entry to telemetryLayouts below - no decoder changes needed.
+// Corner order in the arrays is ours: LF, RF, LR, RR (see CORNER_ in telemetry_reader.h)
+
+enum class WheelFieldType {
+    Int32,
+    Int16,
+    Float32
+};
+
+struct WheelField {
+    int offset;             // bytes from the start of a corner's slot in wheelsData
+    WheelFieldType type;
+};
+
+struct TelemetryLayout {
+    int structSize;         // what the game reports in SharedMemory::structSize
+    const char* name;
+
+    int wheelStride;        // bytes per corner slot in wheelsData
+    int wheelSlot[4];       // which wheelsData slot holds each corner
+    int cornerIndex[4];     // which index of surfaceType[]/rideHeights[]/etc holds each corner
+
+    WheelField magLat;
+    WheelField magLong;
+};
+
+constexpr TelemetryLayout telemetryLayouts[] = {
+    // x86GP2 with the 2720 byte FFB block
+    { 2720, "x86GP2 (2720)", 512, { 2, 3, 0, 1 }, { 1, 3, 0, 2 },
+      { 52, WheelFieldType::Int32 }, { 380, WheelFieldType::Int32 } },
+};
+
+constexpr size_t telemetryLayoutCount = sizeof(telemetryLayouts) / sizeof(telemetryLayouts[0]);
+
+constexpr int WheelFieldSize(WheelFieldType type) {
+    return type == WheelFieldType::Int16 ? 2 : 4;
+}
+
+// Every field of every corner has to land inside wheelsData
+constexpr bool LayoutFitsWheelsData(const TelemetryLayout& layout) {
+    for (int corner = 0; corner < 4; corner++) {
+        int slotStart = layout.wheelSlot[corner] * layout.wheelStride;
+        if (slotStart + layout.magLat.offset + WheelFieldSize(layout.magLat.type) > 2048) return false;
+        if (slotStart + layout.magLong.offset + WheelFieldSize(layout.magLong.type) > 2048) return false;
+        if (layout.cornerIndex[corner] < 0 || layout.cornerIndex[corner] > 3) return false;
+    }
+    return true;
+}
+
+constexpr bool AllLayoutsFit() {
+    for (size_t i = 0; i < telemetryLayoutCount; i++) {
+        if (!LayoutFitsWheelsData(telemetryLayouts[i])) return false;
+    }
+    return true;
+}
+
+static_assert(AllLayoutsFit(), "A telemetry layout reads outside wheelsData");
+
+// === Decoding ===
+
+template <WheelFieldType Type>
+inline int ReadWheelField(const unsigned char* at) {
+    if constexpr (Type == WheelFieldType::Int32) {
+        int32_t value;
+        memcpy(&value, at, sizeof(value));
+        return value;
+    }
+    else if constexpr (Type == WheelFieldType::Int16) {
+        int16_t value;
+        memcpy(&value, at, sizeof(value));
+        return value;
+    }
+    else {
+        float value;
+        memcpy(&value, at, sizeof(value));
+        return static_cast<int>(value);
+    }
+}
+
+// One pass over all four corners, offsets and types are baked in at compile time so there are no branches
+template <size_t LayoutIndex>
+void DecodeWheelForces(const unsigned char* wheelsData, int magLat[4], int magLong[4]) {
+    constexpr TelemetryLayout layout = telemetryLayouts[LayoutIndex];
+
+    for (int corner = 0; corner < 4; corner++) {
+        const unsigned char* slot = wheelsData + layout.wheelSlot[corner] * layout.wheelStride;
+        magLat[corner] = ReadWheelField<layout.magLat.type>(slot + layout.magLat.offset);
+        magLong[corner] = ReadWheelField<layout.magLong.type>(slot + layout.magLong.offset);
+    }
+}
+
+typedef void (*WheelForceDecoder)(const unsigned char* wheelsData, int magLat[4], int magLong[4]);
+
+// Returns the table index for a struct size, or -1 if we don't know this build
+constexpr int FindTelemetryLayout(int structSize) {
+    for (size_t i = 0; i < telemetryLayoutCount; i++) {
+        if (telemetryLayouts[i].structSize == structSize) return static_cast<int>(i);
+    }
+    return -1;
+}
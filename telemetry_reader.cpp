@@ -1,32 +1,22 @@
 ﻿// telemetry_reader.cpp
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <stdint.h>
 #include <stdio.h>
 #include <stdbool.h>
 #include "telemetry_reader.h"
-#include "ffb_setup.h"
+#include "telemetry_layout.h"
+#include "telemetry_source.h"
+#include "telemetry_recorder.h"
+#include "logger.h"
 #include "cmath"
-
-#define FRONT_LEFT 1 // 0
-#define FRONT_RIGHT 3 // 1
-#define REAR_LEFT 0 // 2
-#define REAR_RIGHT 2 // 3
-
-#define SURFACE_ASPHALT 0
-#define SURFACE_LOW_CURB 1
-#define SURFACE_HIGH_CURB 2
-#define SURFACE_GRASS 3
-#define SURFACE_GRAVEL 4
-
-#define WD_FRONT_LEFT (2 * 512) // 2 
-#define WD_FRONT_RIGHT (3 * 512) // 3
-#define WD_REAR_LEFT (0 * 512) // 0
-#define WD_REAR_RIGHT (1 * 512) // 1 
-
-
-#define INT_SIZE 32
-#define SHORT_SIZE 16
-#define BYTE_SIZE 8
+#include <string.h>
+#include <atomic>
+#include <array>
+#include <utility>
+#include <algorithm>
+#include <chrono>
 
 /*
  * Copyright 2025 gplaps
@@ -44,125 +34,315 @@
 
 
 
-typedef struct {
-    int structSize;
-
-    int  deviceID; // just the enumerated ID, not the GUID
-    wchar_t deviceName[260];
-
-    bool isInRace; // to not apply anything when not in a race, there could be bogus data left in memory
-    bool isPaused;
-    bool isReplay;
-    bool isX86GP2MenuOn;
-    bool isPlayer; // to not have any FBB when the POV is not the player
-
-    float fps;
+// One decoder per layout table entry, activeLayout picks the one for the running game
+template <size_t... Index>
+static constexpr std::array<WheelForceDecoder, sizeof...(Index)> MakeWheelDecoders(std::index_sequence<Index...>) {
+    return { { &DecodeWheelForces<Index>... } };
+}
 
-    // these are in real world units
-    float speedKmh;
+static constexpr std::array<WheelForceDecoder, telemetryLayoutCount> wheelDecoders =
+    MakeWheelDecoders(std::make_index_sequence<telemetryLayoutCount>{});
 
-    float stWheelAngle;
-    float tyreTurnAngle;
+static int activeLayout = 0;
+static int activeStructSize = -1;
 
-    float slipAngleFront;
-    float slipAngleRear;
+// Where the block comes from, the platform default unless someone set another one
+static TelemetrySource* source = nullptr;
+static bool ownsSource = false;
+static const SharedMemory* p = nullptr;
+static unsigned long long lastRecordedHash = 0;
 
-    int surfaceType[4];
+static double NowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
 
-    // i don't know the scaling or the unit for these
-    int suspensionTravel[4]; // could this indirectly tell the tyre load?
-    int rideHeights[4]; // this could be more in world space than in relation to the car because it goes very high when you get lifted in the box
-    int wheelSpin_13C[4]; // this is the rotation of the wheels
-    int notOnDamper[4]; // someone else named it like this, i don't know what he meant by not on damper
-    int calc_248[4]; // no clue
-    int wheel_2AC[4]; // no clue
+// === Attach ===
+// The game creates "Local\x86GP2FFB" when it starts and it goes away when the last handle closes.
+// While the game isn't running we retry with backoff instead of trying to open it every poll.
+// Our own handle keeps the mapping alive after the game exits, so "gone" can't be seen directly -
+// if the block stops changing for a while we let go of it and try to open it again by name.
+// A paused game reopens straight away, an exited one doesn't and we go back to waiting.
+#define ATTACH_RETRY_MIN_MS 250.0
+#define ATTACH_RETRY_MAX_MS 5000.0
+#define ATTACH_STALE_MS 3000.0 // no change in the block for this long = check if the game is still there
+
+static TelemetryAttachState attachState = TelemetryAttachState::Waiting;
+static TelemetryAttachStats attachStats;
+static double nextAttachMs = 0.0;
+static double waitingSinceMs = 0.0;
+static double lastChangeMs = 0.0;
+static unsigned long long lastAttachHash = 0;
+static bool waitingLogged = false;
+
+static void Detach() {
+    if (source) source->Close();
+    p = nullptr;
+}
 
-    unsigned char wheelsData[2048];
-} SharedMemory;
+static bool TryAttach() {
+    if (!source) {
+        source = CreateDefaultTelemetrySource();
+        ownsSource = true;
+    }
+    if (!source->Open()) return false;
 
-static HANDLE hmap = NULL;
-static const SharedMemory* p = nullptr;
-static bool initialized = false;
+    p = source->View();
+    if (!p) {
+        source->Close();
+        return false;
+    }
+    return true;
+}
 
-int readWheelData(const unsigned char* wheelsData, int dataStartOffset, int offsetIntoData) {
-    return *reinterpret_cast<const int*>(&wheelsData[dataStartOffset + offsetIntoData]);
+static void EnterWaiting(double now) {
+    attachState = TelemetryAttachState::Waiting;
+    attachStats.retryDelayMs = 0.0;
+    nextAttachMs = now + ATTACH_RETRY_MIN_MS;
+    waitingSinceMs = now;
+    waitingLogged = false;
 }
 
-// === Main ===
+// Returns true with 'p' mapped, false if the game isn't there (yet)
+static bool EnsureAttached() {
+    if (attachState == TelemetryAttachState::Attached) return true;
 
-bool ReadTelemetryData(RawTelemetry& out) {
+    double now = NowMs();
+    if (waitingSinceMs == 0.0) waitingSinceMs = now;
 
-    if (!initialized) {
-        hmap = OpenFileMappingA(FILE_MAP_READ, FALSE, "Local\\x86GP2FFB");
-        if (!hmap) {
-            LogMessage(L"x86GP2 is not found");
-            return false;
+    if (attachState == TelemetryAttachState::Stale) {
+        // Let go and see if anyone else still has the block open
+        Detach();
+        if (TryAttach()) {
+            attachState = TelemetryAttachState::Attached;
+            lastChangeMs = now;
+            return true;
         }
+        attachStats.detaches++;
+        LogMessage(L"[INFO] x86GP2 has closed, waiting for it to come back");
+        EnterWaiting(now);
+        return false;
+    }
+
+    if (now < nextAttachMs) return false;
 
-        p = (const SharedMemory*)MapViewOfFile(hmap, FILE_MAP_READ, 0, 0, 0);
-        if (!p) {
-            CloseHandle(hmap);
-            return false;
+    if (!TryAttach()) {
+        attachStats.failedAttempts++;
+        if (!waitingLogged) {
+            LogMessage(L"x86GP2 is not found, retrying every " + std::to_wstring(static_cast<int>(ATTACH_RETRY_MIN_MS)) +
+                L" ms backing off to " + std::to_wstring(static_cast<int>(ATTACH_RETRY_MAX_MS)) + L" ms");
+            waitingLogged = true;
         }
-        initialized = true;
+        attachStats.retryDelayMs = std::clamp(attachStats.retryDelayMs * 2.0, ATTACH_RETRY_MIN_MS, ATTACH_RETRY_MAX_MS);
+        nextAttachMs = now + attachStats.retryDelayMs;
+        return false;
     }
 
+#ifdef _WIN32
+    // Was done on every read, once per attach is enough
     CONSOLE_CURSOR_INFO ci = { 1, FALSE };
     SetConsoleCursorInfo(GetStdHandle(STD_OUTPUT_HANDLE), &ci);
+#endif
+
+    attachStats.attaches++;
+    attachStats.retryDelayMs = 0.0;
+    attachState = TelemetryAttachState::Attached;
+    lastChangeMs = now;
+    lastAttachHash = 0;
+    LogMessage(L"[INFO] Attached to x86GP2 through " + std::wstring(source->Name()) + L" (attach #" + std::to_wstring(attachStats.attaches) +
+        L", waited " + std::to_wstring((now - waitingSinceMs) / 1000.0) + L" s, " +
+        std::to_wstring(attachStats.failedAttempts) + L" failed attempts so far)");
+    return true;
+}
+
+// Called with every snapshot hash, flags the mapping stale if the block has stopped changing
+static void TrackAttachActivity(unsigned long long hash) {
+    double now = NowMs();
+    if (hash != lastAttachHash) {
+        lastAttachHash = hash;
+        lastChangeMs = now;
+        return;
+    }
+    if (now - lastChangeMs >= ATTACH_STALE_MS) {
+        attachState = TelemetryAttachState::Stale;
+    }
+}
 
-    out.gp2_structSize = p->structSize;
-    
-    out.gp2_isInRace = p->isInRace;
-    out.gp2_isPlayer = p->isPlayer;
-    out.gp2_isPaused = p->isPaused;
-    out.gp2_isReplay = p->isReplay;
-    out.gp2_isX86MenuOn = p->isX86GP2MenuOn;
-    out.gp2_deviceID = p->deviceID;
-
-
-    out.gp2_speedKmh = p->speedKmh;
-    out.gp2_stWheelAngle = p->stWheelAngle;
-    out.gp2_tyreTurnAngle = p->tyreTurnAngle;
-    out.gp2_slipAngleFront = p->slipAngleFront;
-    out.gp2_slipAngleRear = p->slipAngleRear;
-
-    out.gp2_magLat_lf = static_cast<float>(readWheelData(p->wheelsData, WD_FRONT_LEFT, 52));
-    out.gp2_magLat_rf = static_cast<float>(readWheelData(p->wheelsData, WD_FRONT_RIGHT, 52));
-
-    out.gp2_magLong_lf = static_cast<float>(readWheelData(p->wheelsData, WD_FRONT_LEFT, 380));
-    out.gp2_magLong_rf = static_cast<float>(readWheelData(p->wheelsData, WD_FRONT_RIGHT, 380));
-
-    out.gp2_surfaceType_lf = p->surfaceType[FRONT_LEFT];
-    out.gp2_surfaceType_rf = p->surfaceType[FRONT_RIGHT];
-    out.gp2_surfaceType_lr = p->surfaceType[REAR_LEFT];
-    out.gp2_surfaceType_rr = p->surfaceType[REAR_RIGHT];
-
-    out.gp2_rideHeights_lf = p->rideHeights[FRONT_LEFT];
-    out.gp2_rideHeights_rf = p->rideHeights[FRONT_RIGHT];
-    out.gp2_rideHeights_lr = p->rideHeights[REAR_LEFT];
-    out.gp2_rideHeights_rr = p->rideHeights[REAR_RIGHT];
-
-    out.gp2_wheelSpin_13C_lf = p->wheelSpin_13C[FRONT_LEFT];
-    out.gp2_wheelSpin_13C_rf = p->wheelSpin_13C[FRONT_RIGHT];
-    out.gp2_wheelSpin_13C_lr = p->wheelSpin_13C[REAR_LEFT];
-    out.gp2_wheelSpin_13C_rr = p->wheelSpin_13C[REAR_RIGHT];
-
-    out.gp2_notOnDamper_lf = p->notOnDamper[FRONT_LEFT];
-    out.gp2_notOnDamper_rf = p->notOnDamper[FRONT_RIGHT];
-    out.gp2_notOnDamper_lr = p->notOnDamper[REAR_LEFT];
-    out.gp2_notOnDamper_rr = p->notOnDamper[REAR_RIGHT];
-
-    out.gp2_calc_248_lf = p->calc_248[FRONT_LEFT];
-    out.gp2_calc_248_rf = p->calc_248[FRONT_RIGHT];
-    out.gp2_calc_248_lr = p->calc_248[REAR_LEFT];
-    out.gp2_calc_248_rr = p->calc_248[REAR_RIGHT];
-
-    out.gp2_wheel_2AC_lf = p->wheel_2AC[FRONT_LEFT];
-    out.gp2_wheel_2AC_rf = p->wheel_2AC[FRONT_RIGHT];
-    out.gp2_wheel_2AC_lr = p->wheel_2AC[REAR_LEFT];
-    out.gp2_wheel_2AC_rr = p->wheel_2AC[REAR_RIGHT];
+TelemetryAttachState GetTelemetryAttachState() {
+    return attachState;
+}
 
+TelemetryAttachStats GetTelemetryAttachStats() {
+    return attachStats;
+}
+
+double GetTelemetryAttachRetryMs() {
+    if (attachState != TelemetryAttachState::Waiting) return 0.0;
+    double now = NowMs();
+    return (nextAttachMs > now) ? nextAttachMs - now : 0.0;
+}
+
+void SetTelemetrySource(TelemetrySource* newSource) {
+    Detach();
+    if (ownsSource) delete source;
+    source = newSource;
+    ownsSource = false;
+    EnterWaiting(NowMs());
+    nextAttachMs = 0.0; // try the new one straight away
+}
+
+// === Snapshot ===
+// The game writes the whole block every physics tick while we are reading it.
+// Reading fields straight out of the view meant we could get the left front from one tick
+// and the right front from the next, which shows up as a force spike.
+// x86GP2 doesn't publish a sequence counter, so the "generation check" is: copy the block once,
+// then compare the copy against the live view. If anything changed while we were copying
+// the frame is torn (or the game was mid-write) and we try again, up to a small budget.
+#define SNAPSHOT_MAX_ATTEMPTS 4
+// tools/snapshot_bench.cpp measures the cost per snapshot and the retry and torn rates against a writer thread.
+#define SNAPSHOT_REPORT_INTERVAL 600 // log snapshot cost every 600 reads (new frames and repeat polls alike)
+
+static SharedMemory snapshot;
+static TelemetrySnapshotStats snapshotStats;
+
+// Returns true if the copy is consistent, false if every attempt was torn
+// (in that case the last copy is still in 'snapshot' and is used anyway)
+static bool TakeSnapshot() {
+    for (int attempt = 0; attempt < SNAPSHOT_MAX_ATTEMPTS; attempt++) {
+        memcpy(&snapshot, p, sizeof(SharedMemory));
+
+        // Stop the compiler from assuming the view hasn't changed since the copy
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (memcmp(&snapshot, p, sizeof(SharedMemory)) == 0) {
+            return true;
+        }
+        snapshotStats.retries++;
+    }
+    snapshotStats.torn++;
+    return false;
+}
+
+static void UpdateSnapshotStats(double micros) {
+    snapshotStats.snapshots++;
+    snapshotStats.totalMicros += micros;
+    if (micros > snapshotStats.maxMicros) snapshotStats.maxMicros = micros;
+
+    if (snapshotStats.snapshots % SNAPSHOT_REPORT_INTERVAL == 0) {
+        LOG_INFO(L"[INFO] Telemetry snapshot cost per read: avg %f us, max %f us, retries %llu, torn %llu",
+            snapshotStats.totalMicros / snapshotStats.snapshots, snapshotStats.maxMicros,
+            snapshotStats.retries, snapshotStats.torn);
+    }
+}
+
+// Cheap identity for a frame so the loop can tell a new game frame from one it has already used
+// FNV-1a style but a whole 64-bit word at a time, the block is ~2.7KB so this is a few hundred multiplies
+static unsigned long long HashSnapshot(const SharedMemory& frame) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&frame);
+    unsigned long long hash = 14695981039346656037ULL;
+    size_t i = 0;
+    for (; i + sizeof(unsigned long long) <= sizeof(SharedMemory); i += sizeof(unsigned long long)) {
+        unsigned long long word;
+        memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ULL;
+    }
+    for (; i < sizeof(SharedMemory); i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+TelemetrySnapshotStats GetTelemetrySnapshotStats() {
+    return snapshotStats;
+}
+
+// Display-only per-corner values, from the same snapshot as the main frame
+static void ReadExtras(const TelemetryLayout& layout, unsigned int fields, RawTelemetryExtras& out) {
+    for (int corner = 0; corner < 4; corner++) {
+        int index = layout.cornerIndex[corner];
+        if (fields & TELEM_RIDE_HEIGHT) out.gp2_rideHeights[corner] = snapshot.rideHeights[index];
+        if (fields & TELEM_WHEEL_SPIN) out.gp2_wheelSpin_13C[corner] = snapshot.wheelSpin_13C[index];
+        if (fields & TELEM_NOT_ON_DAMPER) out.gp2_notOnDamper[corner] = snapshot.notOnDamper[index];
+        if (fields & TELEM_CALC_248) out.gp2_calc_248[corner] = snapshot.calc_248[index];
+        if (fields & TELEM_WHEEL_2AC) out.gp2_wheel_2AC[corner] = snapshot.wheel_2AC[index];
+    }
+}
+
+// === Main ===
+
+bool ReadTelemetryData(RawTelemetry& out, unsigned int fields, RawTelemetryExtras* extras) {
+
+    if (!EnsureAttached()) {
+        return false;
+    }
+
+
+    // Copy the block once and decode everything from the local copy
+    auto snapStart = std::chrono::steady_clock::now();
+    TakeSnapshot();
+    auto snapEnd = std::chrono::steady_clock::now();
+    UpdateSnapshotStats(std::chrono::duration<double, std::micro>(snapEnd - snapStart).count());
+
+    // State is always needed
+    out.gp2_structSize = snapshot.structSize;
+
+    out.gp2_isInRace = snapshot.isInRace;
+    out.gp2_isPlayer = snapshot.isPlayer;
+    out.gp2_isPaused = snapshot.isPaused;
+    out.gp2_isReplay = snapshot.isReplay;
+    out.gp2_isX86MenuOn = snapshot.isX86GP2MenuOn;
+    out.gp2_deviceID = snapshot.deviceID;
+    out.gp2_fps = snapshot.fps;
+
+    // Everything else only if someone this tick reads it
+    if (fields & TELEM_SPEED) {
+        out.gp2_speedKmh = snapshot.speedKmh;
+    }
+
+    if (fields & TELEM_STEERING) {
+        out.gp2_stWheelAngle = snapshot.stWheelAngle;
+        out.gp2_tyreTurnAngle = snapshot.tyreTurnAngle;
+    }
+
+    if (fields & TELEM_SLIP_ANGLES) {
+        out.gp2_slipAngleFront = snapshot.slipAngleFront;
+        out.gp2_slipAngleRear = snapshot.slipAngleRear;
+    }
+
+    // Pick the layout for this build of the game (unknown builds decode with the default,
+    // the version check in the main loop refuses to run on them anyway)
+    if (snapshot.structSize != activeStructSize) {
+        int found = FindTelemetryLayout(snapshot.structSize);
+        activeLayout = (found >= 0) ? found : 0;
+        activeStructSize = snapshot.structSize;
+    }
+    const TelemetryLayout& layout = telemetryLayouts[activeLayout];
+
+    // Tyre forces for all four corners in one pass
+    if (fields & TELEM_TYRE_FORCES) {
+        wheelDecoders[activeLayout](snapshot.wheelsData, out.gp2_magLat, out.gp2_magLong);
+    }
+
+    if (fields & TELEM_SURFACE) {
+        for (int corner = 0; corner < 4; corner++) {
+            out.gp2_surfaceType[corner] = static_cast<unsigned char>(snapshot.surfaceType[layout.cornerIndex[corner]]);
+        }
+    }
+
+    if (extras && (fields & TELEM_EXTRAS)) {
+        ReadExtras(layout, fields, *extras);
+    }
+
+    out.frameHash = HashSnapshot(snapshot);
     out.valid = true;
 
+    TrackAttachActivity(out.frameHash);
+
+    // Each new game frame goes to the recording once (queued, the write happens on the recorder's thread)
+    if (out.frameHash != lastRecordedHash && IsTelemetryRecording()) {
+        lastRecordedHash = out.frameHash;
+        RecordTelemetryFrame(snapshot, out.frameHash, static_cast<int64_t>(NowMs() * 1000.0));
+    }
+
     return true;
 }
\ No newline at end of file
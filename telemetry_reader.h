@@ -2,65 +2,118 @@
 #include <string>
 #pragma once
 
-struct RawTelemetry {
-    
-    double gp2_structSize;
-    
-    double gp2_isInRace;
-    double gp2_isPlayer;
-
-    double gp2_isPaused;
-    double gp2_isReplay;
-    double gp2_isX86MenuOn;
-    int gp2_deviceID;
-
-    double gp2_speedKmh;
-    double gp2_stWheelAngle;
-    double gp2_tyreTurnAngle;
-    double gp2_slipAngleFront;
-    double gp2_slipAngleRear;
-
-    float gp2_magLat_lf;
-    float gp2_magLat_rf;
-
-    float gp2_magLong_lf;
-    float gp2_magLong_rf;
-
-    double gp2_surfaceType_lf;
-    double gp2_surfaceType_rf;
-    double gp2_surfaceType_lr;
-    double gp2_surfaceType_rr;
-
-    double gp2_rideHeights_lf;
-    double gp2_rideHeights_rf;
-    double gp2_rideHeights_lr;
-    double gp2_rideHeights_rr;
-
-    double gp2_wheelSpin_13C_lf;
-    double gp2_wheelSpin_13C_rf;
-    double gp2_wheelSpin_13C_lr;
-    double gp2_wheelSpin_13C_rr;
-
-    double gp2_notOnDamper_lf;
-    double gp2_notOnDamper_rf;
-    double gp2_notOnDamper_lr;
-    double gp2_notOnDamper_rr;
-
-    double gp2_calc_248_lf;
-    double gp2_calc_248_rf;
-    double gp2_calc_248_lr;
-    double gp2_calc_248_rr;
-
-    double gp2_wheel_2AC_lf;
-    double gp2_wheel_2AC_rf;
-    double gp2_wheel_2AC_lr;
-    double gp2_wheel_2AC_rr;
+// Corner index for the per-corner arrays below
+// This is our order, the game stores its own arrays in a different order
+#define CORNER_LF 0
+#define CORNER_RF 1
+#define CORNER_LR 2
+#define CORNER_RR 3
+
+// Telemetry channels
+// Each effect (and the display) declares which of these it reads, and the reader only decodes
+// the union of what the current tick needs. State (race/pause/replay/menu flags, struct size, fps)
+// and the frame hash are always decoded because the main loop needs them for every read.
+#define TELEM_STATE         0x0001
+#define TELEM_SPEED         0x0002
+#define TELEM_STEERING      0x0004  // steering wheel angle + tyre turn angle
+#define TELEM_SLIP_ANGLES   0x0008
+#define TELEM_TYRE_FORCES   0x0010  // lateral/longitudinal forces out of wheelsData
+#define TELEM_SURFACE       0x0020
+#define TELEM_RIDE_HEIGHT   0x0040  // the rest are RawTelemetryExtras
+#define TELEM_WHEEL_SPIN    0x0080
+#define TELEM_NOT_ON_DAMPER 0x0100
+#define TELEM_CALC_248      0x0200
+#define TELEM_WHEEL_2AC     0x0400
+#define TELEM_EXTRAS        (TELEM_RIDE_HEIGHT | TELEM_WHEEL_SPIN | TELEM_NOT_ON_DAMPER | TELEM_CALC_248 | TELEM_WHEEL_2AC)
+#define TELEM_ALL           0xFFFF
+
+// Hot path frame - what the force code reads every tick
+// Kept in the types the game actually writes so the whole thing fits in two cache lines,
+// it gets copied into 'previous' every tick so size matters
+struct alignas(64) RawTelemetry {
+
+    // Hash of the whole shared memory block, same hash = same game frame
+    unsigned long long frameHash = 0;
+
+    float gp2_speedKmh = 0.0f;
+    float gp2_stWheelAngle = 0.0f;
+    float gp2_tyreTurnAngle = 0.0f;
+    float gp2_slipAngleFront = 0.0f;
+    float gp2_slipAngleRear = 0.0f;
+    float gp2_fps = 0.0f;
+
+    // Raw tyre forces in game units, all four corners
+    int gp2_magLat[4] = {};
+    int gp2_magLong[4] = {};
+
+    int gp2_structSize = 0;
+    int gp2_deviceID = 0;
+
+    unsigned char gp2_surfaceType[4] = {};
+
+    bool gp2_isInRace = false;
+    bool gp2_isPlayer = false;
+    bool gp2_isPaused = false;
+    bool gp2_isReplay = false;
+    bool gp2_isX86MenuOn = false;
 
     bool valid = false;
 };
 
+static_assert(sizeof(RawTelemetry) <= 128, "RawTelemetry should stay within two cache lines");
+
+// Per-corner values nobody in the force path uses yet, only the display shows them
+// Decoded separately so the hot frame stays small
+struct RawTelemetryExtras {
+    int gp2_rideHeights[4] = {};
+    int gp2_wheelSpin_13C[4] = {};
+    int gp2_notOnDamper[4] = {};
+    int gp2_calc_248[4] = {};
+    int gp2_wheel_2AC[4] = {};
+};
+
+// Snapshot health, to see how often we catch the game mid-write
+struct TelemetrySnapshotStats {
+    unsigned long long snapshots = 0;
+    unsigned long long retries = 0;   // copies thrown away because the game wrote during them
+    unsigned long long torn = 0;      // frames where every attempt was torn
+    double totalMicros = 0.0;
+    double maxMicros = 0.0;
+};
+
+// Connection to the game's shared memory
+// The reader re-opens it on its own when the game restarts, these are just for reporting
+enum class TelemetryAttachState {
+    Waiting,    // game not running (or not started its FFB block yet), retrying with backoff
+    Attached,
+    Stale       // mapped, but nothing has changed for a while - checking whether the game has gone
+};
+
+struct TelemetryAttachStats {
+    unsigned long long attaches = 0;        // successful attaches, a change means the game (re)started
+    unsigned long long detaches = 0;
+    unsigned long long failedAttempts = 0;  // OpenFileMapping calls that found nothing
+    double retryDelayMs = 0.0;              // current backoff
+};
+
 // Include logging
 void LogMessage(const std::wstring& msg);
 
 // Returns true if data was read successfully
-bool ReadTelemetryData(RawTelemetry& out);
\ No newline at end of file
+// 'fields' is a TELEM_ mask, anything not asked for keeps its previous value in 'out'
+// Pass 'extras' only when something is going to display them
+bool ReadTelemetryData(RawTelemetry& out, unsigned int fields = TELEM_ALL, RawTelemetryExtras* extras = nullptr);
+
+TelemetrySnapshotStats GetTelemetrySnapshotStats();
+
+// Read from somewhere other than the platform default (see telemetry_source.h)
+// The reader doesn't take ownership, pass nullptr to go back to the default
+class TelemetrySource;
+void SetTelemetrySource(TelemetrySource* source);
+
+TelemetryAttachState GetTelemetryAttachState();
+TelemetryAttachStats GetTelemetryAttachStats();
+
+// How long until the reader will next try to attach, 0 if attached
+// so callers can sleep instead of spinning on ReadTelemetryData while the game is closed
+double GetTelemetryAttachRetryMs();
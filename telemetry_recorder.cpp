@@ -0,0 +1,418 @@
+#include "telemetry_recorder.h"
+#include <string.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#endif
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+#define RECORDER_QUEUE_FRAMES 256           // ~4 seconds at 60fps before we start dropping
+#define RECORDER_GROW_BYTES (64ull << 20)   // grow the file 64MB at a time (~6 minutes at 60fps)
+
+// === Mapped file ===
+// Growing a memory mapped file means unmapping, extending and mapping again,
+// so it's done in big steps and only ever on the writer thread.
+
+struct MappedFile {
+    unsigned char* view = nullptr;
+    uint64_t capacity = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#else
+    int fd = -1;
+#endif
+};
+
+#ifdef _WIN32
+
+static bool OpenForWrite(MappedFile& mf, const std::wstring& path) {
+    mf.file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    return mf.file != INVALID_HANDLE_VALUE;
+}
+
+static void Unmap(MappedFile& mf) {
+    if (mf.view) UnmapViewOfFile(mf.view);
+    if (mf.mapping) CloseHandle(mf.mapping);
+    mf.view = nullptr;
+    mf.mapping = NULL;
+}
+
+static bool MapWithCapacity(MappedFile& mf, uint64_t capacity) {
+    Unmap(mf);
+    // Creating the mapping bigger than the file extends the file
+    mf.mapping = CreateFileMappingW(mf.file, NULL, PAGE_READWRITE, static_cast<DWORD>(capacity >> 32), static_cast<DWORD>(capacity), NULL);
+    if (!mf.mapping) return false;
+    mf.view = static_cast<unsigned char*>(MapViewOfFile(mf.mapping, FILE_MAP_WRITE, 0, 0, 0));
+    if (!mf.view) {
+        CloseHandle(mf.mapping);
+        mf.mapping = NULL;
+        return false;
+    }
+    mf.capacity = capacity;
+    return true;
+}
+
+static void CloseAndTrim(MappedFile& mf, uint64_t finalSize) {
+    Unmap(mf);
+    if (mf.file != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER end;
+        end.QuadPart = static_cast<LONGLONG>(finalSize);
+        SetFilePointerEx(mf.file, end, NULL, FILE_BEGIN);
+        SetEndOfFile(mf.file);
+        CloseHandle(mf.file);
+    }
+    mf.file = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+static std::string NarrowPath(const std::wstring& path) {
+    std::string narrow(path.size() * 4 + 1, '\0');
+    size_t length = wcstombs(&narrow[0], path.c_str(), narrow.size());
+    if (length == static_cast<size_t>(-1)) return std::string(path.begin(), path.end());
+    narrow.resize(length);
+    return narrow;
+}
+
+static bool OpenForWrite(MappedFile& mf, const std::wstring& path) {
+    mf.fd = open(NarrowPath(path).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    return mf.fd >= 0;
+}
+
+static void Unmap(MappedFile& mf) {
+    if (mf.view) munmap(mf.view, mf.capacity);
+    mf.view = nullptr;
+}
+
+static bool MapWithCapacity(MappedFile& mf, uint64_t capacity) {
+    Unmap(mf);
+    if (ftruncate(mf.fd, static_cast<off_t>(capacity)) != 0) return false;
+    void* mapped = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, mf.fd, 0);
+    if (mapped == MAP_FAILED) return false;
+    mf.view = static_cast<unsigned char*>(mapped);
+    mf.capacity = capacity;
+    return true;
+}
+
+static void CloseAndTrim(MappedFile& mf, uint64_t finalSize) {
+    Unmap(mf);
+    if (mf.fd >= 0) {
+        if (ftruncate(mf.fd, static_cast<off_t>(finalSize)) != 0) {
+            LogMessage(L"[WARNING] Could not trim the telemetry recording");
+        }
+        close(mf.fd);
+    }
+    mf.fd = -1;
+}
+
+#endif
+
+// === Recorder ===
+
+static std::mutex recorderMutex;
+static std::condition_variable recorderWake;
+static std::thread recorderThread;
+static std::atomic<bool> recording = false;
+static bool stopRequested = false;
+
+// Ring of frames waiting for the writer thread
+static std::vector<RecordedFrame> queue;
+static size_t queueHead = 0;
+static size_t queueCount = 0;
+
+static MappedFile output;
+static uint64_t writtenFrames = 0;
+static std::vector<RecordingIndexEntry> pendingIndex;
+static TelemetryRecorderStats recorderStats;
+static std::wstring recordingPath;
+static int64_t recordingStartMicros = -1;
+
+static RecordingHeader* OutputHeader() {
+    return reinterpret_cast<RecordingHeader*>(output.view);
+}
+
+static bool EnsureCapacity(uint64_t bytes) {
+    if (bytes <= output.capacity) return true;
+    uint64_t capacity = output.capacity;
+    while (capacity < bytes) capacity += RECORDER_GROW_BYTES;
+    return MapWithCapacity(output, capacity);
+}
+
+static bool AppendFrame(const RecordedFrame& frame) {
+    uint64_t offset = sizeof(RecordingHeader) + writtenFrames * sizeof(RecordedFrame);
+    if (!EnsureCapacity(offset + sizeof(RecordedFrame))) return false;
+
+    memcpy(output.view + offset, &frame, sizeof(RecordedFrame));
+
+    // Struct size of the first frame goes in the header
+    if (writtenFrames == 0) {
+        OutputHeader()->structSize = frame.block.structSize;
+    }
+
+    if (writtenFrames % RECORDING_INDEX_INTERVAL == 0) {
+        pendingIndex.push_back({ frame.timestampMicros, writtenFrames });
+    }
+    writtenFrames++;
+    OutputHeader()->frameCount = writtenFrames;
+    return true;
+}
+
+static void RecorderLoop() {
+    RecordedFrame frame;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(recorderMutex);
+            recorderWake.wait(lock, [] { return queueCount > 0 || stopRequested; });
+            if (queueCount == 0 && stopRequested) break;
+
+            frame = queue[queueHead];
+            queueHead = (queueHead + 1) % queue.size();
+            queueCount--;
+        }
+
+        // Write outside the lock, the reader can keep queueing while we grow the file
+        if (!AppendFrame(frame)) {
+            LogMessage(L"[ERROR] Telemetry recording stopped, could not grow " + recordingPath);
+            recording = false;
+            break;
+        }
+
+        std::lock_guard<std::mutex> lock(recorderMutex);
+        recorderStats.framesWritten = writtenFrames;
+        recorderStats.bytesWritten = sizeof(RecordingHeader) + writtenFrames * sizeof(RecordedFrame);
+    }
+}
+
+bool StartTelemetryRecording(const std::wstring& path) {
+    if (recording) return true;
+
+    if (!OpenForWrite(output, path) || !MapWithCapacity(output, RECORDER_GROW_BYTES)) {
+        LogMessage(L"[ERROR] Could not create telemetry recording: " + path);
+        CloseAndTrim(output, 0);
+        return false;
+    }
+
+    RecordingHeader* header = OutputHeader();
+    memset(header, 0, sizeof(RecordingHeader));
+    memcpy(header->magic, RECORDING_MAGIC, sizeof(header->magic));
+    header->version = RECORDING_VERSION;
+    header->headerSize = sizeof(RecordingHeader);
+    header->recordSize = sizeof(RecordedFrame);
+    header->indexInterval = RECORDING_INDEX_INTERVAL;
+
+    queue.assign(RECORDER_QUEUE_FRAMES, RecordedFrame{});
+    queueHead = 0;
+    queueCount = 0;
+    writtenFrames = 0;
+    pendingIndex.clear();
+    recorderStats = TelemetryRecorderStats{};
+    recordingPath = path;
+    recordingStartMicros = -1;
+    stopRequested = false;
+
+    recorderThread = std::thread(RecorderLoop);
+    recording = true;
+    LogMessage(L"[INFO] Recording telemetry to " + path);
+    return true;
+}
+
+void StopTelemetryRecording() {
+    if (!recorderThread.joinable()) return;
+
+    recording = false;
+    {
+        std::lock_guard<std::mutex> lock(recorderMutex);
+        stopRequested = true;
+    }
+    recorderWake.notify_one();
+    recorderThread.join();
+
+    // Index goes after the last frame, then the header points at it
+    uint64_t indexOffset = sizeof(RecordingHeader) + writtenFrames * sizeof(RecordedFrame);
+    uint64_t finalSize = indexOffset + pendingIndex.size() * sizeof(RecordingIndexEntry);
+    if (output.view && EnsureCapacity(finalSize)) {
+        if (!pendingIndex.empty()) {
+            memcpy(output.view + indexOffset, pendingIndex.data(), pendingIndex.size() * sizeof(RecordingIndexEntry));
+        }
+        RecordingHeader* header = OutputHeader();
+        header->frameCount = writtenFrames;
+        header->indexOffset = indexOffset;
+        header->indexCount = pendingIndex.size();
+    }
+    else {
+        finalSize = indexOffset; // no index, the reader will rebuild it
+    }
+    CloseAndTrim(output, finalSize);
+
+    LogMessage(L"[INFO] Telemetry recording closed: " + std::to_wstring(writtenFrames) + L" frames, " +
+        std::to_wstring(recorderStats.framesDropped) + L" dropped, " + std::to_wstring(finalSize / 1024) + L" KB");
+}
+
+bool IsTelemetryRecording() {
+    return recording;
+}
+
+void RecordTelemetryFrame(const SharedMemory& block, unsigned long long frameHash, int64_t timestampMicros) {
+    if (!recording) return;
+
+    {
+        std::lock_guard<std::mutex> lock(recorderMutex);
+        if (queueCount == queue.size()) {
+            recorderStats.framesDropped++;
+            return;
+        }
+
+        // Timestamps in the file start at 0
+        if (recordingStartMicros < 0) recordingStartMicros = timestampMicros;
+
+        RecordedFrame& slot = queue[(queueHead + queueCount) % queue.size()];
+        slot.timestampMicros = timestampMicros - recordingStartMicros;
+        slot.frameHash = frameHash;
+        memcpy(&slot.block, &block, sizeof(SharedMemory));
+        queueCount++;
+    }
+    recorderWake.notify_one();
+}
+
+TelemetryRecorderStats GetTelemetryRecorderStats() {
+    std::lock_guard<std::mutex> lock(recorderMutex);
+    return recorderStats;
+}
+
+// === Reading ===
+
+TelemetryRecording::~TelemetryRecording() {
+    Close();
+}
+
+bool TelemetryRecording::Open(const std::wstring& path) {
+    Close();
+
+#ifdef _WIN32
+    HANDLE f = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (f == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(f, &fileSize);
+    HANDLE m = CreateFileMappingW(f, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!m) {
+        CloseHandle(f);
+        return false;
+    }
+    data = static_cast<const unsigned char*>(MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0));
+    file = f;
+    mapping = m;
+    size = static_cast<uint64_t>(fileSize.QuadPart);
+#else
+    int fd = open(NarrowPath(path).c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    data = (mapped == MAP_FAILED) ? nullptr : static_cast<const unsigned char*>(mapped);
+    size = static_cast<uint64_t>(st.st_size);
+#endif
+
+    if (!data || size < sizeof(RecordingHeader)) {
+        LogMessage(L"[ERROR] Could not map telemetry recording: " + path);
+        Close();
+        return false;
+    }
+
+    header = reinterpret_cast<const RecordingHeader*>(data);
+    if (memcmp(header->magic, RECORDING_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != RECORDING_VERSION || header->headerSize != sizeof(RecordingHeader) ||
+        header->recordSize != sizeof(RecordedFrame)) {
+        LogMessage(L"[ERROR] Not a telemetry recording this version can read: " + path);
+        Close();
+        return false;
+    }
+
+    // The index goes after the last frame. Checked without multiplying, so a garbage count can't wrap around
+    bool indexFits = header->indexOffset >= header->headerSize && header->indexOffset <= size &&
+        header->indexCount <= (size - header->indexOffset) / sizeof(RecordingIndexEntry);
+
+    // Don't trust frameCount past the end of the frames (recording that was cut short)
+    uint64_t framesEnd = indexFits ? header->indexOffset : size;
+    uint64_t framesInFile = (framesEnd - header->headerSize) / header->recordSize;
+    frameCount = std::min<uint64_t>(header->frameCount, framesInFile);
+
+    if (indexFits) {
+        const RecordingIndexEntry* entries = reinterpret_cast<const RecordingIndexEntry*>(data + header->indexOffset);
+        index.assign(entries, entries + header->indexCount);
+        // An entry past the frames would have FindFrame hand back a frame that isn't there, rebuild instead
+        for (const RecordingIndexEntry& entry : index) indexFits = indexFits && entry.frameNumber < frameCount;
+        if (!indexFits) index.clear();
+    }
+    if (!indexFits) {
+        LogMessage(L"[WARNING] Telemetry recording has no index (not closed cleanly?), rebuilding it");
+        for (uint64_t i = 0; i < frameCount; i += RECORDING_INDEX_INTERVAL) {
+            index.push_back({ Frame(i).timestampMicros, i });
+        }
+    }
+    return true;
+}
+
+void TelemetryRecording::Close() {
+#ifdef _WIN32
+    if (data) UnmapViewOfFile(data);
+    if (mapping) CloseHandle(static_cast<HANDLE>(mapping));
+    if (file) CloseHandle(static_cast<HANDLE>(file));
+#else
+    if (data) munmap(const_cast<unsigned char*>(data), size);
+#endif
+    data = nullptr;
+    file = nullptr;
+    mapping = nullptr;
+    header = nullptr;
+    size = 0;
+    frameCount = 0;
+    index.clear();
+}
+
+const RecordedFrame& TelemetryRecording::Frame(uint64_t frameNumber) const {
+    return *reinterpret_cast<const RecordedFrame*>(data + header->headerSize + frameNumber * header->recordSize);
+}
+
+uint64_t TelemetryRecording::FindFrame(int64_t timestampMicros) const {
+    if (index.empty()) return frameCount;
+
+    // Last index entry at or before the time, then walk forward
+    auto it = std::upper_bound(index.begin(), index.end(), timestampMicros,
+        [](int64_t t, const RecordingIndexEntry& entry) { return t < entry.timestampMicros; });
+    uint64_t frameNumber = (it == index.begin()) ? 0 : (it - 1)->frameNumber;
+
+    while (frameNumber < frameCount && Frame(frameNumber).timestampMicros < timestampMicros) {
+        frameNumber++;
+    }
+    return frameNumber;
+}
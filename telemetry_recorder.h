@@ -0,0 +1,114 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "telemetry_layout.h"
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// Telemetry recordings (.gp2rec)
+// Every new game frame the reader sees, exactly as the game wrote it, plus when we saw it.
+//
+// File layout:
+//   RecordingHeader
+//   RecordedFrame x frameCount        fixed size, so frame N is at headerSize + N * recordSize
+//   RecordingIndexEntry x indexCount  one per RECORDING_INDEX_INTERVAL frames, written on stop
+//
+// The index turns "where is t = 12.5s" into a binary search over a few thousand entries plus a short scan.
+// If the app was killed before the index was written (indexOffset == 0) the reader rebuilds it from the frames.
+
+#define RECORDING_MAGIC "GP2FFBRC"
+#define RECORDING_VERSION 1
+#define RECORDING_INDEX_INTERVAL 64
+
+struct RecordingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t recordSize;
+    int32_t structSize;             // the game's SharedMemory::structSize when recording started
+    uint64_t frameCount;            // kept up to date while recording, so a crash still leaves a readable file
+    uint64_t indexOffset;           // 0 until the recording is stopped cleanly
+    uint64_t indexCount;
+    uint32_t indexInterval;
+    uint32_t reserved[3];
+};
+
+static_assert(sizeof(RecordingHeader) == 64, "RecordingHeader is part of the file format");
+
+struct RecordedFrame {
+    int64_t timestampMicros;        // since the recording started
+    uint64_t frameHash;
+    SharedMemory block;
+};
+
+struct RecordingIndexEntry {
+    int64_t timestampMicros;
+    uint64_t frameNumber;
+};
+
+struct TelemetryRecorderStats {
+    unsigned long long framesWritten = 0;
+    unsigned long long framesDropped = 0;   // queue was full - the writer thread fell behind
+    unsigned long long bytesWritten = 0;
+};
+
+// Include logging
+void LogMessage(const std::wstring& msg);
+
+// === Recording ===
+// The reader hands frames over with RecordTelemetryFrame, a background thread writes them
+// so the FFB tick only ever pays for a copy into the queue.
+
+bool StartTelemetryRecording(const std::wstring& path);
+void StopTelemetryRecording();
+bool IsTelemetryRecording();
+
+// Cheap no-op when not recording. timestampMicros can be any steady clock, the file stores it relative to the first frame
+void RecordTelemetryFrame(const SharedMemory& block, unsigned long long frameHash, int64_t timestampMicros);
+
+TelemetryRecorderStats GetTelemetryRecorderStats();
+
+// === Reading ===
+
+class TelemetryRecording {
+public:
+    TelemetryRecording() {}
+    ~TelemetryRecording();
+
+    bool Open(const std::wstring& path);
+    void Close();
+
+    uint64_t FrameCount() const { return frameCount; }
+    const RecordingHeader& Header() const { return *header; }
+
+    // Straight out of the mapped file, no copy
+    const RecordedFrame& Frame(uint64_t index) const;
+
+    // First frame with timestamp >= timestampMicros (FrameCount() if past the end)
+    uint64_t FindFrame(int64_t timestampMicros) const;
+
+private:
+    TelemetryRecording(const TelemetryRecording&) = delete;
+    TelemetryRecording& operator=(const TelemetryRecording&) = delete;
+
+    const unsigned char* data = nullptr;
+    uint64_t size = 0;
+    const RecordingHeader* header = nullptr;
+    uint64_t frameCount = 0;
+    std::vector<RecordingIndexEntry> index;
+    void* file = nullptr;       // platform handles, see telemetry_recorder.cpp
+    void* mapping = nullptr;
+};
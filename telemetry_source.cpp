@@ -0,0 +1,105 @@
+#include "telemetry_source.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+#ifdef _WIN32
+
+// === Win32 file mapping ===
+
+Win32MappingSource::Win32MappingSource(const char* mappingName) : mappingName(mappingName) {}
+
+Win32MappingSource::~Win32MappingSource() {
+    Close();
+}
+
+bool Win32MappingSource::Open() {
+    HANDLE hmap = OpenFileMappingA(FILE_MAP_READ, FALSE, mappingName.c_str());
+    if (!hmap) return false;
+
+    view = (const SharedMemory*)MapViewOfFile(hmap, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(hmap);
+        return false;
+    }
+    mapping = hmap;
+    return true;
+}
+
+void Win32MappingSource::Close() {
+    if (view) UnmapViewOfFile(view);
+    if (mapping) CloseHandle(static_cast<HANDLE>(mapping));
+    view = nullptr;
+    mapping = nullptr;
+}
+
+TelemetrySource* CreateDefaultTelemetrySource() {
+    return new Win32MappingSource();
+}
+
+#else
+
+// === POSIX shared memory ===
+
+PosixShmSource::PosixShmSource(const char* shmName) : shmName(shmName) {}
+
+PosixShmSource::~PosixShmSource() {
+    Close();
+}
+
+bool PosixShmSource::Open() {
+    int fd = shm_open(shmName.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+
+    // A writer that has created the object but not sized it yet isn't ready
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(SharedMemory))) {
+        close(fd);
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, sizeof(SharedMemory), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // the mapping keeps the object alive, the descriptor isn't needed
+    if (mapped == MAP_FAILED) return false;
+
+    view = static_cast<const SharedMemory*>(mapped);
+    return true;
+}
+
+void PosixShmSource::Close() {
+    if (view) munmap(const_cast<SharedMemory*>(view), sizeof(SharedMemory));
+    view = nullptr;
+}
+
+TelemetrySource* CreateDefaultTelemetrySource() {
+    return new PosixShmSource();
+}
+
+#endif
+
+// === In memory ===
+
+InMemoryTelemetrySource::InMemoryTelemetrySource() {
+    memset(&block, 0, sizeof(block));
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <string>
+#include "telemetry_layout.h"
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// Where the SharedMemory block comes from
+// The reader only ever snapshots View(), so anything that can hand it a block in the game's layout works:
+//  - Win32MappingSource: the real thing, x86GP2's "Local\x86GP2FFB" file mapping
+//  - PosixShmSource: the same block through shm_open/mmap, for reading and recording telemetry on Linux
+//    (the force code past the reader is DirectInput and stays Windows-only, see ffb_pipeline.h)
+//  - InMemoryTelemetrySource: a block we own, whoever holds the source writes frames into it
+
+class TelemetrySource {
+public:
+    virtual ~TelemetrySource() {}
+
+    virtual const wchar_t* Name() const = 0;
+
+    // Try to attach, false if the writer isn't there (yet). Called again after Close() to reattach
+    virtual bool Open() = 0;
+    virtual void Close() = 0;
+
+    // Only valid between a successful Open() and Close()
+    virtual const SharedMemory* View() const = 0;
+};
+
+#ifdef _WIN32
+
+class Win32MappingSource : public TelemetrySource {
+public:
+    explicit Win32MappingSource(const char* mappingName = "Local\\x86GP2FFB");
+    ~Win32MappingSource();
+
+    const wchar_t* Name() const override { return L"Win32 file mapping"; }
+    bool Open() override;
+    void Close() override;
+    const SharedMemory* View() const override { return view; }
+
+private:
+    std::string mappingName;
+    void* mapping = nullptr; // HANDLE, kept as void* so this header doesn't need windows.h
+    const SharedMemory* view = nullptr;
+};
+
+#else
+
+class PosixShmSource : public TelemetrySource {
+public:
+    explicit PosixShmSource(const char* shmName = "/x86GP2FFB");
+    ~PosixShmSource();
+
+    const wchar_t* Name() const override { return L"POSIX shared memory"; }
+    bool Open() override;
+    void Close() override;
+    const SharedMemory* View() const override { return view; }
+
+private:
+    std::string shmName;
+    const SharedMemory* view = nullptr;
+};
+
+#endif
+
+// Headless runs and benchmarks - write frames into Block() and the reader picks them up like the game's
+class InMemoryTelemetrySource : public TelemetrySource {
+public:
+    InMemoryTelemetrySource();
+
+    const wchar_t* Name() const override { return L"in-memory"; }
+    bool Open() override { return attached; }
+    void Close() override {}
+    const SharedMemory* View() const override { return &block; }
+
+    SharedMemory& Block() { return block; }
+
+    // Pretend the writer has gone away / come back, to exercise the reattach path
+    void SetAttached(bool value) { attached = value; }
+
+private:
+    SharedMemory block;
+    bool attached = true;
+};
+
+// The source for this platform (Win32 mapping on Windows, POSIX shm elsewhere)
+TelemetrySource* CreateDefaultTelemetrySource();
@@ -0,0 +1,259 @@
+#include "telemetry_wakeup.h"
+#include "logger.h"
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <semaphore.h>
+#include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+#endif
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// Uncomment to run the app on the old fixed 1ms sleep loop. tools/wakeup_bench.cpp compares all three modes
+//#define TELEMETRY_WAKEUP_LEGACY_SLEEP
+
+#define WAKEUP_EVENT_RETRY_MS 2000.0     // how often to check if the writer has started signalling
+#define WAKEUP_REPORT_INTERVAL 600       // log wakeup stats every ~10 seconds at 60fps
+#define WAKEUP_POLL_GUARD_MS 1.5         // start polling this long before the next frame is due
+#define WAKEUP_POLL_STEP_MS 0.5          // poll spacing once we are inside that window
+#define WAKEUP_DEFAULT_PERIOD_MS 16.67   // until we have learned the real one
+
+static TelemetryWakeupMode wakeupMode = TelemetryWakeupMode::AdaptivePoll;
+static TelemetryWakeupStats wakeupStats;
+
+static double framePeriodMs = WAKEUP_DEFAULT_PERIOD_MS;
+static double lastFrameMs = 0.0;
+static double lastEmptyPollMs = 0.0;
+static double lastEventAttemptMs = -WAKEUP_EVENT_RETRY_MS;
+static bool modePinned = false;         // SetTelemetryWakeupMode: no switching to the event on our own
+
+static double NowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+// === Platform bits ===
+
+#ifdef _WIN32
+
+static HANDLE frameEvent = NULL;
+
+// One timer per thread: the reader and the output stage both sleep here, and with a shared auto-reset
+// timer each SetWaitableTimer would replace the other's due time and a signal would only wake one of them
+struct SleepTimer {
+    HANDLE handle = NULL;
+    ~SleepTimer() { if (handle) CloseHandle(handle); }
+};
+static thread_local SleepTimer sleepTimer;
+
+static bool OpenFrameEvent() {
+    frameEvent = OpenEventA(SYNCHRONIZE, FALSE, "Local\\x86GP2FFBFrame");
+    return frameEvent != NULL;
+}
+
+static bool WaitFrameEvent(double timeoutMs) {
+    DWORD result = WaitForSingleObject(frameEvent, static_cast<DWORD>(std::ceil(timeoutMs)));
+    return result == WAIT_OBJECT_0;
+}
+
+// Sleep(1) is really ~15ms unless the timer resolution is raised, so use a high resolution waitable timer
+static void SleepMs(double ms) {
+    if (ms <= 0.0) return;
+
+    if (!sleepTimer.handle) {
+        sleepTimer.handle = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    }
+
+    if (sleepTimer.handle) {
+        LARGE_INTEGER due;
+        due.QuadPart = -static_cast<LONGLONG>(ms * 10000.0); // 100ns units, negative = relative
+        if (SetWaitableTimer(sleepTimer.handle, &due, 0, NULL, NULL, FALSE)) {
+            WaitForSingleObject(sleepTimer.handle, INFINITE);
+            return;
+        }
+    }
+
+    // Older Windows without high resolution timers
+    Sleep(static_cast<DWORD>(std::max(1.0, ms)));
+}
+
+#else
+
+static sem_t* frameSem = SEM_FAILED;
+
+static bool OpenFrameEvent() {
+    frameSem = sem_open("/x86GP2FFBFrame", 0);
+    return frameSem != SEM_FAILED;
+}
+
+static bool WaitFrameEvent(double timeoutMs) {
+    timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    long long nanos = deadline.tv_nsec + static_cast<long long>(timeoutMs * 1000000.0);
+    deadline.tv_sec += static_cast<time_t>(nanos / 1000000000LL);
+    deadline.tv_nsec = static_cast<long>(nanos % 1000000000LL);
+
+    int result;
+    do {
+        result = sem_timedwait(frameSem, &deadline);
+    } while (result != 0 && errno == EINTR);
+
+    if (result != 0) return false;
+
+    // The writer posts once per frame - if we fell behind, don't wake again for frames already gone
+    while (sem_trywait(frameSem) == 0) {}
+    return true;
+}
+
+static void SleepMs(double ms) {
+    if (ms <= 0.0) return;
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(ms / 1000.0);
+    ts.tv_nsec = static_cast<long>((ms - ts.tv_sec * 1000.0) * 1000000.0);
+    clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, nullptr);
+}
+
+#endif
+
+static const wchar_t* WakeupModeName(TelemetryWakeupMode mode) {
+    switch (mode) {
+    case TelemetryWakeupMode::Event: return L"event";
+    case TelemetryWakeupMode::AdaptivePoll: return L"adaptive poll";
+    default: return L"legacy 1ms sleep";
+    }
+}
+
+// === Main ===
+
+void PreciseSleepMs(double ms) {
+    SleepMs(ms);
+}
+
+void InitTelemetryWakeup() {
+#ifdef TELEMETRY_WAKEUP_LEGACY_SLEEP
+    wakeupMode = TelemetryWakeupMode::LegacySleep;
+#else
+    lastEventAttemptMs = NowMs();
+    wakeupMode = OpenFrameEvent() ? TelemetryWakeupMode::Event : TelemetryWakeupMode::AdaptivePoll;
+#endif
+    LogPrintf(L"[INFO] Telemetry wakeup mode: %ls", WakeupModeName(wakeupMode));
+}
+
+void SetTelemetryWakeupMode(TelemetryWakeupMode mode) {
+    bool eventOpen = wakeupMode == TelemetryWakeupMode::Event;
+    if (mode == TelemetryWakeupMode::Event && !eventOpen && !OpenFrameEvent()) mode = TelemetryWakeupMode::AdaptivePoll;
+    wakeupMode = mode;
+    modePinned = true;
+
+    wakeupStats = TelemetryWakeupStats();
+    framePeriodMs = WAKEUP_DEFAULT_PERIOD_MS;
+    lastFrameMs = 0.0;
+    lastEmptyPollMs = 0.0;
+    LogPrintf(L"[INFO] Telemetry wakeup mode: %ls", WakeupModeName(wakeupMode));
+}
+
+bool WaitForTelemetryFrame(double timeoutMs) {
+    wakeupStats.waits++;
+    if (timeoutMs <= 0.0) return false;
+
+    if (wakeupMode == TelemetryWakeupMode::Event) {
+        if (WaitFrameEvent(timeoutMs)) {
+            wakeupStats.eventWakeups++;
+            return true;
+        }
+        return false;
+    }
+
+    if (wakeupMode == TelemetryWakeupMode::LegacySleep) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return false;
+    }
+
+    double now = NowMs();
+
+    // Writer may have started signalling since we last looked
+    if (!modePinned && now - lastEventAttemptMs >= WAKEUP_EVENT_RETRY_MS) {
+        lastEventAttemptMs = now;
+        if (OpenFrameEvent()) {
+            wakeupMode = TelemetryWakeupMode::Event;
+            LogPrintf(L"[INFO] Telemetry wakeup mode: %ls", WakeupModeName(wakeupMode));
+            return WaitForTelemetryFrame(timeoutMs);
+        }
+    }
+
+    // Sleep through most of the frame, then poll finely until it turns up
+    // If it is well overdue the game is paused or loading, so back off instead of polling hard
+    double nextFrameDue = lastFrameMs + framePeriodMs - WAKEUP_POLL_GUARD_MS;
+    double sleepMs = WAKEUP_POLL_STEP_MS;
+    if (now < nextFrameDue) {
+        sleepMs = nextFrameDue - now;
+    }
+    else if (now > lastFrameMs + 2.0 * framePeriodMs) {
+        sleepMs = framePeriodMs / 4.0;
+    }
+    SleepMs(std::min(sleepMs, timeoutMs));
+    return false;
+}
+
+void NotifyTelemetryPoll(bool newFrame) {
+    double now = NowMs();
+
+    if (!newFrame) {
+        wakeupStats.polls++;
+        lastEmptyPollMs = now;
+        return;
+    }
+
+    wakeupStats.frames++;
+
+    if (lastFrameMs > 0.0) {
+        // Learn the game's frame period, ignoring pauses and loading stalls
+        double gap = now - lastFrameMs;
+        if (gap > 2.0 && gap < 100.0) {
+            framePeriodMs = 0.9 * framePeriodMs + 0.1 * gap;
+        }
+
+        // How long could the frame have been sitting there before we saw it?
+        if (wakeupMode != TelemetryWakeupMode::Event && lastEmptyPollMs > lastFrameMs) {
+            double window = now - lastEmptyPollMs;
+            wakeupStats.totalDetectWindowMs += window;
+            if (window > wakeupStats.maxDetectWindowMs) wakeupStats.maxDetectWindowMs = window;
+        }
+    }
+    lastFrameMs = now;
+    wakeupStats.framePeriodMs = framePeriodMs;
+
+    if (wakeupStats.frames % WAKEUP_REPORT_INTERVAL == 0) {
+        LogPrintf(L"[INFO] Telemetry wakeup (%ls): frame period %f ms, detect window avg %f ms, max %f ms, "
+            L"empty polls per frame %f", WakeupModeName(wakeupMode), framePeriodMs,
+            wakeupStats.totalDetectWindowMs / wakeupStats.frames, wakeupStats.maxDetectWindowMs,
+            static_cast<double>(wakeupStats.polls) / wakeupStats.frames);
+    }
+}
+
+TelemetryWakeupMode GetTelemetryWakeupMode() {
+    return wakeupMode;
+}
+
+TelemetryWakeupStats GetTelemetryWakeupStats() {
+    return wakeupStats;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+
+// Waking the process thread when x86GP2 publishes a frame
+// If the writer signals a named event ("Local\x86GP2FFBFrame" on Windows, "/x86GP2FFBFrame" semaphore on Linux)
+// we block on that. The game itself doesn't do this yet, so otherwise we fall back to an adaptive poll
+// which learns the game's frame period and sleeps until just before the next frame is due.
+
+enum class TelemetryWakeupMode {
+    Event,          // writer signals us, zero polling
+    AdaptivePoll,   // sleep most of the frame, poll finely around when the next one is due
+    LegacySleep     // the old fixed 1ms sleep, kept to compare against
+};
+
+struct TelemetryWakeupStats {
+    unsigned long long waits = 0;
+    unsigned long long polls = 0;          // reads that found nothing new
+    unsigned long long frames = 0;         // reads that found a new frame
+    unsigned long long eventWakeups = 0;
+    double totalDetectWindowMs = 0.0;      // time between the last empty poll and the poll that saw the frame
+    double maxDetectWindowMs = 0.0;
+    double framePeriodMs = 0.0;            // learned game frame period
+};
+
+// Include logging
+void LogMessage(const std::wstring& msg);
+
+// Pick a mode - tries to open the writer's event first
+void InitTelemetryWakeup();
+
+// Use this mode from now on and learn the frame timing over, for comparing them (tools/wakeup_bench.cpp).
+// Event falls back to the adaptive poll if the writer's event isn't there
+void SetTelemetryWakeupMode(TelemetryWakeupMode mode);
+
+// Blocks until a new frame is likely (or signalled), or timeoutMs has passed
+// Returns true if the writer's event woke us
+bool WaitForTelemetryFrame(double timeoutMs);
+
+// Tell the waiter what the last read found so it can learn the frame timing
+void NotifyTelemetryPoll(bool newFrame);
+
+// The same high resolution sleep the adaptive poll uses, for other threads that wait on the FFB clock.
+// Any thread, each one gets its own timer
+void PreciseSleepMs(double ms);
+
+TelemetryWakeupMode GetTelemetryWakeupMode();
+TelemetryWakeupStats GetTelemetryWakeupStats();
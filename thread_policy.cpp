@@ -0,0 +1,228 @@
+#include "thread_policy.h"
+#include <algorithm>
+#include <cwctype>
+#include <mutex>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+#define THREAD_MAX_CPUS 64          // affinity is kept as a 64 bit mask
+#define THREAD_HIGH_NICE -10        // Linux "high"
+
+static std::mutex policyMutex;
+static ThreadPolicy threadPolicy;
+
+static std::wstring Trim(const std::wstring& s) {
+    size_t start = s.find_first_not_of(L" \t\r\n");
+    if (start == std::wstring::npos) return L"";
+    size_t end = s.find_last_not_of(L" \t\r\n");
+    return s.substr(start, end - start + 1);
+}
+
+static std::wstring Lower(std::wstring s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](wchar_t c) { return static_cast<wchar_t>(towlower(c)); });
+    return s;
+}
+
+// "2,3" / "4-7" / "0,2-3" -> mask, false if it doesn't parse or names a CPU past THREAD_MAX_CPUS
+static bool ParseCpuList(const std::wstring& text, unsigned long long& mask) {
+    mask = 0;
+    std::wstringstream ss(text);
+    std::wstring item;
+    while (std::getline(ss, item, L',')) {
+        item = Trim(item);
+        if (item.empty()) return false;
+        try {
+            size_t dash = item.find(L'-');
+            int first = std::stoi(item.substr(0, dash));
+            int last = dash == std::wstring::npos ? first : std::stoi(item.substr(dash + 1));
+            if (first < 0 || last < first || last >= THREAD_MAX_CPUS) return false;
+            for (int cpu = first; cpu <= last; cpu++) mask |= 1ULL << cpu;
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+    }
+    return mask != 0;
+}
+
+static std::wstring CpuListName(unsigned long long mask) {
+    if (mask == 0) return L"any CPU";
+    std::wstring list;
+    for (int cpu = 0; cpu < THREAD_MAX_CPUS; cpu++) {
+        if (!(mask & (1ULL << cpu))) continue;
+        if (!list.empty()) list += L",";
+        list += std::to_wstring(cpu);
+    }
+    return (mask & (mask - 1)) ? L"CPUs " + list : L"CPU " + list;
+}
+
+ThreadPolicy ParseThreadPolicy(const std::wstring& priority, const std::wstring& realtimePriority, const std::wstring& affinity) {
+    ThreadPolicy policy;
+
+    std::wstring name = Lower(Trim(priority));
+    if (name.empty() || name == L"normal") policy.priority = ThreadPriorityClass::Normal;
+    else if (name == L"high") policy.priority = ThreadPriorityClass::High;
+    else if (name == L"realtime") policy.priority = ThreadPriorityClass::Realtime;
+    else LogMessage(L"[WARNING] Thread Priority '" + priority + L"' not recognised, using normal");
+
+    std::wstring level = Trim(realtimePriority);
+    if (!level.empty()) {
+        try {
+            policy.realtimePriority = std::clamp(std::stoi(level), THREAD_RT_PRIORITY_MIN, THREAD_RT_PRIORITY_MAX);
+        }
+        catch (const std::exception&) {
+            LogMessage(L"[WARNING] Realtime Priority '" + realtimePriority + L"' is not a number, using " +
+                std::to_wstring(THREAD_RT_PRIORITY_DEFAULT));
+        }
+    }
+
+    std::wstring cpus = Lower(Trim(affinity));
+    if (!cpus.empty() && cpus != L"any" && !ParseCpuList(cpus, policy.affinityMask)) {
+        LogMessage(L"[WARNING] Thread Affinity '" + affinity + L"' not recognised, running on any CPU");
+        policy.affinityMask = 0;
+    }
+    return policy;
+}
+
+const wchar_t* ThreadPriorityClassName(ThreadPriorityClass priority) {
+    switch (priority) {
+    case ThreadPriorityClass::High: return L"high";
+    case ThreadPriorityClass::Realtime: return L"realtime";
+    default: return L"normal";
+    }
+}
+
+std::wstring DescribeThreadPolicy(const ThreadPolicy& policy) {
+    std::wstring text = ThreadPriorityClassName(policy.priority);
+#ifndef _WIN32
+    if (policy.priority == ThreadPriorityClass::Realtime) text += L" (" + std::to_wstring(policy.realtimePriority) + L")";
+#endif
+    return text + L", " + CpuListName(policy.affinityMask);
+}
+
+void SetThreadPolicy(const ThreadPolicy& policy) {
+    std::lock_guard<std::mutex> lock(policyMutex);
+    threadPolicy = policy;
+}
+
+ThreadPolicy GetThreadPolicy() {
+    std::lock_guard<std::mutex> lock(policyMutex);
+    return threadPolicy;
+}
+
+// === Platform bits ===
+// Each returns 0 on success or the OS error code
+
+#ifdef _WIN32
+
+static unsigned long ApplyPriority(const ThreadPolicy& policy) {
+    int threadPriority = THREAD_PRIORITY_NORMAL;
+    if (policy.priority == ThreadPriorityClass::High) threadPriority = THREAD_PRIORITY_HIGHEST;
+    if (policy.priority == ThreadPriorityClass::Realtime) {
+        // Time critical only reaches 15 from inside the high class, otherwise it is still below the game
+        if (!SetPriorityClass(GetCurrentProcess(), HIGH_PRIORITY_CLASS)) return GetLastError();
+        threadPriority = THREAD_PRIORITY_TIME_CRITICAL;
+    }
+    return SetThreadPriority(GetCurrentThread(), threadPriority) ? 0 : GetLastError();
+}
+
+static unsigned long ApplyAffinity(const ThreadPolicy& policy) {
+    DWORD_PTR processMask = 0, systemMask = 0;
+    if (GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask) &&
+        (static_cast<DWORD_PTR>(policy.affinityMask) & processMask) == 0) {
+        return ERROR_INVALID_PARAMETER;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(policy.affinityMask)) ? 0 : GetLastError();
+}
+
+#else
+
+static unsigned long ApplyPriority(const ThreadPolicy& policy) {
+    if (policy.priority == ThreadPriorityClass::Realtime) {
+        sched_param param = {};
+        param.sched_priority = policy.realtimePriority;
+        return static_cast<unsigned long>(pthread_setschedparam(pthread_self(), SCHED_FIFO, &param));
+    }
+    // Per thread nice on Linux is setpriority on the thread id
+    int nice = policy.priority == ThreadPriorityClass::High ? THREAD_HIGH_NICE : 0;
+    if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), nice) != 0) return static_cast<unsigned long>(errno);
+    return 0;
+}
+
+static unsigned long ApplyAffinity(const ThreadPolicy& policy) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu = 0; cpu < THREAD_MAX_CPUS; cpu++) {
+        if (policy.affinityMask & (1ULL << cpu)) CPU_SET(cpu, &set);
+    }
+    return static_cast<unsigned long>(pthread_setaffinity_np(pthread_self(), sizeof(set), &set));
+}
+
+#endif
+
+bool ApplyThreadPolicy(const wchar_t* threadName) {
+    ThreadPolicy policy = GetThreadPolicy();
+    std::wstring name = threadName;
+    bool applied = true;
+
+    if (policy.priority != ThreadPriorityClass::Normal) {
+        unsigned long error = ApplyPriority(policy);
+        if (error != 0) {
+            LogMessage(L"[WARNING] " + name + L" thread: could not set " + ThreadPriorityClassName(policy.priority) +
+                L" priority (error " + std::to_wstring(error) + L"), staying at normal");
+            policy.priority = ThreadPriorityClass::Normal;
+            applied = false;
+        }
+    }
+
+    if (policy.affinityMask != 0) {
+        unsigned long error = ApplyAffinity(policy);
+        if (error != 0) {
+            LogMessage(L"[WARNING] " + name + L" thread: could not pin to " + CpuListName(policy.affinityMask) +
+                L" (error " + std::to_wstring(error) + L"), running on any CPU");
+            policy.affinityMask = 0;
+            applied = false;
+        }
+    }
+
+    LogMessage(L"[INFO] " + name + L" thread: " + DescribeThreadPolicy(policy));
+    return applied;
+}
+
+void ApplyBackgroundPriority(const wchar_t* threadName) {
+#ifdef _WIN32
+    unsigned long error = SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST) ? 0 : GetLastError();
+#else
+    sched_param param = {};
+    unsigned long error = static_cast<unsigned long>(pthread_setschedparam(pthread_self(), SCHED_IDLE, &param));
+#endif
+    if (error != 0) {
+        LogMessage(L"[WARNING] " + std::wstring(threadName) + L" thread: could not lower its priority (error " +
+            std::to_wstring(error) + L")");
+    }
+}
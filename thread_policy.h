@@ -0,0 +1,67 @@
+#pragma once
+#include <string>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// Scheduling for the FFB threads (reader, compute, output, device I/O)
+// With the game, OBS and voice chat all wanting the CPU a normal priority thread gets preempted
+// mid-tick and the wheel hitches. ffb.ini picks a priority and the CPUs to run on, each FFB thread
+// applies it to itself when it starts. The display thread keeps its normal thread priority.
+//
+//   normal   - leave it to the OS
+//   high     - Windows THREAD_PRIORITY_HIGHEST, Linux nice -10
+//   realtime - Windows HIGH_PRIORITY_CLASS + THREAD_PRIORITY_TIME_CRITICAL, Linux SCHED_FIFO at Realtime Priority
+//
+// Windows' REALTIME_PRIORITY_CLASS is never used, a spinning thread up there can starve the input stack.
+// Linux needs CAP_SYS_NICE (or an rtprio limit) for high/realtime, without it we log and carry on as normal.
+
+#define THREAD_RT_PRIORITY_MIN 1
+#define THREAD_RT_PRIORITY_MAX 99
+#define THREAD_RT_PRIORITY_DEFAULT 50
+
+enum class ThreadPriorityClass {
+    Normal,
+    High,
+    Realtime
+};
+
+struct ThreadPolicy {
+    ThreadPriorityClass priority = ThreadPriorityClass::Normal;
+    int realtimePriority = THREAD_RT_PRIORITY_DEFAULT;  // SCHED_FIFO priority, Linux only
+    unsigned long long affinityMask = 0;                // bit n = CPU n, 0 = any CPU
+};
+
+// Include logging
+void LogMessage(const std::wstring& msg);
+
+// From the ffb.ini strings, anything it can't read falls back to the default with a warning
+// Affinity is a CPU list like "2,3" or "4-7", empty or "any" for no pinning
+ThreadPolicy ParseThreadPolicy(const std::wstring& priority, const std::wstring& realtimePriority, const std::wstring& affinity);
+
+const wchar_t* ThreadPriorityClassName(ThreadPriorityClass priority);
+
+// "realtime (50), CPUs 2,3"
+std::wstring DescribeThreadPolicy(const ThreadPolicy& policy);
+
+// Set once before the FFB threads start
+void SetThreadPolicy(const ThreadPolicy& policy);
+ThreadPolicy GetThreadPolicy();
+
+// Call at the top of each FFB thread. Logs what it got, false if any part was refused
+bool ApplyThreadPolicy(const wchar_t* threadName);
+
+// For helper threads that answer the outside world (the control channel) - they only get the CPU when
+// no FFB thread wants it. Windows THREAD_PRIORITY_LOWEST, Linux SCHED_IDLE. Needs no privileges
+void ApplyBackgroundPriority(const wchar_t* threadName);
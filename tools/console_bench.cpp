@@ -0,0 +1,153 @@
+// console_bench.cpp
+// Times the display's refresh both ways: the old one (~45 padded lines streamed through std::wcout, the
+// cursor moved back to the top each time) and ConsoleScreen (diff against what is shown, one write of the
+// changes). Each frame is laid out like the live display, with about a dozen figures moving every frame
+// the way telemetry and forces do and the rest standing still.
+//
+// Usage: console_bench [frames] 2> bench.txt
+//   default is 2000 frames of each. The screen goes to the console, the figures to stderr - run it in the
+//   console you care about, most of the old path's time is the console's own
+//
+// Builds on Windows and Linux with:
+//   console_screen.cpp logger.cpp ffb_clock.cpp thread_policy.cpp
+
+#include "../console_screen.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+#define BENCH_LINES 45
+
+// What one refresh shows: a few figures that move every frame, the rest as good as fixed
+struct BenchFrame {
+    int frame;
+    double speed, rpm, steer, lateralG, longitudinalG, yawRate;
+    double constant, damper, spring, vibration, output;
+};
+
+static BenchFrame MakeFrame(int i) {
+    BenchFrame f;
+    f.frame = i;
+    f.speed = 180.0 + (i % 400) * 0.25;
+    f.rpm = 11000.0 + (i * 37) % 3000;
+    f.steer = ((i * 13) % 200 - 100) * 0.01;
+    f.lateralG = ((i * 7) % 300 - 150) * 0.02;
+    f.longitudinalG = ((i * 11) % 200 - 100) * 0.015;
+    f.yawRate = ((i * 5) % 180 - 90) * 0.1;
+    f.constant = ((i * 17) % 200 - 100) * 1.0;
+    f.damper = (i % 50) * 0.5;
+    f.spring = 40.0;
+    f.vibration = (i % 8) * 1.25;
+    f.output = f.constant * 0.8;
+    return f;
+}
+
+// Line n of the display, laid out the same for both paths
+static std::wstring FrameLine(const BenchFrame& f, int n) {
+    std::wostringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    switch (n) {
+    case 0: ss << L"GP2 FFB Program"; break;
+    case 2: ss << L"Connected Device: Bench Wheel"; break;
+    case 3: ss << L"Game: GP2"; break;
+    case 4: ss << L"Master Force Scale: 80.00%"; break;
+    case 6: ss << L"      == Raw Data =="; break;
+    case 8: ss << L"Frame: " << std::setw(10) << f.frame; break;
+    case 9: ss << L"Speed: " << std::setw(10) << f.speed << L" km/h"; break;
+    case 10: ss << L"RPM: " << std::setw(10) << f.rpm; break;
+    case 11: ss << L"Steer: " << std::setw(10) << f.steer; break;
+    case 13: ss << L"      == Vehicle Dynamics =="; break;
+    case 15: ss << L"Lateral G: " << std::setw(10) << f.lateralG; break;
+    case 16: ss << L"Longitudinal G: " << std::setw(10) << f.longitudinalG; break;
+    case 17: ss << L"Yaw Rate: " << std::setw(10) << f.yawRate << L" deg/s"; break;
+    case 19: ss << L"      == Forces =="; break;
+    case 21: ss << L"Constant: " << std::setw(10) << f.constant << L"%"; break;
+    case 22: ss << L"Damper: " << std::setw(10) << f.damper << L"%"; break;
+    case 23: ss << L"Spring: " << std::setw(10) << f.spring << L"%"; break;
+    case 24: ss << L"Vibration: " << std::setw(10) << f.vibration << L"%"; break;
+    case 25: ss << L"Output: " << std::setw(10) << f.output << L"%"; break;
+    default:
+        if (n >= 28) ss << L"[INFO] Log line " << n - 27 << L" that doesn't change between refreshes";
+        break;
+    }
+    return ss.str();
+}
+
+static void MoveCursorToTop() {
+#ifdef _WIN32
+    COORD topLeft = { 0, 0 };
+    SetConsoleCursorPosition(GetStdHandle(STD_OUTPUT_HANDLE), topLeft);
+#else
+    std::wcout << L"\x1b[H";
+#endif
+}
+
+// The way the display used to refresh
+static void OldRefresh(const BenchFrame& f) {
+    MoveCursorToTop();
+    for (int n = 0; n < BENCH_LINES; n++) {
+        std::wstring padded = FrameLine(f, n);
+        if (padded.length() < CONSOLE_SCREEN_WIDTH) padded.append(CONSOLE_SCREEN_WIDTH - padded.length(), L' ');
+        else padded = padded.substr(0, CONSOLE_SCREEN_WIDTH);
+        std::wcout << padded << L"\n";
+    }
+    std::wcout.flush();
+}
+
+static void ScreenRefresh(ConsoleScreen& screen, const BenchFrame& f) {
+    screen.Begin();
+    for (int n = 0; n < BENCH_LINES; n++) screen.Print(L"%ls", FrameLine(f, n).c_str());
+    screen.Present();
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 2000;
+    if (frames < 1) frames = 1;
+
+    // Formatting the lines is the same work either way, timed on its own so it can be taken out
+    auto start = std::chrono::steady_clock::now();
+    size_t characters = 0;
+    for (int i = 0; i < frames; i++) {
+        BenchFrame f = MakeFrame(i);
+        for (int n = 0; n < BENCH_LINES; n++) characters += FrameLine(f, n).size();
+    }
+    double formatUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / frames;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++) OldRefresh(MakeFrame(i));
+    double oldUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / frames;
+
+    ConsoleScreen screen;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++) ScreenRefresh(screen, MakeFrame(i));
+    double screenUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / frames;
+    ConsoleScreenStats stats = screen.Stats();
+
+    fprintf(stderr, "%d frames of %d lines (%zu characters formatted)\n", frames, BENCH_LINES, characters);
+    fprintf(stderr, "  formatting alone     %8.1f us/frame\n", formatUs);
+    fprintf(stderr, "  old std::wcout path  %8.1f us/frame, %d lines written a frame\n", oldUs, BENCH_LINES);
+    fprintf(stderr, "  ConsoleScreen        %8.1f us/frame, %.1f cells and %.2f writes a frame\n", screenUs,
+        static_cast<double>(stats.cellsWritten) / stats.frames, static_cast<double>(stats.writes) / stats.frames);
+    return 0;
+}
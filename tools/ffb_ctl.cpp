@@ -0,0 +1,247 @@
+// ffb_ctl.cpp
+// Talks to a running FFB app over its control channel (control_channel.h).
+//
+// Usage: ffb_ctl <request...>      e.g. ffb_ctl set force 40
+//                                       ffb_ctl effect damper off
+//                                       ffb_ctl stats
+//        ffb_ctl --bench [N]       N requests (default 20000) as fast as the channel answers, with the
+//                                  app's tick jitter read before and after
+//
+// --bench is how the channel is checked for jitter: run it against the app while racing (or with
+// x86gp2_standin) and the tick jitter/overrun/preemption lines should not move. It mixes stats, get, config
+// and a set to the current Force, which is checked but makes no new snapshot, so it can run forever.
+// On a machine with few cores start ffb_ctl itself at low priority ("start /low", "chrt -i 0") so its own
+// CPU time isn't what the ticks feel.
+//
+// Builds on its own, nothing else from the app needed.
+
+#include "../control_channel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+#define BENCH_DEFAULT_REQUESTS 20000
+#define BENCH_SETTLE_MS 1000        // let the tick stats window move on before reading them again
+
+// Not linked with the app, the header wants this for the server side
+void LogMessage(const std::wstring&) {}
+
+class ControlConnection {
+public:
+    ~ControlConnection() { Close(); }
+
+#ifdef _WIN32
+    bool Open() {
+        for (int attempt = 0; attempt < 2; attempt++) {
+            pipe = CreateFileW(CONTROL_PIPE_NAME, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+            if (pipe != INVALID_HANDLE_VALUE) return true;
+            if (GetLastError() != ERROR_PIPE_BUSY || !WaitNamedPipeW(CONTROL_PIPE_NAME, 2000)) return false;
+        }
+        return false;
+    }
+    void Close() {
+        if (pipe != INVALID_HANDLE_VALUE) CloseHandle(pipe);
+        pipe = INVALID_HANDLE_VALUE;
+    }
+    bool Write(const std::string& data) {
+        DWORD written = 0;
+        return WriteFile(pipe, data.data(), static_cast<DWORD>(data.size()), &written, NULL) && written == data.size();
+    }
+    int Read(char* data, int size) {
+        DWORD got = 0;
+        return ReadFile(pipe, data, static_cast<DWORD>(size), &got, NULL) ? static_cast<int>(got) : -1;
+    }
+#else
+    bool Open() {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        snprintf(address.sun_path, sizeof(address.sun_path), "%s", CONTROL_SOCKET_PATH);
+        return fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+    }
+    void Close() {
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+    bool Write(const std::string& data) {
+        return send(fd, data.data(), data.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(data.size());
+    }
+    int Read(char* data, int size) {
+        return static_cast<int>(recv(fd, data, size, 0));
+    }
+#endif
+
+    // Whole reply, up to and including the "ok"/"error" line. False if the connection dropped
+    bool Request(const std::string& line, std::string& reply, bool& ok) {
+        reply.clear();
+        if (!Write(line + "\n")) return false;
+        while (true) {
+            size_t newline;
+            while ((newline = pending.find('\n')) != std::string::npos) {
+                std::string replyLine = pending.substr(0, newline + 1);
+                pending.erase(0, newline + 1);
+                reply += replyLine;
+                if (replyLine == "ok\n" || replyLine.rfind("error", 0) == 0) {
+                    ok = replyLine == "ok\n";
+                    return true;
+                }
+            }
+            char buffer[4096];
+            int length = Read(buffer, static_cast<int>(sizeof(buffer)));
+            if (length <= 0) return false;
+            pending.append(buffer, length);
+        }
+    }
+
+private:
+#ifdef _WIN32
+    HANDLE pipe = INVALID_HANDLE_VALUE;
+#else
+    int fd = -1;
+#endif
+    std::string pending;
+};
+
+// "name value" out of a stats/config reply
+static bool FindValue(const std::string& reply, const std::string& name, double& value) {
+    size_t at = 0;
+    while (at < reply.size()) {
+        size_t end = reply.find('\n', at);
+        if (end == std::string::npos) end = reply.size();
+        std::string line = reply.substr(at, end - at);
+        if (line.rfind(name + " ", 0) == 0) {
+            value = atof(line.c_str() + name.size() + 1);
+            return true;
+        }
+        at = end + 1;
+    }
+    return false;
+}
+
+struct TickSnapshot {
+    double jitterP99 = 0.0;
+    double wakeLateP99 = 0.0;
+    double overruns = 0.0;
+    double preemptions = 0.0;
+};
+
+static bool ReadTickStats(ControlConnection& connection, TickSnapshot& snapshot) {
+    std::string reply;
+    bool ok = false;
+    if (!connection.Request("stats", reply, ok) || !ok) return false;
+    FindValue(reply, "tick_jitter_p99_ms", snapshot.jitterP99);
+    FindValue(reply, "tick_wake_late_p99_ms", snapshot.wakeLateP99);
+    FindValue(reply, "tick_overruns", snapshot.overruns);
+    FindValue(reply, "tick_preemptions", snapshot.preemptions);
+    return true;
+}
+
+static int RunBench(ControlConnection& connection, int requests) {
+    std::string reply;
+    bool ok = false;
+    double force = 0.0;
+    if (!connection.Request("config", reply, ok) || !ok || !FindValue(reply, "force", force)) {
+        printf("[ERROR] Could not read the config\n");
+        return 1;
+    }
+    char setForce[64];
+    snprintf(setForce, sizeof(setForce), "set force %g", force);
+    const char* mix[] = { "stats", "get tick_jitter_p99_ms", "config", setForce };
+
+    TickSnapshot before, after;
+    if (!ReadTickStats(connection, before)) {
+        printf("[ERROR] Could not read the stats\n");
+        return 1;
+    }
+
+    std::vector<double> latencyUs;
+    latencyUs.reserve(requests);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < requests; i++) {
+        auto sent = std::chrono::steady_clock::now();
+        if (!connection.Request(mix[i % 4], reply, ok)) {
+            printf("[ERROR] Connection dropped after %d requests\n", i);
+            return 1;
+        }
+        if (!ok) printf("[WARNING] '%s' -> %s", mix[i % 4], reply.c_str());
+        latencyUs.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sent).count());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(BENCH_SETTLE_MS));
+    if (!ReadTickStats(connection, after)) {
+        printf("[ERROR] Could not read the stats\n");
+        return 1;
+    }
+
+    std::sort(latencyUs.begin(), latencyUs.end());
+    printf("%d requests in %.2f s (%.0f/s)\n", requests, seconds, requests / seconds);
+    printf("round trip: p50 %.1f us, p99 %.1f us, max %.1f us\n", latencyUs[latencyUs.size() / 2],
+        latencyUs[static_cast<size_t>(latencyUs.size() * 0.99)], latencyUs.back());
+    printf("tick jitter p99: %.3f ms before, %.3f ms after\n", before.jitterP99, after.jitterP99);
+    printf("tick wake late p99: %.3f ms before, %.3f ms after\n", before.wakeLateP99, after.wakeLateP99);
+    printf("tick overruns: +%.0f, preempted while spinning: +%.0f\n", after.overruns - before.overruns,
+        after.preemptions - before.preemptions);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printf("Usage: ffb_ctl <request...>   (try: ffb_ctl help)\n"
+               "       ffb_ctl --bench [N]\n");
+        return 1;
+    }
+
+    ControlConnection connection;
+    if (!connection.Open()) {
+        printf("[ERROR] The FFB app isn't running, or has Control Channel: false\n");
+        return 1;
+    }
+
+    if (strcmp(argv[1], "--bench") == 0) {
+        int requests = argc > 2 ? atoi(argv[2]) : BENCH_DEFAULT_REQUESTS;
+        return RunBench(connection, std::max(requests, 1));
+    }
+
+    std::string line;
+    for (int i = 1; i < argc; i++) {
+        if (i > 1) line += " ";
+        line += argv[i];
+    }
+
+    std::string reply;
+    bool ok = false;
+    if (!connection.Request(line, reply, ok)) {
+        printf("[ERROR] Connection dropped\n");
+        return 1;
+    }
+    fputs(reply.c_str(), stdout);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,362 @@
+// ffb_replay.cpp
+// Pushes a telemetry recording (.gp2rec, see telemetry_recorder.h) through the real force code
+// as fast as the CPU allows, and writes out the force that would have gone to the wheel.
+//
+// Usage: ffb_replay recording.gp2rec [--out forces.csv] [--ini ffb.ini] [--tick-ms N] [--rate HZ]
+//                   [--upsampling off|linear|hermite] [--predict] [--verbose]
+//   --out:        force stream as CSV (default: <recording>.forces.csv)
+//   --ini:        settings to replay with (default: ffb.ini)
+//   --tick-ms:    FFB tick on the simulated clock (default 16.67 like the app, 0 = run every recorded frame)
+//   --rate:       FFB tick as an output rate instead, e.g. --rate 1000
+//   --upsampling: constant force upsampling between frames (default: the ini's Upsampling)
+//   --predict:    upsample ahead of the newest frame instead of a frame behind
+//   --verbose:    pass the force code's [DEBUG]/[INFO] logging through (slow, [DEBUG] needs FFB_LOG_LEVEL 4, see logger.h)
+//
+// The summary has the wall time each tick took through the real FFBOutput, so on Windows "--rate 1000
+// --upsampling hermite" shows what a 1kHz tick costs on a recording. tools/tick_bench.cpp times the same
+// tick work without DirectInput, on any platform.
+//
+// Frames go through the same reader (via an in-memory source), CalculateVehicleDynamics and
+// ApplyConstantForceEffect as live, into a ForceFrame like the compute stage makes. The FFB ticks are
+// the output stage's own FFBOutput (ffb_output.h): frame lock, upsampler and update gates, on the tick grid
+// the frame lock steers. Time comes from a SimulatedFFBClock stepped to each frame's recorded timestamp and
+// each tick's deadline, so everything lands where it would have, just without waiting for it.
+// The device is a stand-in effect that keeps whatever the ticks send it.
+//
+// Builds on Windows with the app's sources minus main.cpp:
+//   ffb_settings_text.cpp, ffb_config.cpp, forces/constant_force.cpp, calculations/vehicle_dynamics.cpp, telemetry_reader.cpp,
+//   telemetry_source.cpp, telemetry_recorder.cpp, ffb_clock.cpp, forces/force_upsampler.cpp, game_state.cpp,
+//   ffb_output.cpp, ffb_pipeline.cpp, ffb_scheduler.cpp, frame_lock.cpp, effect_update.cpp
+//   (+ dinput8.lib, dxguid.lib)
+
+#include "../telemetry_reader.h"
+#include "../telemetry_source.h"
+#include "../telemetry_recorder.h"
+#include "../ffb_clock.h"
+#include "../ffb_settings_text.h"
+#include "../ffb_config.h"
+#include "../game_state.h"
+#include "../calculations/vehicle_dynamics.h"
+#include "../forces/constant_force.h"
+#include "../forces/force_upsampler.h"
+#include "../forces/periodic_force.h"
+#include "../forces/damper_effect.h"
+#include "../forces/spring_effect.h"
+#include "../ffb_output.h"
+#include "../logger.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+#define REPLAY_DEFAULT_TICK_MS 16.67 // FFB_INTERVAL in main.cpp
+#define REPLAY_OUTPUT_BUFFER (1 << 20)
+
+// What main.cpp provides to the force code live
+IDirectInputEffect* constantForceEffect = nullptr;
+std::atomic<int> g_currentFFBForce{ 0 };
+std::atomic<int> g_currentFrontLoad{ 0 };
+
+static bool verboseLogging = false;
+
+void LogMessage(const std::wstring& msg) {
+    if (verboseLogging || msg.rfind(L"[ERROR]", 0) == 0 || msg.rfind(L"[WARNING]", 0) == 0) {
+        fwprintf(stderr, L"%ls\n", msg.c_str());
+    }
+}
+
+void LogPrintf(const wchar_t* format, ...) {
+    wchar_t buffer[LOG_RECORD_CHARS];
+    va_list args;
+    va_start(args, format);
+    if (vswprintf(buffer, LOG_RECORD_CHARS, format, args) < 0) buffer[LOG_RECORD_CHARS - 1] = L'\0';
+    va_end(args);
+    LogMessage(buffer);
+}
+
+// === Stand-in device ===
+// Looks like a DirectInput effect to EffectCommand::Apply, keeps the last constant force it was sent
+
+class CapturingEffect : public IDirectInputEffect {
+public:
+    LONG magnitude = 0;
+    unsigned long long updates = 0;
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID, LPVOID* out) override { if (out) *out = nullptr; return E_NOINTERFACE; }
+    ULONG STDMETHODCALLTYPE AddRef() override { return 1; }
+    ULONG STDMETHODCALLTYPE Release() override { return 1; }
+    HRESULT STDMETHODCALLTYPE Initialize(HINSTANCE, DWORD, REFGUID) override { return S_OK; }
+    HRESULT STDMETHODCALLTYPE GetEffectGuid(LPGUID) override { return E_NOTIMPL; }
+    HRESULT STDMETHODCALLTYPE GetParameters(LPDIEFFECT, DWORD) override { return E_NOTIMPL; }
+    HRESULT STDMETHODCALLTYPE Start(DWORD, DWORD) override { return S_OK; }
+    HRESULT STDMETHODCALLTYPE Stop() override { return S_OK; }
+    HRESULT STDMETHODCALLTYPE GetEffectStatus(LPDWORD status) override { if (status) *status = 0; return S_OK; }
+    HRESULT STDMETHODCALLTYPE Download() override { return S_OK; }
+    HRESULT STDMETHODCALLTYPE Unload() override { return S_OK; }
+    HRESULT STDMETHODCALLTYPE Escape(LPDIEFFESCAPE) override { return E_NOTIMPL; }
+
+    HRESULT STDMETHODCALLTYPE SetParameters(LPCDIEFFECT eff, DWORD flags) override {
+        if ((flags & DIEP_TYPESPECIFICPARAMS) && eff && eff->lpvTypeSpecificParams &&
+            eff->cbTypeSpecificParams == sizeof(DICONSTANTFORCE)) {
+            magnitude = static_cast<const DICONSTANTFORCE*>(eff->lpvTypeSpecificParams)->lMagnitude;
+            updates++;
+        }
+        return S_OK;
+    }
+};
+
+// Where the output ticks send, instead of the device I/O thread. Only the constant force is replayed
+class ReplaySink : public FFBOutputSink {
+public:
+    CapturingEffect constant;
+
+    void PostEffect(DeviceEffectSlot slot, const EffectCommand& command) override {
+        if (slot == DEVICE_EFFECT_CONSTANT) command.Apply(&constant);
+    }
+    void PostPoll() override {}
+};
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printf("Usage: ffb_replay recording.gp2rec [--out forces.csv] [--ini ffb.ini] [--tick-ms N] [--rate HZ]\n"
+               "                  [--upsampling off|linear|hermite] [--predict] [--verbose]\n");
+        return 1;
+    }
+
+    std::string recordingPath = argv[1];
+    std::string outPath = recordingPath + ".forces.csv";
+    std::string iniPath = "ffb.ini";
+    double tickMs = REPLAY_DEFAULT_TICK_MS;
+    std::string upsamplingArg;
+    bool predict = false;
+
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) outPath = argv[++i];
+        else if (arg == "--ini" && i + 1 < argc) iniPath = argv[++i];
+        else if (arg == "--tick-ms" && i + 1 < argc) tickMs = atof(argv[++i]);
+        else if (arg == "--rate" && i + 1 < argc) tickMs = 1000.0 / std::max(atof(argv[++i]), 1.0);
+        else if (arg == "--upsampling" && i + 1 < argc) upsamplingArg = argv[++i];
+        else if (arg == "--predict") predict = true;
+        else if (arg == "--verbose") verboseLogging = true;
+    }
+
+    TelemetryRecording recording;
+    if (!recording.Open(std::wstring(recordingPath.begin(), recordingPath.end()))) {
+        printf("[ERROR] Could not open recording %s\n", recordingPath.c_str());
+        return 1;
+    }
+    if (recording.FrameCount() == 0) {
+        printf("[ERROR] Recording %s has no frames\n", recordingPath.c_str());
+        return 1;
+    }
+
+    // Same settings the live app would use, device name doesn't matter here
+    LoadFFBSettings(std::wstring(iniPath.begin(), iniPath.end()));
+    FFBConfig config = GetFFBConfig() ? *GetFFBConfig() : FFBConfig();
+    FFBGains gains = GainsOf(config);
+    bool enableVibrationForce = config.vibrationEnabled;
+    bool enableWeightForce = config.weightEnabled;
+    bool enableRateLimit = config.weightEnabled; // same as main.cpp
+    UpsampleMode upsampleMode = upsamplingArg.empty() ? config.upsampling : ParseUpsampleMode(std::wstring(upsamplingArg.begin(), upsamplingArg.end()));
+    predict = predict || config.upsamplingPredict;
+
+    // Upsampling needs ticks between the frames to fill in
+    if (upsampleMode != UpsampleMode::Off && tickMs <= 0.0) {
+        printf("[WARNING] Upsampling needs a tick rate, ignoring it with --tick-ms 0\n");
+        upsampleMode = UpsampleMode::Off;
+    }
+
+    FILE* out = fopen(outPath.c_str(), "w");
+    if (!out) {
+        printf("[ERROR] Could not create %s\n", outPath.c_str());
+        return 1;
+    }
+    setvbuf(out, nullptr, _IOFBF, REPLAY_OUTPUT_BUFFER);
+    fprintf(out, "time_ms,frame,speed_kmh,lateral_g,force,fresh\n");
+
+    // Recorded frames go in here and come out of the normal reader
+    InMemoryTelemetrySource source;
+    SetTelemetrySource(&source);
+
+    SimulatedFFBClock clock;
+    SetFFBClock(&clock);
+
+    // The force code checks this is there before it does anything
+    CapturingEffect placeholder;
+    constantForceEffect = &placeholder;
+
+    // The output stage as live, each effect behind its own update policy
+    EffectUpdateGate constantGate(CONSTANT_FORCE_UPDATE_POLICY);
+    EffectUpdateGate damperGate(DAMPER_UPDATE_POLICY);
+    EffectUpdateGate springGate(SPRING_UPDATE_POLICY);
+    EffectUpdateGate vibrationGate(VIBRATION_UPDATE_POLICY);
+    EffectUpdateGate* gates[DEVICE_EFFECT_COUNT] = {};
+    gates[DEVICE_EFFECT_CONSTANT] = &constantGate;
+    gates[DEVICE_EFFECT_DAMPER] = &damperGate;
+    gates[DEVICE_EFFECT_SPRING] = &springGate;
+    gates[DEVICE_EFFECT_VIBRATION] = &vibrationGate;
+    ReplaySink sink;
+    FFBOutput output(tickMs > 0.0 ? tickMs : REPLAY_DEFAULT_TICK_MS, upsampleMode, predict, true, gates, sink);
+
+    RawTelemetry current{};
+    RawTelemetry previousVD{};
+    bool firstReadingVD = true;
+    unsigned long long lastFrameHash = 0;
+    bool firstFrameSeen = false;
+    GameState lastState = GameState::Detached;
+    DeferredEffect deferredConstant;
+    bool constantStarted = false;
+
+    // Pushed by compute, not yet picked up by a tick - the force ring
+    std::vector<ForceFrame> arrived;
+
+    unsigned long long ticks = 0;
+    unsigned long long freshTicks = 0;
+    unsigned long long computedFrames = 0;
+    uint64_t currentFrame = 0;
+    double lastLateralG = 0.0;
+
+    // Reader and compute for the frame that just turned up, as the reader thread and ComputeStage do it
+    // (constant force only). False if there is nothing new for the output
+    auto computeFrame = [&](double frameMs) {
+        if (!ReadTelemetryData(current, CONSTANT_FORCE_FIELDS)) return false;
+        if (firstFrameSeen && current.frameHash == lastFrameHash) return false;
+        lastFrameHash = current.frameHash;
+        firstFrameSeen = true;
+
+        ForceFrame force;
+        force.arrivalMs = frameMs;
+        force.fps = current.gp2_fps;
+        force.state = ClassifyGameState(current);
+
+        // Idle states only send the frame they are entered on, it zeroes the force
+        bool idle = GameStateIsIdle(force.state);
+        bool wasIdle = GameStateIsIdle(lastState);
+        lastState = force.state;
+        if (idle) {
+            if (wasIdle) return false;
+            if (constantStarted) ZeroConstantForceEffect(&deferredConstant);
+        }
+        else {
+            // Back in a race, nothing carries over
+            if (wasIdle) {
+                force.restart = true;
+                ResetConstantForceEffect();
+                firstReadingVD = true;
+            }
+
+            CalculatedVehicleDynamics vehicleDynamics{};
+            if (CalculateVehicleDynamics(current, previousVD, firstReadingVD, vehicleDynamics)) {
+                force.pollDevice = true;
+                if (!constantStarted) {
+                    deferredConstant.Start(1, 0);
+                    constantStarted = true;
+                }
+                ApplyConstantForceEffect(current, vehicleDynamics, current.gp2_speedKmh, &deferredConstant,
+                    enableVibrationForce, enableWeightForce, enableRateLimit,
+                    gains.master, gains.deadzone,
+                    gains.constant, gains.vibration, gains.braking, gains.weight, gains.direction);
+                lastLateralG = vehicleDynamics.lateralG;
+            }
+        }
+
+        force.constant = deferredConstant.Take();
+        arrived.push_back(force);
+        computedFrames++;
+        return true;
+    };
+
+    // One FFB tick at nowMs, picks up whatever compute has pushed since the last one
+    double tickWallTotal = 0.0;
+    double tickWallMax = 0.0;
+    auto runTick = [&](double nowMs) {
+        clock.SetMs(nowMs);
+        auto start = std::chrono::steady_clock::now();
+        for (ForceFrame& force : arrived) output.FrameArrived(force);
+        arrived.clear();
+        int frames = output.Tick(nowMs, false);
+        double tickWall = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        tickWallTotal += tickWall;
+        tickWallMax = std::max(tickWallMax, tickWall);
+
+        ticks++;
+        if (frames > 0) freshTicks++;
+        fprintf(out, "%.3f,%llu,%.2f,%.4f,%ld,%d\n", nowMs, static_cast<unsigned long long>(currentFrame),
+            current.gp2_speedKmh, lastLateralG, static_cast<long>(sink.constant.magnitude), frames > 0 ? 1 : 0);
+    };
+
+    double computeWallTotal = 0.0;
+    auto wallStart = std::chrono::steady_clock::now();
+
+    for (uint64_t i = 0; i < recording.FrameCount(); i++) {
+        const RecordedFrame& frame = recording.Frame(i);
+        double frameMs = frame.timestampMicros / 1000.0;
+
+        // Ticks that fell due before this frame turned up run on what had arrived by then
+        FFBTickScheduler& scheduler = output.Scheduler();
+        if (tickMs > 0.0) {
+            while (!GameStateIsIdle(output.State()) && scheduler.NextDeadlineMs() < frameMs) runTick(scheduler.NextDeadlineMs());
+        }
+
+        memcpy(&source.Block(), &frame.block, sizeof(SharedMemory));
+        currentFrame = i;
+        clock.SetMs(frameMs);
+
+        auto computeStart = std::chrono::steady_clock::now();
+        bool pushed = computeFrame(frameMs);
+        computeWallTotal += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - computeStart).count();
+
+        // Every frame gets its own tick, or an idle output wakes up for it and starts a new grid from here
+        if (pushed && (tickMs <= 0.0 || GameStateIsIdle(output.State()))) {
+            scheduler.Restart(frameMs);
+            runTick(frameMs);
+        }
+    }
+    if (!arrived.empty()) runTick(std::max(clock.NowMs(), output.Scheduler().NextDeadlineMs())); // the last frame
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    fclose(out);
+    SetFFBClock(nullptr);
+    SetTelemetrySource(nullptr);
+
+    double recordedSeconds = (recording.Frame(recording.FrameCount() - 1).timestampMicros - recording.Frame(0).timestampMicros) / 1000000.0;
+    double framesPerSecond = recording.FrameCount() / std::max(wallSeconds, 0.000001);
+    printf("[INFO] Replayed %llu frames (%.1f s of driving) in %.3f s: %.0f frames/s, %.1f M frames/min, %.0fx realtime\n",
+        static_cast<unsigned long long>(recording.FrameCount()), recordedSeconds, wallSeconds,
+        framesPerSecond, framesPerSecond * 60.0 / 1000000.0, recordedSeconds / std::max(wallSeconds, 0.000001));
+    printf("[INFO] %llu FFB ticks, %llu with a new frame, %llu force updates -> %s\n",
+        ticks, freshTicks, sink.constant.updates, outPath.c_str());
+    FrameLockStats lockStats = output.FrameLock().Stats();
+    printf("[INFO] Frame lock: %ls, %.3f ms period, %.3f ms error, %llu relocks\n", lockStats.locked ? L"locked" : L"searching",
+        lockStats.periodMs, lockStats.lockErrorMs, lockStats.relocks);
+    if (computedFrames > 0) {
+        printf("[INFO] Frame cost: %.2f us average (reader, dynamics and the constant force)\n", computeWallTotal / computedFrames);
+    }
+    if (ticks > 0) {
+        double tickAverage = tickWallTotal / ticks;
+        printf("[INFO] Tick cost: %.2f us average, %.2f us max (upsampling %ls%s)", tickAverage, tickWallMax,
+            UpsampleModeName(upsampleMode), predict ? " predict" : "");
+        if (tickMs > 0.0) printf(", %.2f%% of the %.3f ms tick", tickAverage / (tickMs * 10.0), tickMs);
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,840 @@
+// ffb_tests.cpp
+// Checks for the parts of the app that can be run without the game or a wheel: each test drives one
+// piece with made-up input and checks what comes out. Prints a line per failed check and a summary,
+// exits 1 if anything failed.
+//
+// Usage: ffb_tests [name...]
+//   runs every test, or only those whose name starts with one of the given names
+//
+// Builds on Windows and Linux with:
+//   telemetry_recorder.cpp, ffb_scheduler.cpp, ffb_clock.cpp, forces/force_upsampler.cpp, frame_lock.cpp
+//   thread_policy.cpp, game_state.cpp
+//   (+ on Windows, for the update gates: effect_update.cpp, ffb_pipeline.cpp)
+//   ffb_config.cpp, ffb_settings_text.cpp, control_channel.cpp
+// Writes its scratch files (ffb_tests_*) into the current folder and deletes them again.
+
+#include "../telemetry_recorder.h"
+#include "../ffb_scheduler.h"
+#include "../forces/force_upsampler.h"
+#include "../frame_lock.h"
+#include "../spsc_ring.h"
+#include "../mpsc_ring.h"
+#include "../thread_policy.h"
+#include "../game_state.h"
+#ifdef _WIN32
+#include "../effect_update.h"
+#endif
+#include "../ffb_config.h"
+#include "../control_channel.h"
+#include "../seqlock.h"
+#include "../logger.h"
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+static int checks = 0;
+static int failures = 0;
+
+#define CHECK(condition) Check((condition), #condition, __LINE__)
+#define CHECK_NEAR(a, b, tolerance) Check(((a) - (b)) <= (tolerance) && ((b) - (a)) <= (tolerance), #a " ~ " #b, __LINE__)
+
+static void Check(bool ok, const char* what, int line) {
+    checks++;
+    if (ok) return;
+    failures++;
+    printf("  [FAIL] line %d: %s\n", line, what);
+}
+
+// What the code under test logged, so a test can check it warned
+static std::vector<std::wstring> logged;
+
+void LogMessage(const std::wstring& msg) {
+    logged.push_back(msg);
+}
+
+void LogPrintf(const wchar_t* format, ...) {
+    wchar_t buffer[LOG_RECORD_CHARS];
+    va_list args;
+    va_start(args, format);
+    if (vswprintf(buffer, LOG_RECORD_CHARS, format, args) < 0) buffer[LOG_RECORD_CHARS - 1] = L'\0';
+    va_end(args);
+    LogMessage(buffer);
+}
+
+static bool LoggedWarning() {
+    for (const std::wstring& line : logged) {
+        if (line.rfind(L"[WARNING]", 0) == 0) return true;
+    }
+    return false;
+}
+
+// Scratch file names are plain ASCII
+static std::string Narrow(const std::wstring& text) {
+    return std::string(text.begin(), text.end());
+}
+
+// === Recording ===
+
+#define TEST_RECORDING L"ffb_tests_recording.gp2rec"
+#define TEST_RECORDING_COPY L"ffb_tests_copy.gp2rec"
+#define TEST_RECORDING_FRAMES 200
+
+static bool WriteTestRecording() {
+    if (!StartTelemetryRecording(TEST_RECORDING)) return false;
+    SharedMemory block = {};
+    for (int i = 0; i < TEST_RECORDING_FRAMES; i++) {
+        block.structSize = sizeof(SharedMemory);
+        block.speedKmh = static_cast<float>(i);
+        RecordTelemetryFrame(block, 1000 + i, 5000000 + i * 16667ll);
+    }
+    StopTelemetryRecording();
+    return GetTelemetryRecorderStats().framesDropped == 0;
+}
+
+// Copy of the test recording with bytes written over at offset
+static void WriteDamagedCopy(size_t offset, const void* bytes, size_t length) {
+    std::vector<unsigned char> file;
+    FILE* in = fopen(Narrow(TEST_RECORDING).c_str(), "rb");
+    if (in) {
+        unsigned char buffer[65536];
+        size_t got = 0;
+        while ((got = fread(buffer, 1, sizeof(buffer), in)) > 0) file.insert(file.end(), buffer, buffer + got);
+        fclose(in);
+    }
+    if (offset + length <= file.size()) memcpy(&file[offset], bytes, length);
+    FILE* out = fopen(Narrow(TEST_RECORDING_COPY).c_str(), "wb");
+    if (out) {
+        fwrite(file.data(), 1, file.size(), out);
+        fclose(out);
+    }
+}
+
+static void TestRecordingRoundTrip() {
+    CHECK(WriteTestRecording());
+
+    TelemetryRecording recording;
+    CHECK(recording.Open(TEST_RECORDING));
+    CHECK(recording.FrameCount() == TEST_RECORDING_FRAMES);
+    if (recording.FrameCount() != TEST_RECORDING_FRAMES) return;
+
+    // Timestamps start at 0, frames come back in order and untouched
+    CHECK(recording.Frame(0).timestampMicros == 0);
+    CHECK(recording.Frame(10).timestampMicros == 10 * 16667ll);
+    CHECK(recording.Frame(10).frameHash == 1010);
+    CHECK(recording.Frame(TEST_RECORDING_FRAMES - 1).block.speedKmh == TEST_RECORDING_FRAMES - 1);
+    CHECK(recording.Header().indexCount == (TEST_RECORDING_FRAMES + RECORDING_INDEX_INTERVAL - 1) / RECORDING_INDEX_INTERVAL);
+
+    CHECK(recording.FindFrame(0) == 0);
+    CHECK(recording.FindFrame(100 * 16667ll) == 100);
+    CHECK(recording.FindFrame(100 * 16667ll + 1) == 101);
+    CHECK(recording.FindFrame(1ll << 40) == TEST_RECORDING_FRAMES);
+    recording.Close();
+    remove(Narrow(TEST_RECORDING).c_str());
+}
+
+static void TestRecordingDamaged() {
+    CHECK(WriteTestRecording());
+
+    // No index (the app was killed): rebuilt from the frames
+    uint64_t zero = 0;
+    WriteDamagedCopy(offsetof(RecordingHeader, indexOffset), &zero, sizeof(zero));
+    {
+        TelemetryRecording recording;
+        logged.clear();
+        CHECK(recording.Open(TEST_RECORDING_COPY));
+        CHECK(LoggedWarning());
+        CHECK(recording.FrameCount() == TEST_RECORDING_FRAMES);
+        CHECK(recording.FindFrame(100 * 16667ll) == 100);
+    }
+
+    // An index count that would wrap around when multiplied out
+    uint64_t hugeCount = 1ull << 61;
+    WriteDamagedCopy(offsetof(RecordingHeader, indexCount), &hugeCount, sizeof(hugeCount));
+    {
+        TelemetryRecording recording;
+        CHECK(recording.Open(TEST_RECORDING_COPY));
+        CHECK(recording.FrameCount() == TEST_RECORDING_FRAMES);
+        CHECK(recording.FindFrame(100 * 16667ll) == 100);
+    }
+
+    // A frame count past the end of the file
+    uint64_t hugeFrames = 1ull << 40;
+    WriteDamagedCopy(offsetof(RecordingHeader, frameCount), &hugeFrames, sizeof(hugeFrames));
+    {
+        TelemetryRecording recording;
+        CHECK(recording.Open(TEST_RECORDING_COPY));
+        CHECK(recording.FrameCount() == TEST_RECORDING_FRAMES);
+    }
+
+    // A header size this version doesn't write
+    uint32_t headerSize = 1u << 31;
+    WriteDamagedCopy(offsetof(RecordingHeader, headerSize), &headerSize, sizeof(headerSize));
+    {
+        TelemetryRecording recording;
+        CHECK(!recording.Open(TEST_RECORDING_COPY));
+    }
+
+    remove(Narrow(TEST_RECORDING_COPY).c_str());
+    remove(Narrow(TEST_RECORDING).c_str());
+}
+
+// === Tick scheduler ===
+
+static void TestSchedulerDeadlines() {
+    FFBTickScheduler scheduler(10.0);
+    scheduler.AlignTo(0.0);
+    CHECK(scheduler.Due(0.0));
+    scheduler.CompleteTick(0.0);
+    CHECK(scheduler.NextDeadlineMs() == 10.0);
+    CHECK(!scheduler.Due(9.9));
+
+    // A little late doesn't move the grid
+    scheduler.CompleteTick(10.5);
+    CHECK(scheduler.NextDeadlineMs() == 20.0);
+
+    // A stall over three deadlines: one tick for all of them, not a burst, and the grid carries on
+    scheduler.CompleteTick(45.0);
+    CHECK(scheduler.NextDeadlineMs() == 50.0);
+
+    FFBSchedulerStats stats = scheduler.Stats();
+    CHECK(stats.ticks == 3);
+    CHECK(stats.overruns == 1);
+    CHECK(stats.skippedTicks == 2);
+    CHECK_NEAR(stats.jitterMaxMs, 24.5, 1e-9);
+    CHECK_NEAR(stats.wakeLateMaxMs, 25.0, 1e-9);
+
+    // After idling, the gap isn't jitter
+    scheduler.Restart(1000.0);
+    scheduler.CompleteTick(1000.0);
+    CHECK(scheduler.NextDeadlineMs() == 1010.0);
+    CHECK_NEAR(scheduler.Stats().jitterMaxMs, 24.5, 1e-9);
+}
+
+static void TestSchedulerLockTo() {
+    FFBTickScheduler scheduler(10.0);
+    scheduler.AlignTo(0.0);
+    scheduler.CompleteTick(0.0);
+
+    // Onto a new grid, never sooner than half a period after the last tick
+    scheduler.LockTo(100.0, 8.0);
+    double next = scheduler.NextDeadlineMs();
+    CHECK(next >= 4.0);
+    CHECK(next < 12.0);
+    CHECK_NEAR(std::fmod(100.0 - next, 8.0), 0.0, 1e-9);
+    CHECK(scheduler.PeriodMs() == 8.0);
+
+    // An anchor just past the last tick waits for the grid point after it
+    scheduler.CompleteTick(next);
+    scheduler.LockTo(next + 1.0, 8.0);
+    CHECK(scheduler.NextDeadlineMs() == next + 9.0);
+}
+
+// === Constant force upsampling ===
+
+static long Upsampled(const ForceUpsampler& upsampler, double timeMs) {
+    long magnitude = -1;
+    CHECK(upsampler.Evaluate(timeMs, magnitude));
+    return magnitude;
+}
+
+static void TestUpsamplerInterpolate() {
+    ForceUpsampler off(UpsampleMode::Off);
+    long magnitude = 0;
+    CHECK(!off.Evaluate(0.0, magnitude));
+    off.AddSample(0.0, 0);
+    off.AddSample(10.0, 1000);
+    CHECK(Upsampled(off, 15.0) == 1000);
+
+    // A frame behind: halfway between the last two samples half a frame after the newest
+    ForceUpsampler linear(UpsampleMode::Linear);
+    linear.SetFramePeriodMs(10.0);
+    linear.AddSample(0.0, 0);
+    linear.AddSample(10.0, 1000);
+    linear.AddSample(20.0, 2000);
+    CHECK(Upsampled(linear, 25.0) == 1500);
+    CHECK(Upsampled(linear, 30.0) == 2000);
+
+    // On a straight line the Hermite curve is the same line
+    ForceUpsampler hermite(UpsampleMode::Hermite);
+    hermite.SetFramePeriodMs(10.0);
+    hermite.AddSample(0.0, 0);
+    hermite.AddSample(10.0, 1000);
+    hermite.AddSample(20.0, 2000);
+    CHECK(Upsampled(hermite, 25.0) == 1500);
+
+    // Never past what the device takes
+    hermite.AddSample(30.0, 50000);
+    CHECK(Upsampled(hermite, 40.0) == UPSAMPLER_MAX_MAGNITUDE);
+
+    hermite.Reset();
+    CHECK(!hermite.Evaluate(40.0, magnitude));
+}
+
+static void TestUpsamplerGapAndPredict() {
+    // After a gap the old value holds and only the last frame before the new sample ramps
+    ForceUpsampler linear(UpsampleMode::Linear);
+    linear.SetFramePeriodMs(10.0);
+    linear.AddSample(0.0, 0);
+    linear.AddSample(100.0, 1000);
+    CHECK(Upsampled(linear, 85.0) == 0);
+    CHECK(Upsampled(linear, 105.0) == 500);
+
+    // Predicting runs ahead along half the slope, and stops a frame on
+    ForceUpsampler predict(UpsampleMode::Linear, true);
+    predict.SetFramePeriodMs(10.0);
+    predict.AddSample(0.0, 0);
+    predict.AddSample(10.0, 1000);
+    CHECK(Upsampled(predict, 10.0) == 1000);
+    CHECK(Upsampled(predict, 15.0) == 1250);
+    CHECK(Upsampled(predict, 100.0) == 1500);
+
+    CHECK(ParseUpsampleMode(L"hermite") == UpsampleMode::Hermite);
+    CHECK(ParseUpsampleMode(L"Linear") == UpsampleMode::Linear);
+    CHECK(ParseUpsampleMode(L"cubic") == UpsampleMode::Off);
+}
+
+// === Frame phase lock ===
+
+// A game running at periodMs while its fps field says 60, arrivals wobbling by up to +-0.2ms
+static double FeedFrames(FramePhaseLock& lock, double startMs, double periodMs, int frames) {
+    double timeMs = startMs;
+    for (int i = 0; i < frames; i++) {
+        timeMs = startMs + i * periodMs;
+        lock.FrameArrived(timeMs + ((i * 7) % 5 - 2) * 0.1, 60.0);
+    }
+    return timeMs;
+}
+
+static void TestFrameLockSettles() {
+    FramePhaseLock lock;
+    double lastMs = FeedFrames(lock, 100.0, 16.5, 600);
+
+    // Settles on the game's real rate, not the fps field's, with the next frame where it will be
+    CHECK(lock.Locked());
+    CHECK_NEAR(lock.PeriodMs(), 16.5, 0.05);
+    CHECK_NEAR(lock.NextFrameMs(), lastMs + 16.5, 0.5);
+    CHECK(lock.NextTickMs() > lock.NextFrameMs());
+    CHECK(lock.NextTickMs() < lock.NextFrameMs() + 16.5 * 0.25 + FRAME_LOCK_TICK_OFFSET_MS + 1e-9);
+    CHECK(lock.Stats().relocks == 0);
+
+    // A few dropped frames are stepped over, not taken as phase error
+    lastMs += 4 * 16.5;
+    lock.FrameArrived(lastMs, 60.0);
+    CHECK(lock.Locked());
+    CHECK(lock.Stats().relocks == 0);
+}
+
+static void TestFrameLockRelocks() {
+    FramePhaseLock lock;
+    double lastMs = FeedFrames(lock, 0.0, 1000.0 / 60.0, 300);
+    CHECK(lock.Locked());
+
+    // The game goes to 30fps: start over from its new figure
+    lock.FrameArrived(lastMs + 33.3, 30.0);
+    CHECK(!lock.Locked());
+    CHECK(lock.Stats().relocks == 1);
+    CHECK_NEAR(lock.PeriodMs(), 1000.0 / 30.0, 1e-9);
+
+    // A stall far longer than FRAME_LOCK_RELOCK_FRAMES frames
+    lock.FrameArrived(lastMs + 10000.0, 30.0);
+    CHECK(lock.Stats().relocks == 2);
+
+    lock.Reset();
+    CHECK(!lock.Locked());
+}
+
+// === Rings ===
+
+#define TEST_RING_ITEMS 1000000
+
+static void TestSpscRingSingleThread() {
+    SpscRing<int, 4> ring;
+    int item = 0;
+    CHECK(!ring.Pop(item));
+
+    for (int i = 1; i <= 4; i++) CHECK(ring.Push(i));
+    CHECK(!ring.Push(5));           // full: refused and counted, the producer never waits
+    CHECK(ring.Dropped() == 1);
+    CHECK(ring.Depth() == 4);
+    CHECK(ring.HighWater() == 4);
+
+    for (int i = 1; i <= 4; i++) CHECK(ring.Pop(item) && item == i);
+    CHECK(!ring.Pop(item));
+    CHECK(ring.Depth() == 0);
+
+    // Round the end of the slots and back
+    for (int i = 0; i < 10; i++) CHECK(ring.Push(i) && ring.Pop(item) && item == i);
+}
+
+static void TestSpscRingThreads() {
+    static SpscRing<unsigned long long, 64> ring;
+    std::thread producer([] {
+        for (unsigned long long i = 1; i <= TEST_RING_ITEMS; i++) {
+            while (!ring.Push(i)) std::this_thread::yield();
+        }
+    });
+
+    // Every item once, in order
+    unsigned long long expected = 1;
+    bool inOrder = true;
+    while (expected <= TEST_RING_ITEMS) {
+        unsigned long long item = 0;
+        if (!ring.Pop(item)) {
+            std::this_thread::yield();
+            continue;
+        }
+        inOrder = inOrder && item == expected;
+        expected++;
+    }
+    producer.join();
+    CHECK(inOrder);
+    CHECK(ring.Depth() == 0);
+}
+
+#define TEST_RING_PRODUCERS 4
+
+struct MpscTestItem {
+    int producer;
+    unsigned long long sequence;
+};
+
+static void TestMpscRing() {
+    MpscRing<int, 4> small;
+    int item = 0;
+    for (int i = 1; i <= 4; i++) CHECK(small.Push([i](int& slot) { slot = i; }));
+    CHECK(!small.Push([](int& slot) { slot = 99; }));
+    CHECK(small.Dropped() == 1);
+    for (int i = 1; i <= 4; i++) CHECK(small.Pop(item) && item == i);
+    CHECK(!small.Pop(item));
+
+    // Several producers at once: every item arrives once, each producer's in its own order
+    static MpscRing<MpscTestItem, 64> ring;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < TEST_RING_PRODUCERS; p++) {
+        producers.emplace_back([p] {
+            for (unsigned long long i = 1; i <= TEST_RING_ITEMS / TEST_RING_PRODUCERS; i++) {
+                while (!ring.Push([&](MpscTestItem& slot) { slot = { p, i }; })) std::this_thread::yield();
+            }
+        });
+    }
+
+    unsigned long long expected[TEST_RING_PRODUCERS] = {};
+    bool inOrder = true;
+    for (unsigned long long received = 0; received < TEST_RING_ITEMS; ) {
+        MpscTestItem next;
+        if (!ring.Pop(next)) {
+            std::this_thread::yield();
+            continue;
+        }
+        inOrder = inOrder && next.producer >= 0 && next.producer < TEST_RING_PRODUCERS &&
+            next.sequence == ++expected[next.producer];
+        received++;
+    }
+    for (std::thread& producer : producers) producer.join();
+    CHECK(inOrder);
+    MpscTestItem extra;
+    CHECK(!ring.Pop(extra));
+}
+
+// === Thread policy ===
+
+static void TestParseThreadPolicy() {
+    ThreadPolicy policy = ParseThreadPolicy(L"Realtime", L"70", L"2,3");
+    CHECK(policy.priority == ThreadPriorityClass::Realtime);
+    CHECK(policy.realtimePriority == 70);
+    CHECK(policy.affinityMask == 0xC);
+    CHECK(!LoggedWarning());
+
+    policy = ParseThreadPolicy(L" high ", L"", L"0,4-7");
+    CHECK(policy.priority == ThreadPriorityClass::High);
+    CHECK(policy.realtimePriority == THREAD_RT_PRIORITY_DEFAULT);
+    CHECK(policy.affinityMask == 0xF1);
+    CHECK(DescribeThreadPolicy(policy) == L"high, CPUs 0,4,5,6,7");
+
+    policy = ParseThreadPolicy(L"normal", L"500", L"any");
+    CHECK(policy.realtimePriority == THREAD_RT_PRIORITY_MAX);
+    CHECK(policy.affinityMask == 0);
+    CHECK(DescribeThreadPolicy(policy) == L"normal, any CPU");
+    CHECK(!LoggedWarning());
+
+    // Anything it can't read falls back with a warning
+    const wchar_t* badAffinity[] = { L"7-4", L"64", L"2,,3", L"cpu2" };
+    for (const wchar_t* affinity : badAffinity) {
+        logged.clear();
+        CHECK(ParseThreadPolicy(L"normal", L"", affinity).affinityMask == 0);
+        CHECK(LoggedWarning());
+    }
+    logged.clear();
+    CHECK(ParseThreadPolicy(L"turbo", L"", L"").priority == ThreadPriorityClass::Normal);
+    CHECK(LoggedWarning());
+    logged.clear();
+    CHECK(ParseThreadPolicy(L"realtime", L"lots", L"").realtimePriority == THREAD_RT_PRIORITY_DEFAULT);
+    CHECK(LoggedWarning());
+}
+
+// === Game state ===
+
+static void TestGameStateMachine() {
+    RawTelemetry telemetry;
+    CHECK(ClassifyGameState(telemetry) == GameState::Menu);
+    telemetry.gp2_isInRace = true;
+    CHECK(ClassifyGameState(telemetry) == GameState::Racing);
+    telemetry.gp2_isPaused = true;
+    CHECK(ClassifyGameState(telemetry) == GameState::Paused);
+    telemetry.gp2_isReplay = true;
+    CHECK(ClassifyGameState(telemetry) == GameState::Replay);
+    telemetry.gp2_isX86MenuOn = true;
+    CHECK(ClassifyGameState(telemetry) == GameState::Menu);
+
+    GameStateMachine machine;
+    CHECK(machine.State() == GameState::Detached);
+    CHECK(!machine.Update(GameState::Detached, 0.0));
+    CHECK(machine.Update(GameState::Menu, 1000.0));
+    CHECK(machine.Update(GameState::Racing, 3000.0));
+    CHECK(!machine.Update(GameState::Racing, 5000.0));
+    CHECK(machine.Update(GameState::Paused, 9000.0));
+    CHECK(machine.State() == GameState::Paused);
+
+    // 1s detached, 2s menu, 6s racing, 1s paused so far
+    GameStateStats stats = machine.Stats(10000.0);
+    CHECK(stats.transitions == 3);
+    CHECK_NEAR(stats.inStateMs, 1000.0, 1e-9);
+    CHECK_NEAR(stats.totalMs[static_cast<int>(GameState::Racing)], 6000.0, 1e-9);
+    CHECK_NEAR(stats.totalMs[static_cast<int>(GameState::Paused)], 1000.0, 1e-9);
+    CHECK_NEAR(stats.idleShare, 0.4, 1e-9);
+
+    CHECK(GameStateIsIdle(GameState::Paused));
+    CHECK(!GameStateIsIdle(GameState::Racing));
+}
+
+// === Effect update gates ===
+// EffectCommand is a DIEFFECT, so these only build on Windows (see ffb_pipeline.h)
+
+#ifdef _WIN32
+
+static EffectCommand PeriodicCommand(DWORD magnitude) {
+    DIPERIODIC periodic = {};
+    periodic.dwMagnitude = magnitude;
+    periodic.dwPeriod = 50000;
+    DWORD axes[1] = { DIJOFS_X };
+    LONG direction[1] = { 0 };
+    DIEFFECT eff = {};
+    eff.dwSize = sizeof(DIEFFECT);
+    eff.dwFlags = DIEFF_CARTESIAN | DIEFF_OBJECTOFFSETS;
+    eff.dwDuration = INFINITE;
+    eff.dwGain = 10000;
+    eff.cAxes = 1;
+    eff.rgdwAxes = axes;
+    eff.rglDirection = direction;
+    eff.cbTypeSpecificParams = sizeof(DIPERIODIC);
+    eff.lpvTypeSpecificParams = &periodic;
+
+    EffectCommand command;
+    CHECK(command.Capture(&eff, DIEP_TYPESPECIFICPARAMS));
+    return command;
+}
+
+static void TestEffectUpdateGates() {
+    // Fixed rate: the first goes out, then at most one per interval
+    EffectUpdateGate fixed(EffectUpdatePolicy::FixedRate(10.0));
+    CHECK(fixed.Ready(PeriodicCommand(100), 0.0));
+    CHECK(!fixed.Ready(PeriodicCommand(200), 50.0));
+    CHECK(fixed.Ready(PeriodicCommand(300), 100.0));
+    CHECK(fixed.Sent() == 2);
+    CHECK(fixed.Held() == 1);
+
+    // On change: only past the threshold, or when the refresh is due
+    EffectUpdateGate onChange(EffectUpdatePolicy::OnChange(200, 1000.0));
+    CHECK(onChange.Ready(PeriodicCommand(1000), 0.0));
+    CHECK(!onChange.Ready(PeriodicCommand(1150), 10.0));
+    CHECK(onChange.Ready(PeriodicCommand(1250), 20.0));
+    CHECK(!onChange.Ready(PeriodicCommand(1250), 500.0));
+    CHECK(onChange.Ready(PeriodicCommand(1250), 1020.0));
+
+    // Event: parameters wait for a Start or Stop, which always goes straight out
+    EffectUpdateGate event(EffectUpdatePolicy::Event());
+    CHECK(event.Ready(PeriodicCommand(100), 0.0));
+    CHECK(!event.Ready(PeriodicCommand(5000), 10.0));
+    EffectCommand stop = PeriodicCommand(5000);
+    stop.run = EffectRunChange::Stop;
+    CHECK(event.Ready(stop, 20.0));
+    CHECK(!event.Ready(EffectCommand(), 30.0));
+
+    CHECK(EffectParameterDistance(PeriodicCommand(1000), PeriodicCommand(1300)) == 300);
+}
+
+#endif
+
+// === Settings ===
+
+#define TEST_INI L"ffb_tests.ini"
+
+static FFBSettingsText GoodSettings() {
+    FFBSettingsText text;
+    text.forceSetting = L"40";
+    text.deadzoneSetting = L"5";
+    text.invertFFB = L"true";
+    text.constantEnabled = L"true";
+    text.constantScale = L"80";
+    text.brakingScale = L"60";
+    text.vibrationEnabled = L"false";
+    text.vibrationScale = L"30";
+    text.damperEnabled = L"true";
+    text.damperScale = L"50";
+    text.springEnabled = L"false";
+    text.updateRate = L"500";
+    text.upsampling = L"hermite";
+    text.recordEnabled = L"true";
+    return text;
+}
+
+static void TestBuildFFBConfig() {
+    FFBConfig config = BuildFFBConfig(GoodSettings(), FFBConfig());
+    CHECK(!LoggedWarning());
+    CHECK_NEAR(config.masterScale, 0.4, 1e-12);
+    CHECK_NEAR(config.deadzoneScale, 0.05, 1e-12);
+    CHECK_NEAR(config.constantScale, 0.8, 1e-12);
+    CHECK(config.brakingScale == 60.0);
+    CHECK(config.invert);
+    CHECK(config.constantEnabled && !config.vibrationEnabled && config.damperEnabled && !config.springEnabled);
+    CHECK(config.updateRateHz == 500.0);
+    CHECK(config.upsampling == UpsampleMode::Hermite);
+    CHECK(config.recordEnabled);
+    CHECK(config.recordFile == L"telemetry.gp2rec");
+
+    // Each bad value is logged and replaced by the fallback's, or clamped into range
+    FFBConfig fallback = config;
+    fallback.masterScale = 0.7;
+    fallback.constantOn = false;
+    FFBSettingsText text = GoodSettings();
+    text.forceSetting = L"strong";
+    text.deadzoneSetting = L"";
+    text.updateRate = L"5000";
+    text.upsampling = L"cubic";
+    text.invertFFB = L"yes";
+    text.recordEnabled = L"on";
+    logged.clear();
+    config = BuildFFBConfig(text, fallback);
+    CHECK(logged.size() == 6);
+    CHECK(config.masterScale == 0.7);
+    CHECK(config.deadzoneScale == fallback.deadzoneScale);
+    CHECK(config.updateRateHz == FFB_MAX_RATE_HZ);
+    CHECK(config.upsampling == UpsampleMode::Hermite);
+    CHECK(config.invert);
+    CHECK(config.recordEnabled);
+
+    // The control channel's switches aren't in the file, they carry over
+    CHECK(!config.constantOn);
+}
+
+static void TestReadFFBSettings() {
+    FILE* ini = fopen(Narrow(TEST_INI).c_str(), "w");
+    CHECK(ini != nullptr);
+    if (!ini) return;
+    fputs("Device: Test Wheel\nForce: 40\nConstant Scale: 80\nUpdate Rate: 500\nUpsampling: linear\n"
+        "Record File: laps.gp2rec\nThread Affinity: 2,3\n", ini);
+    fclose(ini);
+
+    FFBSettingsText text;
+    CHECK(ReadFFBSettings(TEST_INI, text));
+    CHECK(text.deviceName == L"Test Wheel");
+    CHECK(text.forceSetting == L"40");
+    CHECK(text.constantScale == L"80");
+    CHECK(text.updateRate == L"500");
+    CHECK(text.upsampling == L"linear");
+    CHECK(text.recordFile == L"laps.gp2rec");
+    CHECK(text.threadAffinity == L"2,3");
+    CHECK(text.logFormat == L"text");      // missing lines keep their defaults
+    remove(Narrow(TEST_INI).c_str());
+
+    CHECK(!ReadFFBSettings(L"ffb_tests_missing.ini", text));
+}
+
+static void TestConfigPublishAndRamp() {
+    FFBConfig config = BuildFFBConfig(GoodSettings(), FFBConfig());
+    PublishFFBConfig(config);
+    std::shared_ptr<const FFBConfig> first = GetFFBConfig();
+    CHECK(first != nullptr);
+    if (!first) return;
+    unsigned long long firstVersion = first->version;
+
+    // An edit that declines publishes nothing
+    CHECK(!EditFFBConfig([](FFBConfig&, const FFBConfig&) { return false; }));
+    CHECK(GetFFBConfig()->version == firstVersion);
+
+    CHECK(EditFFBConfig([](FFBConfig& next, const FFBConfig&) { next.masterScale = 0.8; return true; }));
+    std::shared_ptr<const FFBConfig> second = GetFFBConfig();
+    CHECK(second->version == firstVersion + 1);
+    CHECK(second->masterScale == 0.8);
+    CHECK(first->masterScale == 0.4);     // the old snapshot is still there for whoever holds it
+
+    // The first snapshot applies at once, the next blends in over FFB_CONFIG_RAMP_MS
+    FFBGainRamp ramp;
+    CHECK_NEAR(ramp.Update(*first, 0.0).master, 0.4, 1e-12);
+    CHECK_NEAR(ramp.Update(*second, 1000.0).master, 0.4, 1e-12);
+    CHECK_NEAR(ramp.Update(*second, 1000.0 + FFB_CONFIG_RAMP_MS / 2.0).master, 0.6, 1e-12);
+    CHECK_NEAR(ramp.Update(*second, 1000.0 + FFB_CONFIG_RAMP_MS * 2.0).master, 0.8, 1e-12);
+    CHECK(ramp.Update(*second, 5000.0).direction == -1.0);
+
+    // A replaced snapshot goes once the last holder lets go, not before
+    std::weak_ptr<const FFBConfig> replaced = first;
+    CHECK(EditFFBConfig([](FFBConfig& next, const FFBConfig&) { next.masterScale = 0.9; return true; }));
+    CHECK(!replaced.expired());
+    first.reset();
+    CHECK(replaced.expired());
+}
+
+// === Control channel ===
+
+static void TestControlCommands() {
+    PublishFFBConfig(BuildFFBConfig(GoodSettings(), FFBConfig()));
+    unsigned long long version = GetFFBConfig()->version;
+
+    std::string reply = HandleControlCommand("help");
+    CHECK(reply.size() > 3 && reply.compare(reply.size() - 3, 3, "ok\n") == 0);
+    CHECK(HandleControlCommand("config").find("force 40\n") != std::string::npos);
+
+    CHECK(HandleControlCommand("set force 55") == "ok\n");
+    CHECK_NEAR(GetFFBConfig()->masterScale, 0.55, 1e-12);
+    CHECK(GetFFBConfig()->version == version + 1);
+
+    // The same value again makes no new snapshot
+    CHECK(HandleControlCommand("set force 55") == "ok\n");
+    CHECK(GetFFBConfig()->version == version + 1);
+
+    CHECK(HandleControlCommand("set braking 200") == "ok\n");
+    CHECK(GetFFBConfig()->brakingScale == 200.0);
+    CHECK(HandleControlCommand("set invert false") == "ok\n");
+    CHECK(!GetFFBConfig()->invert);
+    CHECK(HandleControlCommand("effect damper off") == "ok\n");
+    CHECK(!GetFFBConfig()->damperOn);
+    CHECK(GetFFBConfig()->damperEnabled);   // off means at zero, still running
+
+    // Refused, and nothing published
+    version = GetFFBConfig()->version;
+    const char* refused[] = { "set force 400", "set force loud", "set invert maybe", "set gravity 5",
+        "effect damper maybe", "effect rumble off", "set force 40 now", "warp 9" };
+    for (const char* line : refused) {
+        CHECK(HandleControlCommand(line).compare(0, 6, "error ") == 0);
+    }
+    CHECK(GetFFBConfig()->version == version);
+
+    CHECK(HandleControlCommand("get control_requests").find("\nok\n") != std::string::npos);
+    CHECK(HandleControlCommand("get no_such_metric").compare(0, 6, "error ") == 0);
+    CHECK(HandleControlCommand("stats").find("control_clients ") != std::string::npos);
+}
+
+// === Seqlock ===
+
+#define TEST_SEQLOCK_STORES 200000
+
+struct SeqlockTestValue {
+    unsigned long long words[6];
+};
+
+static void TestSeqlock() {
+    static Seqlock<SeqlockTestValue> seqlock;
+    CHECK(seqlock.Load().words[0] == 0);
+
+    std::atomic<bool> done{ false };
+    std::thread writer([&] {
+        SeqlockTestValue value;
+        for (unsigned long long i = 1; i <= TEST_SEQLOCK_STORES; i++) {
+            for (unsigned long long& word : value.words) word = i;
+            seqlock.Store(value);
+            if (i % 64 == 0) std::this_thread::yield();
+        }
+        done = true;
+    });
+
+    // Every copy read is one the writer stored whole, never two halves
+    bool whole = true;
+    unsigned long long last = 0;
+    while (!done) {
+        SeqlockTestValue value = seqlock.Load();
+        for (unsigned long long word : value.words) whole = whole && word == value.words[0];
+        whole = whole && value.words[0] >= last;
+        last = value.words[0];
+        std::this_thread::yield();
+    }
+    writer.join();
+    CHECK(whole);
+    CHECK(seqlock.Load().words[5] == TEST_SEQLOCK_STORES);
+}
+
+// === Running them ===
+
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+static const TestCase tests[] = {
+    { "recording_round_trip", TestRecordingRoundTrip },
+    { "recording_damaged", TestRecordingDamaged },
+    { "scheduler_deadlines", TestSchedulerDeadlines },
+    { "scheduler_lock_to", TestSchedulerLockTo },
+    { "upsampler_interpolate", TestUpsamplerInterpolate },
+    { "upsampler_gap_and_predict", TestUpsamplerGapAndPredict },
+    { "frame_lock_settles", TestFrameLockSettles },
+    { "frame_lock_relocks", TestFrameLockRelocks },
+    { "spsc_ring_single_thread", TestSpscRingSingleThread },
+    { "spsc_ring_threads", TestSpscRingThreads },
+    { "mpsc_ring", TestMpscRing },
+    { "parse_thread_policy", TestParseThreadPolicy },
+    { "game_state_machine", TestGameStateMachine },
+#ifdef _WIN32
+    { "effect_update_gates", TestEffectUpdateGates },
+#endif
+    { "build_ffb_config", TestBuildFFBConfig },
+    { "read_ffb_settings", TestReadFFBSettings },
+    { "config_publish_and_ramp", TestConfigPublishAndRamp },
+    { "control_commands", TestControlCommands },
+    { "seqlock", TestSeqlock },
+};
+
+static bool Selected(const char* name, int argc, char** argv) {
+    if (argc < 2) return true;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(name, argv[i], strlen(argv[i])) == 0) return true;
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    int run = 0;
+    int failed = 0;
+    for (const TestCase& test : tests) {
+        if (!Selected(test.name, argc, argv)) continue;
+        printf("%s\n", test.name);
+        int failuresBefore = failures;
+        logged.clear();
+        test.run();
+        run++;
+        if (failures != failuresBefore) failed++;
+    }
+
+    printf("\n%d tests, %d checks, %d failed (%d tests)\n", run, checks, failures, failed);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+// log_dump.cpp
+// Turns a binary log (Log Format: binary, see logger.h) back into text, one message per line with
+// the time since the app started in front.
+//
+// Usage: log_dump [log.bin] [--out log_dump.txt]
+//   default is log.bin in the current folder, printed to the console
+//
+// Builds on its own, nothing else from the app needed.
+
+#include "../logger.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+int main(int argc, char** argv) {
+    const char* inPath = LOG_BINARY_FILE;
+    const char* outPath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) outPath = argv[++i];
+        else inPath = argv[i];
+    }
+
+    FILE* in = fopen(inPath, "rb");
+    if (!in) {
+        printf("[ERROR] Could not open %s\n", inPath);
+        return 1;
+    }
+    char magic[8];
+    if (fread(magic, 1, sizeof(magic), in) != sizeof(magic) || memcmp(magic, LOG_BINARY_MAGIC, sizeof(magic)) != 0) {
+        printf("[ERROR] %s is not a binary log\n", inPath);
+        fclose(in);
+        return 1;
+    }
+
+    FILE* out = outPath ? fopen(outPath, "w") : stdout;
+    if (!out) {
+        printf("[ERROR] Could not write %s\n", outPath);
+        fclose(in);
+        return 1;
+    }
+
+    unsigned long long records = 0;
+    LogBinaryHeader header;
+    std::string text;
+    while (fread(&header, sizeof(header), 1, in) == 1) {
+        text.resize(header.length);
+        if (header.length > 0 && fread(&text[0], 1, header.length, in) != header.length) {
+            fprintf(stderr, "[WARNING] %s ends part way through a message\n", inPath);
+            break;
+        }
+        fprintf(out, "%10.3f  %s\n", header.timeMs / 1000.0, text.c_str());
+        records++;
+    }
+
+    fclose(in);
+    if (out != stdout) {
+        fclose(out);
+        printf("%llu messages written to %s\n", records, outPath);
+    }
+    return 0;
+}
@@ -0,0 +1,165 @@
+// snapshot_bench.cpp
+// What taking a telemetry snapshot costs, and how often the game's writes tear it. The reader runs flat out
+// against an in-memory block while a writer thread plays the game:
+//
+//   quiet    - nobody writing, the bare cost of the copy, compare and decode
+//   60 Hz    - a frame every 16.7 ms, like the game
+//   flat out - frame after frame with no gap, the worst the reader can meet. Needs two cores to mean much:
+//              on one, the writer only gets in when the reader is preempted
+//
+// Each prints the time per ReadTelemetryData call and per snapshot (the copy and compare alone, as the
+// reader's own stats time it), how many copies were thrown away and retried, how many frames were torn on
+// every attempt, and how many distinct frames the reader saw.
+//
+// Usage: snapshot_bench [--seconds N]
+//   --seconds: how long each writer runs (default 2)
+//
+// Builds on Windows and Linux with:
+//   telemetry_reader.cpp, telemetry_source.cpp, telemetry_recorder.cpp
+
+#include "../telemetry_reader.h"
+#include "../telemetry_source.h"
+#include "../telemetry_layout.h"
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// The reader's logging isn't what is being measured
+void LogMessage(const std::wstring&) {}
+void LogPrintf(const wchar_t*, ...) {}
+
+enum class WriterMode {
+    Quiet,
+    Game,
+    FlatOut
+};
+
+static std::atomic<bool> writerRunning{ false };
+static std::atomic<unsigned long long> framesWritten{ 0 };
+
+// The whole block, a changed frame each time, the way the game writes it every physics tick
+static void WriteFrame(SharedMemory& block, unsigned long long frame) {
+    block.structSize = telemetryLayouts[0].structSize;
+    block.isInRace = true;
+    block.isPlayer = true;
+    block.fps = 60.0f;
+    block.speedKmh = 100.0f + static_cast<float>(frame % 200);
+    block.stWheelAngle = static_cast<float>(frame % 90) - 45.0f;
+    for (size_t i = 0; i < sizeof(block.wheelsData); i++) {
+        block.wheelsData[i] = static_cast<unsigned char>(frame + i);
+    }
+    for (int corner = 0; corner < 4; corner++) {
+        block.rideHeights[corner] = 2000 + static_cast<int>(frame % 50);
+        block.wheelSpin_13C[corner] += 1000;
+    }
+}
+
+static void WriterLoop(InMemoryTelemetrySource* source, WriterMode mode) {
+    using clock = std::chrono::steady_clock;
+    const auto period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / 60.0));
+    auto next = clock::now();
+    unsigned long long frame = 0;
+
+    while (writerRunning.load(std::memory_order_relaxed)) {
+        WriteFrame(source->Block(), ++frame);
+        framesWritten.store(frame, std::memory_order_relaxed);
+        if (mode == WriterMode::Game) {
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+        else {
+            std::this_thread::yield();      // so a single core still gets round to the reader
+        }
+    }
+}
+
+static void RunMode(InMemoryTelemetrySource& source, WriterMode mode, const char* name, double seconds) {
+    WriteFrame(source.Block(), 0);
+    framesWritten.store(0);
+
+    std::thread writer;
+    if (mode != WriterMode::Quiet) {
+        writerRunning.store(true);
+        writer = std::thread(WriterLoop, &source, mode);
+    }
+
+    TelemetrySnapshotStats before = GetTelemetrySnapshotStats();
+    RawTelemetry frame;
+    RawTelemetryExtras extras;
+    unsigned long long reads = 0;
+    unsigned long long distinctFrames = 0;
+    unsigned long long lastHash = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+    auto now = start;
+    while (now < end) {
+        // Checking the clock every read would be most of what gets measured
+        for (int i = 0; i < 256; i++) {
+            ReadTelemetryData(frame, TELEM_ALL, &extras);
+            if (frame.frameHash != lastHash) {
+                lastHash = frame.frameHash;
+                distinctFrames++;
+            }
+        }
+        reads += 256;
+        now = std::chrono::steady_clock::now();
+    }
+    double elapsedNs = std::chrono::duration<double, std::nano>(now - start).count();
+
+    if (writer.joinable()) {
+        writerRunning.store(false);
+        writer.join();
+    }
+
+    TelemetrySnapshotStats after = GetTelemetrySnapshotStats();
+    unsigned long long snapshots = after.snapshots - before.snapshots;
+    unsigned long long retries = after.retries - before.retries;
+    unsigned long long torn = after.torn - before.torn;
+    double snapshotNs = snapshots ? (after.totalMicros - before.totalMicros) * 1000.0 / snapshots : 0.0;
+
+    printf("%-9s %10.0f ns/read %10.0f ns/snapshot %10.3f retries/1k %8.3f torn/1k   %llu frames written, %llu seen\n",
+        name, elapsedNs / reads, snapshotNs,
+        snapshots ? retries * 1000.0 / snapshots : 0.0, snapshots ? torn * 1000.0 / snapshots : 0.0,
+        framesWritten.load(), distinctFrames);
+}
+
+int main(int argc, char** argv) {
+    double seconds = 2.0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) seconds = atof(argv[++i]);
+    }
+    if (seconds <= 0.0) {
+        printf("[ERROR] --seconds must be positive\n");
+        return 1;
+    }
+
+    InMemoryTelemetrySource source;
+    SetTelemetrySource(&source);
+
+    printf("%zu byte block, %.1f s per writer\n", sizeof(SharedMemory), seconds);
+    RunMode(source, WriterMode::Quiet, "quiet", seconds);
+    RunMode(source, WriterMode::Game, "60 Hz", seconds);
+    RunMode(source, WriterMode::FlatOut, "flat out", seconds);
+
+    SetTelemetrySource(nullptr);
+    return 0;
+}
@@ -0,0 +1,273 @@
+// tick_bench.cpp
+// What one FFB output tick costs on the CPU at high output rates, against the tick's budget. A simulated
+// 60 Hz game (a little arrival jitter, a constant force swinging through corners, the damper following
+// speed, kerbs switching the vibration) feeds the same per-tick work as the output stage (ffb_output.cpp):
+//
+//   frame arrived - the frame lock steers the tick grid (FramePhaseLock, FFBTickScheduler::LockTo) and the
+//                   constant force goes into the upsampler
+//   every tick    - each effect's update gate, the upsampled constant force when it changed, into a sink
+//                   that counts what would have gone to the device, then FFBTickScheduler::CompleteTick
+//
+// Time is simulated, every tick runs the moment the last one is done, so only the work is timed. The
+// gates are stand-ins with EffectUpdateGate's rules and the *_UPDATE_POLICY figures, on one parameter each -
+// the real ones need DirectInput's effect structs. For those, ffb_replay --rate on Windows times the real
+// FFBOutput on a recording.
+//
+// Usage: tick_bench [--rate HZ] [--seconds N] [--predict]
+//   --rate:    output rate (default 1000)
+//   --seconds: simulated driving per upsampling mode (default 60)
+//   --predict: upsample ahead of the newest frame instead of a frame behind
+//
+// Builds on Windows and Linux with:
+//   forces/force_upsampler.cpp, ffb_scheduler.cpp, frame_lock.cpp, ffb_clock.cpp
+
+#include "../ffb_scheduler.h"
+#include "../frame_lock.h"
+#include "../forces/force_upsampler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+#define BENCH_GAME_FPS 60.0
+#define BENCH_ARRIVAL_JITTER_MS 0.5     // +/- on each frame's arrival, about what the game's timer gives
+
+// The scheduler's and frame lock's reports aren't what is being measured
+void LogMessage(const std::wstring&) {}
+void LogPrintf(const wchar_t*, ...) {}
+
+// === Stand-in effects ===
+// Same order as ffb_output.cpp posts them, the constant force after the slow effects
+
+enum BenchEffect {
+    BENCH_DAMPER,
+    BENCH_SPRING,
+    BENCH_CONSTANT,
+    BENCH_VIBRATION,
+    BENCH_EFFECT_COUNT
+};
+
+static const char* const effectNames[BENCH_EFFECT_COUNT] = { "damper", "spring", "constant", "vibration" };
+
+enum class BenchUpdateMode {
+    EveryFrame,
+    OnChange
+};
+
+// forces/*_UPDATE_POLICY
+struct BenchPolicy {
+    BenchUpdateMode mode;
+    long threshold;
+    double refreshMs;
+};
+
+static const BenchPolicy policies[BENCH_EFFECT_COUNT] = {
+    { BenchUpdateMode::OnChange, 100, 1000.0 },     // DAMPER_UPDATE_POLICY
+    { BenchUpdateMode::OnChange, 0, 1000.0 },       // SPRING_UPDATE_POLICY
+    { BenchUpdateMode::EveryFrame, 0, 0.0 },        // CONSTANT_FORCE_UPDATE_POLICY
+    { BenchUpdateMode::OnChange, 200, 1000.0 }      // VIBRATION_UPDATE_POLICY
+};
+
+// EffectUpdateGate::Ready on one parameter
+struct BenchGate {
+    BenchPolicy policy;
+    long lastSent = 0;
+    bool haveSent = false;
+    double lastSentMs = 0.0;
+
+    bool Ready(long pending, double nowMs) {
+        bool ready = !haveSent || policy.mode == BenchUpdateMode::EveryFrame ||
+            std::labs(pending - lastSent) > policy.threshold ||
+            (policy.refreshMs > 0.0 && nowMs - lastSentMs >= policy.refreshMs);
+        if (!ready) return false;
+        lastSent = pending;
+        haveSent = true;
+        lastSentMs = nowMs;
+        return true;
+    }
+};
+
+// What would have gone to the device
+struct BenchSink {
+    unsigned long long posted[BENCH_EFFECT_COUNT] = {};
+    long last[BENCH_EFFECT_COUNT] = {};
+
+    void Post(int effect, long value) {
+        posted[effect]++;
+        last[effect] = value;
+    }
+};
+
+// === Simulated game ===
+// A small LCG so every mode gets exactly the same frames
+
+struct BenchGame {
+    unsigned int seed = 12345;
+    unsigned long long frame = 0;
+
+    double Jitter() {
+        seed = seed * 1103515245u + 12345u;
+        return ((seed >> 8) / 16777216.0 * 2.0 - 1.0) * BENCH_ARRIVAL_JITTER_MS;
+    }
+
+    double ArrivalMs(unsigned long long n) { return n * 1000.0 / BENCH_GAME_FPS + Jitter(); }
+
+    // Parameters of frame n, in each effect's own units
+    void Values(unsigned long long n, long values[BENCH_EFFECT_COUNT]) const {
+        double t = n / BENCH_GAME_FPS;
+        double speed = 200.0 + 80.0 * std::sin(t * 0.4);
+        values[BENCH_DAMPER] = static_cast<long>(speed * 20.0);
+        values[BENCH_SPRING] = 1500;
+        values[BENCH_CONSTANT] = static_cast<long>(6000.0 * std::sin(t * 2.0 * 3.14159265 / 3.0) + 400.0 * std::sin(t * 37.0));
+        values[BENCH_VIBRATION] = (n / 90) % 4 == 0 ? 2500 : 0;     // on a kerb a quarter of the time
+    }
+};
+
+static double Percentile(std::vector<double>& values, double fraction) {
+    if (values.empty()) return 0.0;
+    size_t at = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + at, values.end());
+    return values[at];
+}
+
+static void RunMode(UpsampleMode mode, bool predict, double rate, double seconds) {
+    const double intervalMs = 1000.0 / rate;
+    const bool upsampling = mode != UpsampleMode::Off;
+
+    FFBTickScheduler scheduler(intervalMs);
+    FramePhaseLock frameLock;
+    ForceUpsampler upsampler(mode, predict);
+    bool ticksLocked = false;
+    long lastUpsampledForce = 0;
+    bool upsampledForceSent = false;
+
+    BenchGate gates[BENCH_EFFECT_COUNT];
+    for (int effect = 0; effect < BENCH_EFFECT_COUNT; effect++) gates[effect].policy = policies[effect];
+    BenchSink sink;
+
+    // What has come in since the last tick, newest wins
+    long pending[BENCH_EFFECT_COUNT] = {};
+    bool havePending[BENCH_EFFECT_COUNT] = {};
+
+    BenchGame game;
+    unsigned long long frames = 0;
+    double nextFrameMs = game.ArrivalMs(0);
+    double endMs = seconds * 1000.0;
+
+    std::vector<double> tickUs;
+    tickUs.reserve(static_cast<size_t>(seconds * rate * 1.01) + 16);
+    scheduler.Restart(nextFrameMs);
+
+    while (scheduler.NextDeadlineMs() < endMs) {
+        double nowMs = scheduler.NextDeadlineMs();
+        auto start = std::chrono::steady_clock::now();
+
+        // Frames that turned up since the last tick, as FFBOutput::FrameArrived takes them
+        while (nextFrameMs <= nowMs) {
+            frameLock.FrameArrived(nextFrameMs, BENCH_GAME_FPS);
+            if (frameLock.Locked()) {
+                double ticksPerFrame = std::max(1.0, std::round(frameLock.PeriodMs() / intervalMs));
+                scheduler.LockTo(frameLock.NextTickMs(), frameLock.PeriodMs() / ticksPerFrame);
+                ticksLocked = true;
+            }
+            else if (ticksLocked) {
+                scheduler.SetPeriodMs(intervalMs);
+                ticksLocked = false;
+            }
+
+            long values[BENCH_EFFECT_COUNT];
+            game.Values(frames, values);
+            for (int effect = 0; effect < BENCH_EFFECT_COUNT; effect++) {
+                // Upsampled, the constant force goes out through the upsampler instead of its gate
+                if (effect == BENCH_CONSTANT && upsampling) {
+                    upsampler.SetFramePeriodMs(1000.0 / BENCH_GAME_FPS);
+                    upsampler.AddSample(nextFrameMs, values[effect]);
+                    continue;
+                }
+                pending[effect] = values[effect];
+                havePending[effect] = true;
+            }
+            nextFrameMs = game.ArrivalMs(++frames);
+        }
+
+        // FFBOutput::Tick: each effect at its own rate, then the upsampled constant force when it moved
+        for (int effect = 0; effect < BENCH_EFFECT_COUNT; effect++) {
+            if (havePending[effect] && gates[effect].Ready(pending[effect], nowMs)) {
+                sink.Post(effect, pending[effect]);
+                havePending[effect] = false;
+            }
+        }
+        if (upsampling) {
+            long upsampledForce = 0;
+            if (upsampler.Evaluate(nowMs, upsampledForce) && (!upsampledForceSent || upsampledForce != lastUpsampledForce)) {
+                sink.Post(BENCH_CONSTANT, upsampledForce);
+                lastUpsampledForce = upsampledForce;
+                upsampledForceSent = true;
+            }
+        }
+        scheduler.CompleteTick(nowMs);
+
+        tickUs.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    double total = 0.0;
+    for (double us : tickUs) total += us;
+    size_t ticks = tickUs.size();
+    double average = ticks ? total / ticks : 0.0;
+    double p99 = Percentile(tickUs, 0.99);
+    double worst = ticks ? *std::max_element(tickUs.begin(), tickUs.end()) : 0.0;
+
+    printf("%-8s %.3f us/tick avg, p99 %.3f, max %.3f   %.3f%% of the %.3f ms tick   %zu ticks, %llu frames\n",
+        mode == UpsampleMode::Off ? "off" : mode == UpsampleMode::Linear ? "linear" : "hermite",
+        average, p99, worst, average / (intervalMs * 10.0), intervalMs, ticks, frames);
+    printf("         sent:");
+    for (int effect = 0; effect < BENCH_EFFECT_COUNT; effect++) printf(" %s %llu", effectNames[effect], sink.posted[effect]);
+    FrameLockStats lockStats = frameLock.Stats();
+    printf("   frame lock %s, %.3f ms error\n", lockStats.locked ? "locked" : "searching", lockStats.lockErrorMs);
+}
+
+int main(int argc, char** argv) {
+    double rate = 1000.0;
+    double seconds = 60.0;
+    bool predict = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) rate = atof(argv[++i]);
+        else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "--predict") == 0) predict = true;
+    }
+    if (rate <= 0.0 || seconds <= 0.0) {
+        printf("[ERROR] --rate and --seconds must be positive\n");
+        return 1;
+    }
+
+    // Each tick's time includes two clock reads, shown so it can be taken out
+    const int clockReads = 100000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < clockReads; i++) std::chrono::steady_clock::now();
+    double clockNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / clockReads;
+
+    printf("%.0f Hz output, %.0f fps game, %.0f simulated s per mode%s, %.0f ns per clock read\n",
+        rate, BENCH_GAME_FPS, seconds, predict ? ", predicting" : "", clockNs);
+    RunMode(UpsampleMode::Off, predict, rate, seconds);
+    RunMode(UpsampleMode::Linear, predict, rate, seconds);
+    RunMode(UpsampleMode::Hermite, predict, rate, seconds);
+    return 0;
+}
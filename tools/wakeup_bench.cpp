@@ -0,0 +1,220 @@
+// wakeup_bench.cpp
+// How late the reader notices a new telemetry frame with each wakeup mode (telemetry_wakeup.h), in one run:
+// the old 1ms sleep loop, the adaptive poll and the writer's frame event. A writer thread plays the game into
+// an in-memory block at a steady frame rate and signals the frame event the way x86gp2_standin does; the
+// reader goes round the same read / NotifyTelemetryPoll / WaitForTelemetryFrame loop as the app's.
+//
+// For each mode: how long after the write the reader saw the frame (avg, p50, p99, max), frames it never saw,
+// and reads per frame - every read past the first is a wakeup that found nothing.
+//
+// Usage: wakeup_bench [--seconds N] [--rate Hz]
+//   --seconds: how long each mode runs (default 5)
+//   --rate:    frames per second the writer publishes (default 60)
+//
+// Builds on Windows and Linux with:
+//   telemetry_wakeup.cpp, telemetry_reader.cpp, telemetry_source.cpp, telemetry_recorder.cpp
+
+#include "../telemetry_wakeup.h"
+#include "../telemetry_reader.h"
+#include "../telemetry_source.h"
+#include "../telemetry_layout.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <semaphore.h>
+#endif
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+#define BENCH_READER_WAIT_MS 100.0  // same as the app's READER_WAIT_MS
+#define BENCH_WRITE_SLOTS 4096      // write times kept, far more frames than the reader can fall behind by
+
+void LogMessage(const std::wstring&) {}
+void LogPrintf(const wchar_t*, ...) {}
+
+static double NowMs() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// === The frame event, created here the way the game (or x86gp2_standin) would ===
+
+#ifdef _WIN32
+
+static HANDLE frameEvent = NULL;
+
+static void CreateFrameEvent() {
+    frameEvent = CreateEventA(NULL, FALSE, FALSE, "Local\\x86GP2FFBFrame");
+}
+
+static void SignalFrame() {
+    if (frameEvent) SetEvent(frameEvent);
+}
+
+static void DestroyFrameEvent() {
+    if (frameEvent) CloseHandle(frameEvent);
+    frameEvent = NULL;
+}
+
+#else
+
+static sem_t* frameSem = SEM_FAILED;
+
+static void CreateFrameEvent() {
+    sem_unlink("/x86GP2FFBFrame");      // nothing left over from a standin that didn't exit cleanly
+    frameSem = sem_open("/x86GP2FFBFrame", O_CREAT, 0600, 0);
+}
+
+static void SignalFrame() {
+    if (frameSem != SEM_FAILED) sem_post(frameSem);
+}
+
+static void DestroyFrameEvent() {
+    if (frameSem != SEM_FAILED) sem_close(frameSem);
+    sem_unlink("/x86GP2FFBFrame");
+    frameSem = SEM_FAILED;
+}
+
+#endif
+
+// === Writer ===
+// Frame n carries n in speedKmh, so the reader can look up when it was written
+
+static std::atomic<bool> writerRunning{ false };
+static std::atomic<bool> signalFrames{ false };
+static std::atomic<double> writeMs[BENCH_WRITE_SLOTS];
+
+static void WriterLoop(InMemoryTelemetrySource* source, double rate) {
+    SharedMemory& block = source->Block();
+    double periodMs = 1000.0 / rate;
+    double next = NowMs() + periodMs;
+    unsigned long long frame = 0;
+
+    while (writerRunning.load(std::memory_order_relaxed)) {
+        PreciseSleepMs(next - NowMs());
+        next += periodMs;
+
+        frame++;
+        writeMs[frame % BENCH_WRITE_SLOTS].store(NowMs(), std::memory_order_release);
+        block.speedKmh = static_cast<float>(frame);
+        block.fps = static_cast<float>(rate);
+        if (signalFrames.load(std::memory_order_relaxed)) SignalFrame();
+    }
+}
+
+// === Reader ===
+
+static double Percentile(std::vector<double>& values, double fraction) {
+    if (values.empty()) return 0.0;
+    size_t at = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + at, values.end());
+    return values[at];
+}
+
+static void RunMode(InMemoryTelemetrySource& source, TelemetryWakeupMode mode, const char* name, double seconds, double rate) {
+    SharedMemory& block = source.Block();
+    block.structSize = telemetryLayouts[0].structSize;
+    block.isInRace = true;
+    block.isPlayer = true;
+    block.speedKmh = 0.0f;
+
+    if (mode == TelemetryWakeupMode::Event) CreateFrameEvent();
+    signalFrames.store(mode == TelemetryWakeupMode::Event);
+    SetTelemetryWakeupMode(mode);
+    if (GetTelemetryWakeupMode() != mode) {
+        printf("%-9s could not open the frame event, skipped\n", name);
+        signalFrames.store(false);
+        DestroyFrameEvent();
+        return;
+    }
+
+    writerRunning.store(true);
+    std::thread writer(WriterLoop, &source, rate);
+
+    std::vector<double> latencies;
+    latencies.reserve(static_cast<size_t>(seconds * rate) + 16);
+    RawTelemetry current;
+    unsigned long long reads = 0;
+    unsigned long long lastHash = 0;
+    unsigned long long lastFrameSeen = 0;
+    double endMs = NowMs() + seconds * 1000.0;
+
+    while (NowMs() < endMs) {
+        ReadTelemetryData(current, TELEM_STATE | TELEM_SPEED);
+        reads++;
+        bool newFrame = current.frameHash != lastHash;
+        NotifyTelemetryPoll(newFrame);
+        lastHash = current.frameHash;
+
+        unsigned long long frame = static_cast<unsigned long long>(current.gp2_speedKmh);
+        if (newFrame && frame > 0) {
+            latencies.push_back(NowMs() - writeMs[frame % BENCH_WRITE_SLOTS].load(std::memory_order_acquire));
+            lastFrameSeen = frame;
+        }
+        WaitForTelemetryFrame(BENCH_READER_WAIT_MS);
+    }
+
+    writerRunning.store(false);
+    writer.join();
+    signalFrames.store(false);
+    if (mode == TelemetryWakeupMode::Event) DestroyFrameEvent();
+
+    double total = 0.0;
+    for (double latency : latencies) total += latency;
+    size_t seen = latencies.size();
+    double average = seen ? total / seen : 0.0;
+    double p50 = Percentile(latencies, 0.5);
+    double p99 = Percentile(latencies, 0.99);
+    double worst = seen ? *std::max_element(latencies.begin(), latencies.end()) : 0.0;
+
+    // Only up to the last frame seen, one written after the reader stopped wasn't missed
+    printf("%-9s late avg %6.3f ms, p50 %6.3f, p99 %6.3f, max %6.3f   %llu of %llu frames missed, %.1f reads per frame\n",
+        name, average, p50, p99, worst, lastFrameSeen > seen ? lastFrameSeen - seen : 0ULL, lastFrameSeen,
+        seen ? static_cast<double>(reads) / seen : 0.0);
+}
+
+int main(int argc, char** argv) {
+    double seconds = 5.0;
+    double rate = 60.0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) rate = atof(argv[++i]);
+    }
+    if (seconds <= 0.0 || rate <= 0.0) {
+        printf("[ERROR] --seconds and --rate must be positive\n");
+        return 1;
+    }
+
+    InMemoryTelemetrySource source;
+    SetTelemetrySource(&source);
+
+    printf("%.0f Hz writer, %.1f s per mode\n", rate, seconds);
+    RunMode(source, TelemetryWakeupMode::LegacySleep, "legacy", seconds, rate);
+    RunMode(source, TelemetryWakeupMode::AdaptivePoll, "adaptive", seconds, rate);
+    RunMode(source, TelemetryWakeupMode::Event, "event", seconds, rate);
+
+    SetTelemetrySource(nullptr);
+    return 0;
+}
@@ -0,0 +1,390 @@
+// x86gp2_standin.cpp
+// Stand-in for x86GP2 - writes the FFB shared memory block the way the game does, so the FFB app
+// can be run, load tested and debugged without the game.
+//
+// Usage: x86gp2_standin [scenario] [--rate Hz] [--seconds N] [--seed N]
+//   scenario: straight, corner, kerb, grass, pause, all (default: all, one after another)
+//   --rate:    frames per second to publish (default 60, try 120 or 1000 for load tests)
+//   --seconds: how long to run each scenario (default 20)
+//   --seed:    noise seed, the same seed always gives the same frames (default 1)
+//
+// Every frame is also signalled on the frame event ("Local\x86GP2FFBFrame" / "/x86GP2FFBFrame"),
+// same as telemetry_wakeup.h expects from the game.
+
+#include "../telemetry_layout.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <semaphore.h>
+#include <signal.h>
+#endif
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// Same estimates the app uses to turn game units into Newtons (calculations/vehicle_dynamics.cpp)
+#define STANDIN_TIRE_FORCE_SCALE 0.0512
+#define STANDIN_VEHICLE_MASS 660.0
+#define STANDIN_GRAVITY 9.81
+#define STANDIN_STEERING_RATIO 15.0
+
+// Corner order here is ours (LF, RF, LR, RR), the layout table maps it to the game's
+#define LF 0
+#define RF 1
+#define LR 2
+#define RR 3
+
+// === Scenario state ===
+// What a scenario wants the car to be doing at time t, turned into the game's block by WriteFrame
+
+struct CarState {
+    double speedKmh = 0.0;
+    double steeringDeg = 0.0;   // steering wheel angle
+    double lateralG = 0.0;      // positive = left turn, same as the app
+    double longG = 0.0;         // positive = accelerating
+    int surface[4] = { SURFACE_ASPHALT, SURFACE_ASPHALT, SURFACE_ASPHALT, SURFACE_ASPHALT };
+    bool paused = false;
+    bool replay = false;
+};
+
+// Small deterministic noise so frames aren't identical, without pulling in <random>
+static unsigned int noiseState = 1;
+
+static double Noise() {
+    noiseState = noiseState * 1664525u + 1013904223u;
+    return ((noiseState >> 8) / 16777216.0) * 2.0 - 1.0; // -1..1
+}
+
+// Flat out, then a hard stop from 300 kph, then back up to speed
+static void StraightBraking(double t, CarState& car) {
+    double cycle = fmod(t, 12.0);
+    if (cycle < 6.0) {
+        car.speedKmh = 80.0 + cycle / 6.0 * 220.0;
+        car.longG = 1.2;
+    }
+    else if (cycle < 9.0) {
+        car.speedKmh = 300.0 - (cycle - 6.0) / 3.0 * 220.0;
+        car.longG = -4.0;
+    }
+    else {
+        car.speedKmh = 80.0;
+        car.longG = 0.0;
+    }
+    car.steeringDeg = Noise() * 2.0;
+    car.lateralG = Noise() * 0.05;
+}
+
+// Long fast corner at 4 G, alternating left and right every 8 seconds
+static void SustainedCorner(double t, CarState& car) {
+    double cycle = fmod(t, 16.0);
+    double direction = (cycle < 8.0) ? 1.0 : -1.0;
+    double inCorner = std::min(1.0, fmod(cycle, 8.0) / 1.5); // turn in over 1.5s
+    car.speedKmh = 240.0;
+    car.steeringDeg = direction * inCorner * 90.0 + Noise() * 1.5;
+    car.lateralG = direction * inCorner * 4.0 + Noise() * 0.1;
+}
+
+// Running over kerbs - one side at a time, low and high kerbs, a couple of times a second
+static void KerbStrikes(double t, CarState& car) {
+    car.speedKmh = 160.0;
+    car.steeringDeg = sin(t) * 30.0;
+    car.lateralG = sin(t) * 1.5;
+
+    double phase = fmod(t, 2.0);
+    bool leftSide = fmod(t, 4.0) < 2.0;
+    int kerb = (fmod(t, 8.0) < 4.0) ? SURFACE_LOW_CURB : SURFACE_HIGH_CURB;
+    if (phase < 0.4) {
+        car.surface[leftSide ? LF : RF] = kerb;
+        car.surface[leftSide ? LR : RR] = (phase > 0.1) ? kerb : SURFACE_ASPHALT; // rears follow on
+    }
+}
+
+// Two wheels off onto the grass, then all four into the gravel, then back on
+static void GrassExcursion(double t, CarState& car) {
+    double cycle = fmod(t, 10.0);
+    car.steeringDeg = Noise() * 10.0;
+    car.lateralG = Noise() * 0.6;
+    if (cycle < 3.0) {
+        car.speedKmh = 180.0;
+    }
+    else if (cycle < 6.0) {
+        car.speedKmh = 180.0 - (cycle - 3.0) * 30.0;
+        car.surface[RF] = car.surface[RR] = SURFACE_GRASS;
+    }
+    else if (cycle < 8.0) {
+        car.speedKmh = 90.0 - (cycle - 6.0) * 40.0;
+        for (int corner = 0; corner < 4; corner++) car.surface[corner] = SURFACE_GRAVEL;
+    }
+    else {
+        car.speedKmh = 10.0 + (cycle - 8.0) * 20.0;
+    }
+}
+
+// Driving, then pause for 3s (block keeps its last values, like the game), then a replay, then driving
+static void PauseResume(double t, CarState& car) {
+    double cycle = fmod(t, 12.0);
+    SustainedCorner(t, car);
+    car.lateralG *= 0.5;
+    car.paused = (cycle >= 4.0 && cycle < 7.0);
+    car.replay = (cycle >= 9.0 && cycle < 11.0);
+}
+
+typedef void (*Scenario)(double t, CarState& car);
+
+struct ScenarioEntry {
+    const char* name;
+    Scenario run;
+};
+
+static const ScenarioEntry scenarios[] = {
+    { "straight", StraightBraking },
+    { "corner", SustainedCorner },
+    { "kerb", KerbStrikes },
+    { "grass", GrassExcursion },
+    { "pause", PauseResume },
+};
+
+// === Writing the block ===
+
+static void WriteWheelField(unsigned char* wheelsData, const TelemetryLayout& layout, int corner, const WheelField& field, int value) {
+    unsigned char* at = wheelsData + layout.wheelSlot[corner] * layout.wheelStride + field.offset;
+    if (field.type == WheelFieldType::Int16) {
+        int16_t v = static_cast<int16_t>(value);
+        memcpy(at, &v, sizeof(v));
+    }
+    else if (field.type == WheelFieldType::Float32) {
+        float v = static_cast<float>(value);
+        memcpy(at, &v, sizeof(v));
+    }
+    else {
+        int32_t v = value;
+        memcpy(at, &v, sizeof(v));
+    }
+}
+
+static void WriteFrame(SharedMemory& block, const CarState& car, double fps) {
+    const TelemetryLayout& layout = telemetryLayouts[0];
+
+    block.structSize = layout.structSize;
+    block.isInRace = true;
+    block.isPlayer = true;
+    block.isPaused = car.paused;
+    block.isReplay = car.replay;
+    block.isX86GP2MenuOn = false;
+    block.fps = static_cast<float>(fps);
+
+    // A paused game leaves everything else as it was
+    if (car.paused) return;
+
+    block.speedKmh = static_cast<float>(car.speedKmh);
+    block.stWheelAngle = static_cast<float>(car.steeringDeg);
+    block.tyreTurnAngle = static_cast<float>(car.steeringDeg / STANDIN_STEERING_RATIO);
+    block.slipAngleFront = static_cast<float>(car.lateralG * 0.8);
+    block.slipAngleRear = static_cast<float>(car.lateralG * 0.6);
+
+    // Total force for the G asked for, split over the axles with a bit of load transfer to the outside
+    double latTotal = car.lateralG * STANDIN_VEHICLE_MASS * STANDIN_GRAVITY / STANDIN_TIRE_FORCE_SCALE;
+    double longTotal = car.longG * STANDIN_VEHICLE_MASS * STANDIN_GRAVITY / STANDIN_TIRE_FORCE_SCALE;
+    double outside = std::min(0.75, 0.5 + std::fabs(car.lateralG) * 0.05);
+    double leftShare = (car.lateralG >= 0.0) ? 1.0 - outside : outside;
+
+    int magLat[4], magLong[4];
+    magLat[LF] = static_cast<int>(latTotal * leftShare);
+    magLat[RF] = static_cast<int>(latTotal * (1.0 - leftShare));
+    magLat[LR] = static_cast<int>(latTotal * leftShare * 0.9);
+    magLat[RR] = static_cast<int>(latTotal * (1.0 - leftShare) * 0.9);
+    for (int corner = 0; corner < 4; corner++) {
+        magLong[corner] = static_cast<int>(longTotal * 0.25);
+    }
+
+    for (int corner = 0; corner < 4; corner++) {
+        int index = layout.cornerIndex[corner];
+        block.surfaceType[index] = car.surface[corner];
+        block.rideHeights[index] = 2000 + static_cast<int>(Noise() * 50.0);
+        block.wheelSpin_13C[index] += static_cast<int>(car.speedKmh * 10.0);
+        WriteWheelField(block.wheelsData, layout, corner, layout.magLat, magLat[corner]);
+        WriteWheelField(block.wheelsData, layout, corner, layout.magLong, magLong[corner]);
+    }
+}
+
+// === Platform bits ===
+
+#ifdef _WIN32
+
+static HANDLE mapping = NULL;
+static HANDLE frameEvent = NULL;
+
+static SharedMemory* CreateBlock() {
+    mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(SharedMemory), "Local\\x86GP2FFB");
+    if (!mapping) return nullptr;
+    frameEvent = CreateEventA(NULL, FALSE, FALSE, "Local\\x86GP2FFBFrame"); // auto reset, one wake per frame
+    return static_cast<SharedMemory*>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(SharedMemory)));
+}
+
+static void SignalFrame() {
+    if (frameEvent) SetEvent(frameEvent);
+}
+
+static void DestroyBlock(SharedMemory* block) {
+    if (block) UnmapViewOfFile(block);
+    if (frameEvent) CloseHandle(frameEvent);
+    if (mapping) CloseHandle(mapping);
+}
+
+#else
+
+static sem_t* frameSem = SEM_FAILED;
+static volatile sig_atomic_t stopRequested = 0;
+
+static void OnSignal(int) {
+    stopRequested = 1;
+}
+
+static SharedMemory* CreateBlock() {
+    int fd = shm_open("/x86GP2FFB", O_CREAT | O_RDWR, 0644);
+    if (fd < 0) return nullptr;
+    if (ftruncate(fd, sizeof(SharedMemory)) != 0) {
+        close(fd);
+        return nullptr;
+    }
+    void* mapped = mmap(nullptr, sizeof(SharedMemory), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) return nullptr;
+
+    frameSem = sem_open("/x86GP2FFBFrame", O_CREAT, 0644, 0);
+
+    // Ctrl+C should still unlink, otherwise the app keeps seeing a frozen block
+    signal(SIGINT, OnSignal);
+    signal(SIGTERM, OnSignal);
+    return static_cast<SharedMemory*>(mapped);
+}
+
+static void SignalFrame() {
+    if (frameSem != SEM_FAILED) sem_post(frameSem);
+}
+
+static void DestroyBlock(SharedMemory* block) {
+    if (block) munmap(block, sizeof(SharedMemory));
+    if (frameSem != SEM_FAILED) sem_close(frameSem);
+    shm_unlink("/x86GP2FFB");
+    sem_unlink("/x86GP2FFBFrame");
+}
+
+#endif
+
+static bool StopRequested() {
+#ifdef _WIN32
+    return false; // closing the console window ends the process, Windows tidies up the mapping
+#else
+    return stopRequested != 0;
+#endif
+}
+
+// === Main ===
+
+static void RunScenario(SharedMemory* block, const ScenarioEntry& scenario, double rate, double seconds) {
+    using clock = std::chrono::steady_clock;
+    const auto period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / rate));
+
+    printf("[INFO] Scenario '%s' at %.0f Hz for %.0f s\n", scenario.name, rate, seconds);
+
+    auto start = clock::now();
+    auto next = start;
+    unsigned long long frames = 0;
+    unsigned long long late = 0;
+
+    while (!StopRequested()) {
+        // Simulated time comes from the frame count, so a run is the same however the OS schedules us
+        double t = static_cast<double>(frames) / rate;
+        if (t >= seconds) break;
+
+        CarState car;
+        scenario.run(t, car);
+        WriteFrame(*block, car, rate);
+        SignalFrame();
+        frames++;
+
+        next += period;
+        auto now = clock::now();
+        if (now > next + period) {
+            // Fell more than a frame behind, don't try to catch up in a burst
+            late++;
+            next = now;
+        }
+        std::this_thread::sleep_until(next);
+    }
+
+    double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    printf("[INFO] '%s' done: %llu frames in %.2f s (%.1f Hz achieved), %llu late\n",
+        scenario.name, frames, elapsed, frames / std::max(elapsed, 0.001), late);
+}
+
+int main(int argc, char** argv) {
+    std::string scenarioName = "all";
+    double rate = 60.0;
+    double seconds = 20.0;
+    unsigned int seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--rate" && i + 1 < argc) rate = atof(argv[++i]);
+        else if (arg == "--seconds" && i + 1 < argc) seconds = atof(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc) seed = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+        else scenarioName = arg;
+    }
+
+    if (rate <= 0.0 || seconds <= 0.0) {
+        printf("[ERROR] --rate and --seconds must be positive\n");
+        return 1;
+    }
+
+    SharedMemory* block = CreateBlock();
+    if (!block) {
+        printf("[ERROR] Could not create the x86GP2FFB shared memory block\n");
+        return 1;
+    }
+    memset(block, 0, sizeof(SharedMemory));
+
+    noiseState = seed;
+    bool found = false;
+    for (const ScenarioEntry& scenario : scenarios) {
+        if (scenarioName == "all" || scenarioName == scenario.name) {
+            found = true;
+            RunScenario(block, scenario, rate, seconds);
+            if (StopRequested()) break;
+        }
+    }
+
+    if (!found) {
+        printf("[ERROR] Unknown scenario '%s' (straight, corner, kerb, grass, pause, all)\n", scenarioName.c_str());
+    }
+
+    // Leave the race so the app sees the game go away
+    block->isInRace = false;
+    DestroyBlock(block);
+    return found ? 0 : 1;
+}
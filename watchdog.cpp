@@ -0,0 +1,148 @@
+#include "watchdog.h"
+#include "device_io.h"
+#include "ffb_clock.h"
+#include "thread_policy.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+#define WATCHDOG_CHECKS_PER_TIMEOUT 4   // how finely a stall is timed
+#define WATCHDOG_MIN_CHECK_MS 10.0
+
+static std::atomic<double> lastBeatMs[WATCHDOG_STAGE_COUNT] = {};  // 0 = never beaten
+static std::atomic<bool> tripped{ false };
+static std::atomic<bool> recoveryPending{ false };
+
+static std::mutex statsMutex;
+static WatchdogStats stats;
+
+static double watchdogTimeoutMs = 0.0;
+static std::atomic<double> idleWaitMs{ WATCHDOG_IDLE_WAIT_MS };
+
+const wchar_t* WatchdogStageName(WatchdogStage stage) {
+    switch (stage) {
+    case WATCHDOG_READER: return L"reader";
+    case WATCHDOG_COMPUTE: return L"compute";
+    case WATCHDOG_OUTPUT: return L"output";
+    case WATCHDOG_DEVICE_IO: return L"device I/O";
+    default: return L"unknown";
+    }
+}
+
+void WatchdogBeat(WatchdogStage stage) {
+    // Never exactly 0, that means "not started"
+    lastBeatMs[stage].store(std::max(GetFFBClock().NowMs(), 1e-3), std::memory_order_relaxed);
+}
+
+double WatchdogIdleWaitMs() {
+    return idleWaitMs.load(std::memory_order_relaxed);
+}
+
+bool WatchdogTripped() {
+    return tripped.load(std::memory_order_relaxed);
+}
+
+bool WatchdogTakeRecovery() {
+    return recoveryPending.exchange(false);
+}
+
+WatchdogStats GetWatchdogStats() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    WatchdogStats s = stats;
+    s.tripped = WatchdogTripped();
+    return s;
+}
+
+static void WatchdogLoop() {
+    ApplyThreadPolicy(L"Watchdog");
+
+    double checkMs = std::max(watchdogTimeoutMs / WATCHDOG_CHECKS_PER_TIMEOUT, WATCHDOG_MIN_CHECK_MS);
+    double stallStartMs = 0.0;
+    bool bypassedIO = false;
+
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(checkMs));
+        double now = GetFFBClock().NowMs();
+
+        // The thread that has been quiet longest, if any is past the timeout
+        int stalled = -1;
+        double stalledBeat = 0.0;
+        for (int stage = 0; stage < WATCHDOG_STAGE_COUNT; stage++) {
+            double beat = lastBeatMs[stage].load(std::memory_order_relaxed);
+            if (beat <= 0.0 || now - beat <= watchdogTimeoutMs) continue;
+            if (stalled < 0 || beat < stalledBeat) {
+                stalled = stage;
+                stalledBeat = beat;
+            }
+        }
+        double ioBeat = lastBeatMs[WATCHDOG_DEVICE_IO].load(std::memory_order_relaxed);
+        bool ioStalled = ioBeat > 0.0 && now - ioBeat > watchdogTimeoutMs;
+
+        if (!tripped && stalled >= 0) {
+            tripped = true;
+            stallStartMs = stalledBeat;
+            bypassedIO = ioStalled;
+            {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                stats.stalls++;
+                stats.lastStalled = static_cast<WatchdogStage>(stalled);
+            }
+            LogMessage(L"[WARNING] Watchdog: " + std::wstring(WatchdogStageName(static_cast<WatchdogStage>(stalled))) +
+                L" thread silent for " + std::to_wstring(static_cast<int>(now - stalledBeat)) + L" ms, zeroing forces" +
+                (ioStalled ? L" (straight to the wheel)" : L""));
+            DeviceEmergencyStop(ioStalled);
+        }
+        else if (tripped && ioStalled && !bypassedIO) {
+            // The stop went into a mailbox nobody is emptying any more
+            bypassedIO = true;
+            LogMessage(L"[WARNING] Watchdog: device I/O thread stuck too, stopping effects directly");
+            DeviceEmergencyStop(true);
+        }
+        else if (tripped && stalled < 0) {
+            double stallMs = now - stallStartMs;
+            {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                stats.totalStallMs += stallMs;
+                stats.longestStallMs = std::max(stats.longestStallMs, stallMs);
+            }
+            recoveryPending = true;
+            tripped = false;
+            LogMessage(L"[INFO] Watchdog: pipeline running again after " + std::to_wstring(static_cast<int>(stallMs)) +
+                L" ms, restoring forces");
+        }
+    }
+}
+
+void StartWatchdog(double timeoutMs) {
+    if (timeoutMs <= 0.0) {
+        LogMessage(L"[INFO] Watchdog off");
+        return;
+    }
+    watchdogTimeoutMs = std::max(timeoutMs, WATCHDOG_MIN_TIMEOUT_MS);
+    idleWaitMs.store(std::min(WATCHDOG_IDLE_WAIT_MS, watchdogTimeoutMs / WATCHDOG_IDLE_WAITS_PER_TIMEOUT),
+        std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.enabled = true;
+    }
+
+    std::thread watchdogThread(WatchdogLoop);
+    watchdogThread.detach();
+    LogMessage(L"[INFO] Watchdog started, timeout " + std::to_wstring(static_cast<int>(watchdogTimeoutMs)) + L" ms");
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <string>
+
+/*
+ * Copyright 2025 gplaps
+ *
+ * Licensed under the MIT License (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/MIT
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ */
+
+// Pipeline watchdog
+// The effects run with dwDuration = INFINITE, so if a thread hangs (a DirectInput call that never returns,
+// the console blocking the display mutex...) the wheel keeps pulling with the last force forever.
+// Each FFB thread beats at the top of its loop - all of them wake at least every WatchdogIdleWaitMs() even
+// with nothing to do - and a thread of its own checks the beats. One that misses the timeout trips it:
+//
+//   trip    - zero the constant force, stop the other effects (DeviceEmergencyStop, device_io.h)
+//   recover - once every thread is beating again, WatchdogTakeRecovery() tells compute to start the
+//             effects over, and the next force update puts the constant force back
+//
+// If it is the device I/O thread that stopped, the stop goes straight to the effects from here.
+
+#define WATCHDOG_MIN_TIMEOUT_MS 150.0
+#define WATCHDOG_IDLE_WAIT_MS 100.0         // longest idle wait between beats, less with a short timeout
+#define WATCHDOG_IDLE_WAITS_PER_TIMEOUT 3   // idle beats that fit in one timeout, so scheduling slop can't trip it
+
+enum WatchdogStage {
+    WATCHDOG_READER,
+    WATCHDOG_COMPUTE,
+    WATCHDOG_OUTPUT,
+    WATCHDOG_DEVICE_IO,
+    WATCHDOG_STAGE_COUNT
+};
+
+struct WatchdogStats {
+    bool enabled = false;
+    bool tripped = false;
+    unsigned long long stalls = 0;
+    double totalStallMs = 0.0;          // from the stalled thread's last beat until everything beat again
+    double longestStallMs = 0.0;
+    WatchdogStage lastStalled = WATCHDOG_READER;
+};
+
+// Include logging
+void LogMessage(const std::wstring& msg);
+
+const wchar_t* WatchdogStageName(WatchdogStage stage);
+
+// Cheap, call as often as you like. A thread that has never beaten isn't watched yet
+void WatchdogBeat(WatchdogStage stage);
+
+// timeoutMs 0 leaves it off, anything else is raised to at least WATCHDOG_MIN_TIMEOUT_MS
+void StartWatchdog(double timeoutMs);
+
+// How long a watched thread may wait with nothing to do before it goes round and beats again:
+// WATCHDOG_IDLE_WAIT_MS, or a WATCHDOG_IDLE_WAITS_PER_TIMEOUT share of a shorter timeout. Any thread
+double WatchdogIdleWaitMs();
+
+// While tripped, don't send anything that isn't a fresh force
+bool WatchdogTripped();
+
+// True once after each recovery - the caller restarts whatever the trip stopped
+bool WatchdogTakeRecovery();
+
+WatchdogStats GetWatchdogStats();